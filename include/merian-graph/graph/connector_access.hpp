@@ -25,6 +25,8 @@ struct ConnectorAccess {
         return !stages && !access;
     }
 
+    bool operator==(const ConnectorAccess&) const = default;
+
     friend ConnectorAccess operator|(const ConnectorAccess& a, const ConnectorAccess& b) {
         return {a.stages | b.stages, a.access | b.access, a.image_usage | b.image_usage,
                 a.buffer_usage | b.buffer_usage};
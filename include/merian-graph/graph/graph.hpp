@@ -19,6 +19,7 @@
 #include "merian/vk/command/submission.hpp"
 #include "merian/vk/context.hpp"
 #include "merian/vk/extension/extension_vk_debug_utils.hpp"
+#include "merian/vk/memory/aliasing_memory_allocator.hpp"
 #include "merian/vk/memory/resource_allocator.hpp"
 #include "merian/vk/sync/ring_fences.hpp"
 
@@ -65,8 +66,14 @@ class Graph : public std::enable_shared_from_this<Graph> {
         // The submission for the current iteration. One per slot so its command pool is only
         // reset once the iteration's fence was awaited.
         SubmissionHandle submission;
+        // Secondary submissions for parallel recording, one per recording group of a layer.
+        std::vector<SubmissionHandle> secondary_submissions;
+        // The submission for nodes on the async compute queue (created on first use).
+        SubmissionHandle async_submission;
         // Query pools for the profiler
         QueryPoolHandle<vk::QueryType::eTimestamp> profiler_query_pool;
+        // Per-node pipeline statistics, nullptr if pipelineStatisticsQuery is not enabled.
+        QueryPoolHandle<vk::QueryType::ePipelineStatistics> profiler_statistics_query_pool;
         // Tasks that should be run in the current iteration after acquiring the fence.
         std::vector<std::function<void()>> tasks;
         // For each node: optional in-flight data.
@@ -75,6 +82,30 @@ class Graph : public std::enable_shared_from_this<Graph> {
         std::chrono::duration<double> cpu_sleep_time = 0ns;
     };
 
+    // Nodes of one dependency layer have no ordering constraints among each other; the barrier
+    // is emitted before the layer's nodes run. It covers only the accesses of earlier layers that
+    // conflict with accesses in this layer (per connection and aliased memory);
+    // layers[0].barrier orders the whole frame against the previous iteration.
+    struct Layer {
+        vk::MemoryBarrier2 barrier;
+        // human readable reasons for the barrier (see get_barrier_schedule())
+        std::vector<std::string> dependencies;
+        std::vector<NodeHandle> nodes;
+        // nodes split by the queue they are recorded on
+        std::vector<NodeHandle> graphics_nodes;
+        std::vector<NodeHandle> async_compute_nodes;
+        // profiler sections for the layer if recorded in parallel / on the async compute queue
+        Profiler::SectionName parallel_profiler_section;
+        Profiler::SectionName async_compute_profiler_section;
+    };
+
+    // Work that was submitted to the async compute queue but the graphics queue did not wait for
+    // yet, together with the graph resources it accesses.
+    struct PendingAsyncBatch {
+        uint64_t value;
+        std::unordered_set<const GraphResource*> resources;
+    };
+
   private:
     Graph(const GraphCreateInfo& create_info);
 
@@ -169,7 +200,7 @@ class Graph : public std::enable_shared_from_this<Graph> {
     // removes all nodes and connections from the graph.
     void reset();
 
-    // Ensures at reconnect at the next run
+    // Ensures at reconnect of the whole graph at the next run
     void request_reconnect();
 
     bool get_needs_reconnect() const;
@@ -216,9 +247,32 @@ class Graph : public std::enable_shared_from_this<Graph> {
     // Averages and deviations in the run report are computed over this period.
     void set_profiler_report_interval(const uint32_t millis);
 
+    // Number of iterations that can be in flight. The GPU times of a run report are collected when
+    // the in-flight slot is reused, i.e. they lag behind run() by that many iterations.
+    uint32_t get_iterations_in_flight() const;
+
     // Report over the period since the last one; call after the last run to summarize a benchmark.
     Profiler::Report get_run_report();
 
+    // Records a timeline of the CPU and GPU sections of the following runs (see
+    // Profiler::start_trace()). Has no effect if the profiler is disabled.
+    void start_trace();
+
+    // Waits for the in-flight iterations and returns the recorded timeline, see
+    // Profiler::get_chrome_trace() to export.
+    std::vector<Profiler::TraceEvent> stop_trace();
+
+    // --- Memory ---
+
+    // Live memory of the graph's memory allocator by owner (node identifier, "Scene",
+    // "staging", ...) and by debug name, with heap budgets and high-water marks. std::nullopt if
+    // the allocator does not track its allocations.
+    std::optional<MemoryStatistics::Report> get_memory_statistics();
+
+    // The barriers of the last connect with the dependencies they were computed from, one layer
+    // per paragraph.
+    std::string get_barrier_schedule() const;
+
     // --- Properties / Graph UI ---
 
     void properties(Properties& props);
@@ -239,6 +293,7 @@ class Graph : public std::enable_shared_from_this<Graph> {
     /*--- Properties ---*/
     void graph_properties(Properties& props);
     void profiler_properties(Properties& props);
+    void memory_properties(Properties& props);
     void io_props_for_node(Properties& config, NodeHandle& node, NodeData& data);
 
     // --- Graph run sub-tasks ---
@@ -248,10 +303,75 @@ class Graph : public std::enable_shared_from_this<Graph> {
 
     // Calls connector callbacks, checks resource states and records as well as applies descriptor
     // set updates.
-    void run_node(Submission& submission,
-                  const NodeHandle& node,
-                  NodeData& data,
-                  [[maybe_unused]] const ProfilerHandle& profiler);
+    //
+    // Does not modify the graph. Returns NEEDS_RECONNECT and REMOVE_NODE for the caller to apply,
+    // which allows recording nodes of a layer concurrently.
+    [[nodiscard]]
+    Node::NodeStatusFlags run_node(Submission& submission,
+                                   const NodeHandle& node,
+                                   NodeData& data,
+                                   const NodeProcessInfo& info,
+                                   [[maybe_unused]] const ProfilerHandle& profiler);
+
+    // Calls the on_pre_process callbacks of the node's connectors, which append their barriers.
+    [[nodiscard]]
+    Node::NodeStatusFlags
+    pre_process_connectors(Submission& submission,
+                           const NodeHandle& node,
+                           NodeData& data,
+                           std::vector<vk::ImageMemoryBarrier2>& image_barriers,
+                           std::vector<vk::BufferMemoryBarrier2>& buffer_barriers);
+
+    // Records the node's process() and handles its errors. Does not touch connector state and can
+    // be called concurrently for the nodes of a layer.
+    [[nodiscard]]
+    Node::NodeStatusFlags process_node(Submission& submission,
+                                       const NodeHandle& node,
+                                       NodeData& data,
+                                       const NodeProcessInfo& info,
+                                       [[maybe_unused]] const ProfilerHandle& profiler);
+
+    // Calls the on_post_process callbacks of the node's connectors, which append their barriers.
+    [[nodiscard]]
+    Node::NodeStatusFlags
+    post_process_connectors(Submission& submission,
+                            const NodeHandle& node,
+                            NodeData& data,
+                            std::vector<vk::ImageMemoryBarrier2>& image_barriers,
+                            std::vector<vk::BufferMemoryBarrier2>& buffer_barriers);
+
+    // Records and clears the barriers.
+    static void record_barriers(Submission& submission,
+                                std::vector<vk::ImageMemoryBarrier2>& image_barriers,
+                                std::vector<vk::BufferMemoryBarrier2>& buffer_barriers);
+
+    // Records the nodes in contiguous groups into secondary command buffers on the thread pool
+    // (the first group on the calling thread) and executes them in order in the submission of
+    // in_flight_data. The connector callbacks run serially on the calling thread, before and after
+    // the layer. Returns the status flags of each node in order.
+    std::vector<Node::NodeStatusFlags>
+    run_layer_parallel(InFlightData& in_flight_data,
+                       const std::vector<NodeHandle>& nodes,
+                       [[maybe_unused]] const ProfilerHandle& profiler);
+
+    // Submits the graphics work so far and records the nodes on the async compute queue after it.
+    // Returns the batch for the graphics queue to wait for before accessing its resources.
+    PendingAsyncBatch run_async_compute_batch(InFlightData& in_flight_data,
+                                              const std::vector<NodeHandle>& nodes);
+
+    // Lets the graphics queue wait for the pending batches that access resources of the nodes.
+    void join_async_compute(Submission& submission,
+                            const std::vector<NodeHandle>& nodes,
+                            std::vector<PendingAsyncBatch>& pending);
+
+    // Applies the flags returned by run_node.
+    void apply_run_node_flags(const NodeHandle& node,
+                              const NodeData& data,
+                              const Node::NodeStatusFlags flags);
+
+    // Reconnects the node and the nodes that consume its outputs at the next run, if the rest of
+    // the graph can be kept (see connect_downstream).
+    void request_reconnect(const NodeHandle& node);
 
     // --- Graph connect sub-tasks ---
 
@@ -269,6 +389,9 @@ class Graph : public std::enable_shared_from_this<Graph> {
     [[nodiscard]]
     bool cache_node_input_connectors();
 
+    // Calls describe_inputs() of one node and caches the result (see above).
+    void cache_node_input_connectors(const NodeHandle& node, NodeData& data);
+
     // Only for a "satisfied node". Means, all inputs are connected, or delayed or optional and will
     // not be connected.
     void cache_node_output_connectors(const NodeHandle& node, NodeData& data);
@@ -305,16 +428,41 @@ class Graph : public std::enable_shared_from_this<Graph> {
     // Returns false if failed and needs reconnect.
     bool connect_nodes(std::vector<NodeHandle>& topology);
 
+    // Reconnects only the requesting nodes and everything downstream of them, keeping the
+    // connections, resources and resource maps of all other nodes. Returns the rebuilt nodes in
+    // execution order.
+    //
+    // Requires that the cone keeps its connector names, delays, optional and disabled flags, the
+    // accesses of its inputs from outside the cone and its queue. Returns false otherwise, then
+    // the graph is left inconsistent and must be reconnected fully.
+    [[nodiscard]]
+    bool connect_downstream(const std::unordered_set<NodeHandle>& requesting_nodes,
+                            std::vector<NodeHandle>& cone_topology);
+
     void allocate_resources();
 
+    // Creates the resources for the outputs of one node.
+    void
+    allocate_node_resources(const NodeHandle& node, NodeData& data, const bool alias_transient);
+
     void precompute_resources();
 
+    void precompute_node_resources(const NodeHandle& dst_node, NodeData& dst_data);
+
+    // Calls on_connected of the outputs and then of the nodes in order.
+    void call_on_connected(const std::vector<NodeHandle>& nodes, const ProfilerHandle& profiler);
+
     std::string make_error_input_not_connected(const InputConnectorHandle& input,
                                                const NodeHandle& node,
                                                const NodeData& data);
 
+    // owner is the node that registered the listener in on_connected (nullptr for user listeners)
     void register_event_listener_for_connect(const std::string& event_pattern,
-                                             const GraphEvent::Listener& event_listener);
+                                             const GraphEvent::Listener& event_listener,
+                                             const NodeHandle& owner = nullptr);
+
+    // Removes the listeners that the nodes registered in on_connected.
+    void remove_event_listeners(const std::unordered_set<NodeHandle>& owners);
 
     void send_graph_event(const std::string& event_name,
                           const GraphEvent::Data& data = {},
@@ -340,11 +488,21 @@ class Graph : public std::enable_shared_from_this<Graph> {
     // run callbacks were called.
     void set_on_post_submit(const std::function<void()>& on_post_submit);
 
+    // Set a callback that receives every run report, i.e. once per report interval (see
+    // set_profiler_report_interval). With an interval of 0 each report covers one iteration.
+    void
+    set_on_run_report(const std::function<void(const Profiler::Report& report)>& on_run_report);
+
   private:
     // General stuff
     const ContextHandle context;
     const ResourceAllocatorHandle resource_allocator;
     const QueueHandle queue;
+    // A compute queue besides queue, nullptr if the device has none.
+    QueueHandle async_compute_queue;
+    // Orders the graphics queue and the async compute queue, strictly increasing.
+    TimelineSemaphoreHandle async_compute_semaphore;
+    uint64_t async_compute_semaphore_value = 0;
     std::shared_ptr<ExtensionVkDebugUtils> debug_utils = nullptr;
 
     ThreadPoolHandle thread_pool;
@@ -356,6 +514,7 @@ class Graph : public std::enable_shared_from_this<Graph> {
     std::function<void(const NodeProcessInfo&)> on_run_starting = [](const NodeProcessInfo&) {};
     std::function<void(const NodeProcessInfo&)> on_pre_submit = [](const NodeProcessInfo&) {};
     std::function<void()> on_post_submit = [] {};
+    std::function<void(const Profiler::Report&)> on_run_report = [](const Profiler::Report&) {};
 
     // Per-iteration data management
     uint32_t desired_iterations_in_flight = 2;
@@ -363,7 +522,12 @@ class Graph : public std::enable_shared_from_this<Graph> {
     merian::RingFences<InFlightData> ring_fences;
 
     // State
+    // full reconnect
     bool needs_reconnect = false;
+    // nodes that requested to be reconnected (see request_reconnect(node))
+    std::unordered_set<NodeHandle> reconnect_requests;
+    // If disabled, node requests reconnect the whole graph as well.
+    bool incremental_reconnect = true;
     bool profiler_enable = true;
     uint32_t profiler_report_intervall_ms = 50;
     uint32_t profiler_evict_after_ms = 5000;
@@ -394,6 +558,11 @@ class Graph : public std::enable_shared_from_this<Graph> {
     std::chrono::nanoseconds cpu_time = 0ns;
 
     bool flush_thread_pool_at_run_start = true;
+    // Opt-in: nodes of a layer record concurrently into secondary command buffers. Nodes must not
+    // share unsynchronized state then and cannot submit from process().
+    bool parallel_recording = false;
+    // Nodes with QueueAffinity::ASYNC_COMPUTE are recorded on async_compute_queue (if any).
+    bool async_compute = true;
 
     std::chrono::duration<double> gpu_wait_time = 0ns;
     int32_t limit_fps = 0;
@@ -413,6 +582,7 @@ class Graph : public std::enable_shared_from_this<Graph> {
     // is applied at the start of the next run() (so it never runs mid-iteration).
     std::string store_path;
     std::optional<std::filesystem::path> pending_load;
+    std::string memory_statistics_path = "memory_statistics.json";
     std::string imgui_event = "ui";
 
     GraphDescription loaded_description;
@@ -421,27 +591,42 @@ class Graph : public std::enable_shared_from_this<Graph> {
     std::map<std::string, NodeHandle> node_for_identifier;
     std::unordered_map<NodeHandle, NodeData> node_data;
 
-    // Nodes of one dependency layer have no ordering constraints among each other; the barrier
-    // is emitted before the layer's nodes run. Its src covers all previous layers cumulatively;
-    // layers[0].barrier orders the whole frame against the previous iteration.
-    struct Layer {
-        vk::MemoryBarrier2 barrier;
-        std::vector<NodeHandle> nodes;
-    };
     // The topology in execution order. (on build_layers)
     std::vector<Layer> layers;
 
+    // Non-persistent outputs that are not read delayed live from their producing to their last
+    // consuming layer and share heaps with outputs whose lifetimes do not overlap.
+    bool alias_transient_resources = true;
+    AliasingMemoryAllocatorHandle aliasing_memory_allocator;
+    // Wraps aliasing_memory_allocator, handed to OutputConnector::create_resource.
+    ResourceAllocatorHandle aliasing_resource_allocator;
+    // Wraps the memory allocator of resource_allocator, handed to OutputConnector::create_resource.
+    // Graph resources are shared concurrently with the async compute queue family if needed.
+    // Released resources are retained in its ResourcePool for a few reconnects.
+    ResourceAllocatorHandle graph_resource_allocator;
+
     std::shared_ptr<FrameCachingShaderObjectAllocator> shader_object_allocator;
 
     void build_layers(const std::vector<NodeHandle>& topology);
 
+    // Computes the layer barriers from the accesses of connections and aliased resources.
+    // Must run after allocate_resources.
+    void build_barriers();
+
+    // (node, output) for the owner tags of aliasing_memory_allocator. (on allocate_resources)
+    std::vector<std::pair<NodeHandle, OutputConnectorHandle>> aliasing_owners;
+
     // Store connectors that might be connected in start_nodes.
     // There may still be an invalid connection or an outputing node might be actually disabled.
     std::unordered_map<InputConnectorHandle, NodeHandle> maybe_connected_inputs;
 
     // Events
     // (NodeHandle == nullptr means user events, event with name "" means "any")
-    std::map<std::string, std::map<std::string, std::vector<GraphEvent::Listener>>> event_listeners;
+    struct EventListener {
+        NodeHandle owner;
+        GraphEvent::Listener listener;
+    };
+    std::map<std::string, std::map<std::string, std::vector<EventListener>>> event_listeners;
     inline static const std::regex EVENT_REGEX{"([^/]*)/([^/]*)/([^/]*)"};
 
     // cached here when the user calls register_event_listener and added to the data structure
@@ -467,6 +652,9 @@ class Graph : public std::enable_shared_from_this<Graph> {
     int add_connection_selected_dst_input = 0;
 
     NodeProcessInfo run_info;
+    // run_info without profiler for nodes that are recorded on worker threads or on the async
+    // compute queue.
+    NodeProcessInfo parallel_run_info;
     TimelineSemaphoreHandle iteration_semaphore;
 
     std::shared_ptr<MerianGraphExtension> context_extension;
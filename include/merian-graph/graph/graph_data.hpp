@@ -3,6 +3,8 @@
 #include "node.hpp"
 #include "resource.hpp"
 
+#include "merian/vk/utils/profiler.hpp"
+
 namespace merian {
 namespace graph_internal {
 
@@ -30,6 +32,8 @@ struct NodeData {
     // This is not the name from the node registry.
     // (on add_node)
     std::string identifier;
+    // "identifier (node type)", the section of the node in the profiler (on add_node)
+    Profiler::SectionName profiler_section;
 
     // User enabled
     bool enabled{true};
@@ -64,6 +68,8 @@ struct NodeData {
     // Dependency layer: 0 for sources, else 1 + max over producers of non-delayed inputs.
     // (on build_layers)
     uint32_t level{0};
+    // Recorded on the async compute queue. (on build_layers)
+    bool async_compute{false};
 
     // Cache input connectors (node->describe_inputs())
     // (on start_nodes added and checked for name conflicts)
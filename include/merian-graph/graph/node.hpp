@@ -64,6 +64,15 @@ class Node : public std::enable_shared_from_this<Node> {
         REMOVE_NODE = 0b100,
     };
 
+    // The queue the graph records process() for.
+    enum class QueueAffinity {
+        GRAPHICS,
+        // The node records only compute and transfer commands and may run on a dedicated compute
+        // queue, overlapping with the graphics work of the following layers. The graph falls back
+        // to the graphics queue if the device has none.
+        ASYNC_COMPUTE,
+    };
+
   public:
     Node() {}
 
@@ -196,6 +205,15 @@ class Node : public std::enable_shared_from_this<Node> {
         return {};
     }
 
+    // Called on connect. See QueueAffinity.
+    //
+    // On the async compute queue the profiler is not available (info.get_profiler() returns
+    // nullptr) and resources of the node that are not graph resources must be owned by or shared
+    // with the compute queue family (see submission.get_queue()).
+    virtual QueueAffinity get_queue_affinity() {
+        return QueueAffinity::GRAPHICS;
+    }
+
     // Do your main GPU processing here.
     //
     // You do not need to insert barriers for node inputs and outputs if not stated otherwise in the
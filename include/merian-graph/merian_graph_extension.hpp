@@ -67,7 +67,10 @@ class MerianGraphExtension : public ContextExtension {
                                                                     "hostQueryReset",
                                                                     "unifiedImageLayouts",
                                                                 },
-                                                                {}, {}, {});
+                                                                {
+                                                                    "pipelineStatisticsQuery",
+                                                                },
+                                                                {}, {});
 
         if (!aggregated.supported) {
             return aggregated;
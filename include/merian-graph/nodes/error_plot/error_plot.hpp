@@ -121,10 +121,6 @@ class ErrorPlot : public Node {
     ImGuiMerianBackendHandle imgui_backend;
     Stopwatch frametime;
 
-    // host-visible readback, one buffer per in-flight iteration so a slot is only reused once its
-    // sync_to_cpu callback has run
-    std::vector<BufferHandle> readback_buffers;
-
     std::mutex result_mutex;
     float4 latest_sum{}; // raw per-channel mean error, written by the readback callback
     bool latest_valid = false;
@@ -44,6 +44,8 @@ class MeanToBuffer : public Node {
                                  const NodeConnectionInfo& info,
                                  Submission& submission) override;
 
+    QueueAffinity get_queue_affinity() override;
+
     [[nodiscard]] NodeStatusFlags
     process(const NodeIO& io, const NodeProcessInfo& info, Submission& submission) override;
 
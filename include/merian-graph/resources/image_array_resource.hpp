@@ -1,5 +1,6 @@
 #pragma once
 
+#include "merian-graph/graph/connector_access.hpp"
 #include "merian-graph/graph/resource.hpp"
 #include "merian/vk/memory/resource_allocations.hpp"
 
@@ -60,6 +61,11 @@ class ImageArrayResource : public GraphResource {
         return *image;
     }
 
+  protected:
+    // Combined access of the output and all inputs, used for the layout transitions. Empty if
+    // unknown.
+    ConnectorAccess access;
+
   private:
     uint32_t array_size;
 };
@@ -30,6 +30,9 @@ class ManagedImageArrayResource : public ImageArrayResource {
 
   private:
     std::vector<merian::ImageHandle> images;
+    // The memory is shared with other transient resources, the contents must be discarded before
+    // every use.
+    bool aliased = false;
 
     std::optional<std::vector<merian::TextureHandle>>
         textures; // has value if usage flags indicate use as view.
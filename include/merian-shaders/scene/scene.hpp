@@ -2,6 +2,7 @@
 
 #include "merian-shaders/scene/env_map.hpp"
 #include "merian-shaders/scene/scene-data.slangh"
+#include "merian-shaders/scene/transform_hierarchy.hpp"
 #include "merian-shaders/shading/homogeneous_volume.hpp"
 #include "merian-shaders/shading/materials/material_system.hpp"
 #include "merian/shader/shader_object.hpp"
@@ -15,6 +16,7 @@
 #include "merian/vk/memory/staging_memory_manager.hpp"
 #include "merian/vk/pipeline/pipeline.hpp"
 #include "merian/vk/raytrace/as_builder.hpp"
+#include "merian/vk/utils/query_pool.hpp"
 
 #include <optional>
 #include <variant>
@@ -125,25 +127,16 @@ class Scene : public std::enable_shared_from_this<Scene> {
         NodeID parent = NODE_ID_INVALID;
         std::vector<NodeID> children;
 
+        // As passed to add_node() and update_node(). The global transforms are managed by the
+        // scene's TransformHierarchy, use get_global_transform(...).
         float4x4 local_transform = identity();
-
-        // --- Managed by Scene ---
-
-        // Empty when invalidated; children must be invalidated too.
-        std::optional<float4x4> global_transform;
-        std::optional<float4x4> global_inverse_transposed;
-
-        std::optional<float4x4> prev_global_transform;
-        std::optional<float4x4> prev_global_inverse_transposed;
-
-        bool transform_dirty = true;
     };
 
     friend inline std::string format_as(const Node& node) {
         return fmt::format(
-            "name: {}\nparent: {}\nnum children: {}\nlocal_transform:\n{}\nglobal_transform:\n{}",
+            "name: {}\nparent: {}\nnum children: {}\nlocal_transform:\n{}",
             node.name.empty() ? "<none>" : node.name, node.parent, node.children.size(),
-            node.local_transform, node.global_transform.value_or(float4x4(0)));
+            node.local_transform);
     }
 
     // --- Mesh ---
@@ -282,6 +275,12 @@ class Scene : public std::enable_shared_from_this<Scene> {
             return static_cast<const VMAMemorySubAllocation*>(suballoc.get())->get_offset();
         }
 
+        // The shared buffer suballocator the region lives in.
+        const VMAMemorySubAllocatorHandle& get_suballocator() const {
+            assert(suballoc);
+            return static_cast<const VMAMemorySubAllocation*>(suballoc.get())->get_suballocator();
+        }
+
         explicit operator bool() const {
             return static_cast<bool>(suballoc) && size > 0;
         }
@@ -377,6 +376,15 @@ class Scene : public std::enable_shared_from_this<Scene> {
         std::optional<vk::AccelerationStructureBuildSizesInfoKHR> cached_blas_size_info;
         // ----------------
 
+        // Groups without an up-to-date BLAS (e.g. deferred by the build budget) are inactive in
+        // the TLAS, their instances reference the null address.
+        vk::DeviceAddress get_tlas_blas_address() const {
+            if (!blas || blas_dirty) {
+                return 0;
+            }
+            return blas->get_acceleration_structure_device_address();
+        }
+
         const SmallSet<NodeID, 1>& get_instances(const std::vector<MeshInfo>& mesh_infos) const {
             assert(!mesh_infos.empty());
             return mesh_infos[*this->meshes.begin()].instances;
@@ -527,42 +535,25 @@ class Scene : public std::enable_shared_from_this<Scene> {
         return *scene_graph[node_id];
     }
 
-    // Guarantees that the global transform is available (unlike get_node).
-    const float4x4& get_global_transform(Node& node) {
-        if (!node.global_transform) {
-            if (node.parent != NODE_ID_INVALID) {
-                assert(node_ids.is_used(node.parent));
-                assert(scene_graph[node.parent]);
-                node.global_transform =
-                    mul(get_global_transform(*scene_graph[node.parent]), node.local_transform);
-            } else {
-                node.global_transform = node.local_transform;
-            }
-        }
-
-        return node.global_transform.value();
+    const float4x4& get_global_transform(const NodeID node_id) {
+        assert(node_ids.is_used(node_id));
+        return transform_hierarchy.get_global(node_id);
     }
 
-    // Guarantees that the global transform is available (unlike get_node).
-    const float4x4& get_global_inverse_transposed_transform(Node& node) {
-        if (!node.global_inverse_transposed) {
-            node.global_inverse_transposed = inverse(transpose(get_global_transform(node)));
-        }
-
-        return node.global_inverse_transposed.value();
+    const float4x4& get_global_inverse_transposed_transform(const NodeID node_id) {
+        assert(node_ids.is_used(node_id));
+        return transform_hierarchy.get_global_inverse_transposed(node_id);
     }
 
-    // Guarantees that the global transform is available (unlike get_node).
-    const float4x4& get_global_transform(const NodeID node_id) {
+    // The global transform of the last frame, equals the global transform for new nodes.
+    const float4x4& get_prev_global_transform(const NodeID node_id) {
         assert(node_ids.is_used(node_id));
-        assert(scene_graph[node_id]);
-        return get_global_transform(*scene_graph[node_id]);
+        return transform_hierarchy.get_prev_global(node_id);
     }
 
-    const float4x4& get_global_inverse_transposed_transform(const NodeID node_id) {
+    const float4x4& get_prev_global_inverse_transposed_transform(const NodeID node_id) {
         assert(node_ids.is_used(node_id));
-        assert(scene_graph[node_id]);
-        return get_global_inverse_transposed_transform(*scene_graph[node_id]);
+        return transform_hierarchy.get_prev_global_inverse_transposed(node_id);
     }
 
     const MeshInfo& get_mesh(const MeshID mesh_id) {
@@ -661,9 +652,6 @@ class Scene : public std::enable_shared_from_this<Scene> {
   private:
     ShaderObjectHandle build_shader_object() const;
 
-    // invalidates the global transform of this node and its children and marks the node as dirty.
-    void invalidate_node(Node& node);
-
     // Groups meshes into BLASes according to the logic above.
     // All meshes in a group share the same instances (transforms); one group = one BLAS.
     void compute_mesh_groups();
@@ -681,19 +669,42 @@ class Scene : public std::enable_shared_from_this<Scene> {
     // no internal barrier; the two dispatches touch disjoint per-mesh buffers.
     void dispatch_batched_transforms(const CommandBufferHandle& cmd);
 
-    // this only changes if the mesh groups changed or if a transform changes (TODO: selectively
-    // upload transforms)
+    // this only changes if the mesh groups, mesh buffers, material ids or transforms changed, but
+    // is uploaded every frame
     void upload_geometry_data(const CommandBufferHandle& cmd);
 
-    // this only changes if the mesh groups changed or if a transform changes (TODO: selectively
-    // upload transforms)
+    // Uploads all instance transforms after regrouping or growing the buffers. Else only the slots
+    // of moved nodes are uploaded, and in the following frame again for their prev transforms.
     void upload_transforms(const CommandBufferHandle& cmd);
+    // Uploads the given (sorted) instance slots of the four transform arrays.
+    void upload_transform_slots(const CommandBufferHandle& cmd, const std::vector<uint32_t>& slots);
 
     // uploads the meshes, geometry data, and instance transforms
     void upload_meshes(const CommandBufferHandle& cmd);
 
+    enum class BLASBuildMode : uint8_t {
+        // (re)build, if the BLAS is dirty
+        BUILD,
+        // refit the existing BLAS in place
+        UPDATE,
+        // does not fit into the build budget, inactive in the TLAS until built
+        DEFER,
+    };
+
+    // Returns how each group's BLAS is handled this frame. Update-eligible groups are refit, a
+    // blas_rebuild_fraction of them is rebuilt instead. Builds that do not fit into the frame's
+    // budget are deferred: groups that dropped out of the TLAS come first, then new BLASes closest
+    // to the camera, then the rebuilds of update-eligible groups, which fall back to a refit.
+    std::vector<BLASBuildMode> schedule_blas_builds();
     void build_blas(const CommandBufferHandle& cmd);
+
+    // Replaces the static BLASes whose compacted size query finished with compacted copies.
+    void compact_blas(const CommandBufferHandle& cmd);
+    // Rewrites the TLAS instances of moved nodes and reallocated BLASes, or all instances after
+    // regrouping, then refits or rebuilds the TLAS.
     void build_tlas(const CommandBufferHandle& cmd);
+    // Uploads the given (sorted) TLAS instances.
+    void upload_tlas_instances(const CommandBufferHandle& cmd, const std::vector<uint32_t>& slots);
 
     // Grows one shared buffer: re-suballocates every live region into a new backing buffer and
     // copies the existing data over in a single vkCmdCopyBuffer.
@@ -705,6 +716,20 @@ class Scene : public std::enable_shared_from_this<Scene> {
                                   vk::BufferUsageFlags usage,
                                   const std::string& debug_name);
 
+    // Incrementally compacts one shared buffer. Starts when the buffer is less than half occupied
+    // or its free space is fragmented by allocating a right-sized buffer that new regions go to.
+    // Then moves live regions out of the old buffer (source_slot) with GPU copies, at most
+    // `budget` bytes per call (but at least one region). The old buffer is released when empty.
+    // Returns the number of bytes moved.
+    vk::DeviceSize defragment_shared_buffer(const CommandBufferHandle& cmd,
+                                            VMAMemorySubAllocatorHandle& slot,
+                                            vk::DeviceSize& capacity_slot,
+                                            VMAMemorySubAllocatorHandle& source_slot,
+                                            MeshBufferRegion MeshInfo::* region_field,
+                                            vk::DeviceSize budget,
+                                            vk::BufferUsageFlags usage,
+                                            const std::string& debug_name);
+
     // Detail panes that double as drill-down targets from explorer lists.
     void properties_node(Properties& props, NodeID node_id);
     void properties_mesh(Properties& props, MeshID mesh_id);
@@ -769,8 +794,13 @@ class Scene : public std::enable_shared_from_this<Scene> {
     std::vector<MeshInfo> mesh_infos;
     FreeList<NodeID> node_ids;
     std::vector<std::optional<Node>> scene_graph; // sized to node_ids.size()
+    // Global and prev global transforms of the nodes, indexed with NodeID.
+    TransformHierarchy transform_hierarchy;
     bool pretransform_animated = false;
     float blas_rebuild_fraction = 0.33f;
+    // Primitives (in thousands) that BLAS builds may process per frame, 0 disables the budget.
+    // Groups that are not built yet are inactive in the TLAS.
+    uint32_t blas_build_budget_kprims = 2048;
     uint32_t current_frame = 0;
 
     UpdateChanges last_update_changes;
@@ -794,14 +824,24 @@ class Scene : public std::enable_shared_from_this<Scene> {
         uint32_t blas_builds_static = 0;
         uint32_t blas_builds_dynamic = 0;
         uint32_t blas_updates = 0;
+        uint32_t blas_builds_deferred = 0;
+        uint64_t blas_build_primitives = 0;
+        uint32_t blas_compactions = 0;
+        vk::DeviceSize blas_compaction_saved_bytes = 0;
 
         bool tlas_rebuilt = false;
+        bool tlas_refit = false;
         uint32_t tlas_instance_count = 0;
+        uint32_t tlas_instances_uploaded = 0;
 
         uint32_t buffers_allocated = 0;
         uint32_t buffers_released = 0;
 
+        uint32_t defrag_regions_moved = 0;
+        vk::DeviceSize defrag_bytes_moved = 0;
+
         vk::DeviceSize geometry_data_bytes = 0;
+        uint32_t transforms_uploaded = 0;
         vk::DeviceSize transform_data_bytes = 0;
         vk::DeviceSize tlas_instance_data_bytes = 0;
 
@@ -823,6 +863,17 @@ class Scene : public std::enable_shared_from_this<Scene> {
     std::vector<BufferHandle> pending_buffer_releases;
     std::vector<AccelerationStructureHandle> pending_blas_releases;
 
+    // Compacted size queries of the static BLASes built in one frame. The results are read once
+    // the command pool released the query pool, i.e. the GPU finished the builds.
+    struct PendingBLASCompaction {
+        QueryPoolHandle<vk::QueryType::eAccelerationStructureCompactedSizeKHR> query_pool;
+        // per query: the BLAS and the frame it was built in, stale if the group was rebuilt
+        std::vector<std::pair<std::weak_ptr<AccelerationStructure>, uint32_t>> blases;
+    };
+    std::vector<PendingBLASCompaction> pending_blas_compactions;
+    // memory saved by compacting BLASes, accumulated over all frames
+    vk::DeviceSize blas_compaction_saved_bytes = 0;
+
     // --- Cached and precomputed ---
 
     bool needs_regroup = false;      // a mesh was instanced
@@ -844,6 +895,12 @@ class Scene : public std::enable_shared_from_this<Scene> {
     vk::DeviceSize shared_vb_capacity = 0;
     vk::DeviceSize shared_prev_vb_capacity = 0;
     vk::DeviceSize shared_ib_capacity = 0;
+    // Buffers that are being compacted into the ones above, null if idle.
+    VMAMemorySubAllocatorHandle shared_vb_defrag_source;
+    VMAMemorySubAllocatorHandle shared_prev_vb_defrag_source;
+    VMAMemorySubAllocatorHandle shared_ib_defrag_source;
+    // Per-frame budget for moving regions when compacting the shared buffers, 0 disables.
+    uint32_t defrag_budget_mib = 16;
 
     std::vector<GeometryData> geometries;
     struct BLASGeometry {
@@ -856,6 +913,8 @@ class Scene : public std::enable_shared_from_this<Scene> {
     std::vector<float4x4> inverse_transposed_instance_transforms;
     std::vector<float4x4> prev_instance_transforms;
     std::vector<float4x4> prev_inverse_transposed_instance_transforms;
+    // Per instance slot: the node moved in the last upload, the prev transforms must advance.
+    std::vector<bool> prev_transform_slot_dirty;
 
     // Indexed with GeometryID (InstanceID + GeometryIndex)
     BufferHandle geometries_buffer;
@@ -864,10 +923,23 @@ class Scene : public std::enable_shared_from_this<Scene> {
     BufferHandle prev_instance_transforms_buffer;
     BufferHandle prev_inverse_transposed_instance_transforms_buffer;
 
+    // Persistent, same slots as the instance transforms. Regenerated with regrouping.
     std::vector<vk::AccelerationStructureInstanceKHR> tlas_instances;
+    std::vector<NodeID> tlas_instance_nodes;
+    // per group: the first TLAS instance slot and the BLAS address its instances reference
+    std::vector<uint32_t> tlas_group_first_instance;
+    std::vector<vk::DeviceAddress> tlas_group_blas_address;
+    // Instance slots of nodes that moved since the last TLAS build, filled by upload_transforms.
+    std::vector<uint32_t> tlas_moved_instances;
     BufferHandle tlas_instances_buffer;
     BufferHandle as_scratch_buffer;
     AccelerationStructureHandle tlas;
+    vk::BuildAccelerationStructureFlagsKHR tlas_build_flags{};
+    // Update the TLAS in place if only transforms or BLAS contents changed, rebuild every
+    // tlas_rebuild_interval updates to restore the trace performance (0: never).
+    bool tlas_refit = true;
+    uint32_t tlas_rebuild_interval = 60;
+    uint32_t tlas_refits_since_build = 0;
 
     // Batched GPU transform pipelines (lazily initialized) and reusable device buffers.
     DescriptorSetLayoutHandle transform_descriptor_layout;
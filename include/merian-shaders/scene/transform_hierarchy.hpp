@@ -0,0 +1,120 @@
+#pragma once
+
+#include "merian/utils/vector_matrix.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace merian {
+
+/**
+ * Global transforms of a node hierarchy, stored as structure of arrays in depth order: parents
+ * come before their children and every depth level is contiguous.
+ *
+ * Nodes are addressed by caller-chosen dense ids (e.g. Scene::NodeID). Setting a local transform
+ * marks the node, propagate() recomputes the marked subtrees level by level, large levels in
+ * parallel on the default thread pool. Adding and removing nodes re-sorts the arrays with the next
+ * propagate(). The getters propagate on demand.
+ *
+ * advance() makes the current global transforms of the nodes that moved since the last advance()
+ * their previous transforms. New nodes start with previous == current.
+ */
+class TransformHierarchy {
+  public:
+    static constexpr uint32_t INVALID = ~0u;
+
+    // Levels with at least this many nodes are propagated in parallel.
+    static constexpr uint32_t PARALLEL_LEVEL_SIZE = 4096;
+
+    // The parent must exist (or be INVALID), the id must be unused.
+    void add(const uint32_t id, const uint32_t parent, const float4x4& local);
+
+    // Remove the children first.
+    void remove(const uint32_t id);
+
+    // Marks the node and thus its subtree as moved.
+    void set_local(const uint32_t id, const float4x4& local);
+
+    void clear();
+
+    // Recomputes the global transforms of the moved subtrees.
+    void propagate();
+
+    // Stores the global transforms of moved nodes as their previous transforms and clears the
+    // moved flags.
+    void advance();
+
+    // -----------------------------------------------------------
+
+    bool contains(const uint32_t id) const {
+        return id < slot_of.size() && slot_of[id] != INVALID;
+    }
+
+    // Number of nodes.
+    uint32_t size() const {
+        return node_count;
+    }
+
+    // Number of depth levels after the last propagate().
+    uint32_t get_depth() const {
+        return level_offsets.empty() ? 0 : static_cast<uint32_t>(level_offsets.size() - 1);
+    }
+
+    const float4x4& get_local(const uint32_t id) const;
+
+    const float4x4& get_global(const uint32_t id);
+
+    const float4x4& get_global_inverse_transposed(const uint32_t id);
+
+    const float4x4& get_prev_global(const uint32_t id);
+
+    const float4x4& get_prev_global_inverse_transposed(const uint32_t id);
+
+    // The node or one of its ancestors got a new local transform since the last advance(), or the
+    // node was added since then.
+    bool is_moved(const uint32_t id);
+
+  private:
+    enum Flags : uint8_t {
+        LOCAL_DIRTY = 1,
+        MOVED = 2,
+        NEW = 4,
+        REMOVED = 8,
+    };
+
+    uint32_t slot(const uint32_t id) const;
+
+    // Sorts the slots by depth and drops removed slots.
+    void sort();
+
+    void propagate_slot(const uint32_t slot);
+
+    // id -> slot, INVALID if unused
+    std::vector<uint32_t> slot_of;
+    uint32_t node_count = 0;
+
+    // per slot, in depth order unless topology_dirty
+    std::vector<uint32_t> id_of;
+    std::vector<uint32_t> parent_id;
+    std::vector<uint32_t> parent_slot;
+    std::vector<uint32_t> depth;
+    std::vector<uint8_t> flags;
+    // last propagate() pass that recomputed the slot, children follow their recomputed parents
+    std::vector<uint64_t> propagated_in_pass;
+    std::vector<float4x4> local;
+    std::vector<float4x4> global;
+    std::vector<float4x4> global_inverse_transposed;
+    std::vector<float4x4> prev_global;
+    std::vector<float4x4> prev_global_inverse_transposed;
+
+    // level i is [level_offsets[i], level_offsets[i + 1])
+    std::vector<uint32_t> level_offsets;
+
+    // nodes were added or removed since the last sort
+    bool topology_dirty = false;
+    // shallowest level with a node with LOCAL_DIRTY, INVALID if none
+    uint32_t first_dirty_level = INVALID;
+    uint64_t pass = 0;
+};
+
+} // namespace merian
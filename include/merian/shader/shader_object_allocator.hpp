@@ -5,6 +5,7 @@
 #include "merian/vk/memory/resource_allocator.hpp"
 
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
 namespace merian {
@@ -38,6 +39,7 @@ class SimpleShaderObjectAllocator : public ShaderObjectAllocator {
     const ResourceAllocatorHandle allocator;
 };
 
+// allocate() may be called concurrently (e.g. by nodes recording in parallel).
 class FrameCachingShaderObjectAllocator : public ShaderObjectAllocator {
   public:
     FrameCachingShaderObjectAllocator(const ResourceAllocatorHandle& allocator,
@@ -64,6 +66,7 @@ class FrameCachingShaderObjectAllocator : public ShaderObjectAllocator {
         std::vector<bool> replayed;
     };
     std::unordered_map<ShaderObject*, Entry> cache;
+    std::mutex cache_mutex;
 };
 
 } // namespace merian
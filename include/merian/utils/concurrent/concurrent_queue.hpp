@@ -35,7 +35,8 @@ template <typename T> class ConcurrentQueue {
         cv_full.wait(lk, [&] { return q.size() < max_size; });
         q.push(value);
         lk.unlock();
-        cv_empty.notify_all();
+        // only pop() waits for cv_empty, one item can only satisfy one of them
+        cv_empty.notify_one();
     }
 
     void push(const T& value, const uint64_t max_size = UINT64_MAX) {
@@ -43,7 +44,8 @@ template <typename T> class ConcurrentQueue {
         cv_full.wait(lk, [&] { return q.size() < max_size; });
         q.push(value);
         lk.unlock();
-        cv_empty.notify_all();
+        // only pop() waits for cv_empty, one item can only satisfy one of them
+        cv_empty.notify_one();
     }
 
     std::size_t size() {
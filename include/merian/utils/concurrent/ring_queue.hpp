@@ -0,0 +1,289 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace merian {
+
+namespace detail {
+
+// Not std::hardware_destructive_interference_size, its value is not ABI stable.
+inline constexpr std::size_t RING_QUEUE_CACHE_LINE_SIZE = 64;
+
+// Lets threads block until a ring queue changes without a lock. Notifying is one increment,
+// atomic::notify_one skips the wake-up if nobody waits and otherwise wakes a single waiter.
+class RingQueueWaiter {
+  public:
+    // Calls attempt() until its result converts to true and returns it. Blocks between attempts
+    // until notify() is called.
+    template <typename Attempt> auto wait_for(Attempt&& attempt) {
+        while (true) {
+            // read before the attempt: a change the attempt missed increments the epoch later
+            const uint32_t observed = epoch.load(std::memory_order_acquire);
+            if (auto result = attempt()) {
+                return result;
+            }
+            epoch.wait(observed, std::memory_order_acquire);
+        }
+    }
+
+    void notify() {
+        epoch.fetch_add(1, std::memory_order_release);
+        epoch.notify_one();
+    }
+
+  private:
+    std::atomic_uint32_t epoch{0};
+};
+
+} // namespace detail
+
+// A lock-free bounded multi-producer multi-consumer queue (Vyukov's ring of sequenced cells).
+//
+// try_push / try_pop never block and fail if the queue is full / empty, push / pop wait. The
+// capacity is rounded up to a power of two. Unlike ConcurrentQueue there is no lock and no
+// notify_all: blocked threads are woken one at a time and only if there are any.
+template <typename T> class MPMCRingQueue {
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+                  "a value must not throw while it is moved into a claimed cell");
+
+  public:
+    explicit MPMCRingQueue(const std::size_t capacity)
+        : mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+          cells(std::make_unique<Cell[]>(mask + 1)) {
+        for (std::size_t i = 0; i <= mask; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MPMCRingQueue() {
+        while (try_pop()) {
+        }
+    }
+
+    MPMCRingQueue(const MPMCRingQueue&) = delete;
+    MPMCRingQueue& operator=(const MPMCRingQueue&) = delete;
+
+    // Returns false if the queue is full, value is only moved from on success.
+    bool try_push(T&& value) {
+        Cell* cell;
+        std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells[pos & mask];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const std::intptr_t diff = (std::intptr_t)sequence - (std::intptr_t)pos;
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // the consumer one lap behind did not free this cell yet
+                return false;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (cell->storage) T(std::move(value));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        not_empty.notify();
+        return true;
+    }
+
+    bool try_push(const T& value) {
+        T copy(value);
+        return try_push(std::move(copy));
+    }
+
+    std::optional<T> try_pop() {
+        Cell* cell;
+        std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells[pos & mask];
+            const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const std::intptr_t diff = (std::intptr_t)sequence - (std::intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return std::nullopt;
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        T* stored = std::launder(reinterpret_cast<T*>(cell->storage));
+        std::optional<T> value(std::move(*stored));
+        stored->~T();
+        // free for the producer of the next lap
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        not_full.notify();
+        return value;
+    }
+
+    // Waits while the queue is full.
+    void push(T&& value) {
+        not_full.wait_for([&]() { return try_push(std::move(value)); });
+    }
+
+    void push(const T& value) {
+        T copy(value);
+        push(std::move(copy));
+    }
+
+    // Waits while the queue is empty.
+    T pop() {
+        return std::move(*not_empty.wait_for([&]() { return try_pop(); }));
+    }
+
+    // Only a snapshot if other threads push or pop concurrently.
+    std::size_t size() const {
+        const std::size_t dequeued = dequeue_pos.load();
+        const std::size_t enqueued = enqueue_pos.load();
+        return enqueued > dequeued ? std::min(enqueued - dequeued, capacity()) : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    std::size_t capacity() const {
+        return mask + 1;
+    }
+
+  private:
+    struct Cell {
+        std::atomic_size_t sequence;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    const std::size_t mask;
+    const std::unique_ptr<Cell[]> cells;
+
+    // producers and consumers should not invalidate each others cache line
+    alignas(detail::RING_QUEUE_CACHE_LINE_SIZE) std::atomic_size_t enqueue_pos{0};
+    alignas(detail::RING_QUEUE_CACHE_LINE_SIZE) std::atomic_size_t dequeue_pos{0};
+
+    detail::RingQueueWaiter not_empty;
+    detail::RingQueueWaiter not_full;
+};
+
+// A lock-free bounded queue for exactly one producer and one consumer thread.
+//
+// Cheaper than MPMCRingQueue since no compare-and-swap is needed, otherwise the same interface.
+template <typename T> class SPSCRingQueue {
+    static_assert(std::is_nothrow_move_constructible_v<T>);
+
+  public:
+    explicit SPSCRingQueue(const std::size_t capacity)
+        : mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+          slots(std::make_unique<Slot[]>(mask + 1)) {}
+
+    ~SPSCRingQueue() {
+        while (try_pop()) {
+        }
+    }
+
+    SPSCRingQueue(const SPSCRingQueue&) = delete;
+    SPSCRingQueue& operator=(const SPSCRingQueue&) = delete;
+
+    // Producer only. Returns false if the queue is full, value is only moved from on success.
+    bool try_push(T&& value) {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head_cache > mask) {
+            head_cache = head.load(std::memory_order_acquire);
+            if (t - head_cache > mask) {
+                return false;
+            }
+        }
+
+        new (slots[t & mask].storage) T(std::move(value));
+        tail.store(t + 1, std::memory_order_release);
+        not_empty.notify();
+        return true;
+    }
+
+    bool try_push(const T& value) {
+        T copy(value);
+        return try_push(std::move(copy));
+    }
+
+    // Consumer only.
+    std::optional<T> try_pop() {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail_cache) {
+            tail_cache = tail.load(std::memory_order_acquire);
+            if (h == tail_cache) {
+                return std::nullopt;
+            }
+        }
+
+        T* stored = std::launder(reinterpret_cast<T*>(slots[h & mask].storage));
+        std::optional<T> value(std::move(*stored));
+        stored->~T();
+        head.store(h + 1, std::memory_order_release);
+        not_full.notify();
+        return value;
+    }
+
+    // Producer only, waits while the queue is full.
+    void push(T&& value) {
+        not_full.wait_for([&]() { return try_push(std::move(value)); });
+    }
+
+    void push(const T& value) {
+        T copy(value);
+        push(std::move(copy));
+    }
+
+    // Consumer only, waits while the queue is empty.
+    T pop() {
+        return std::move(*not_empty.wait_for([&]() { return try_pop(); }));
+    }
+
+    // Only a snapshot if the other thread pushes or pops concurrently.
+    std::size_t size() const {
+        const std::size_t h = head.load();
+        const std::size_t t = tail.load();
+        return t - h;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    std::size_t capacity() const {
+        return mask + 1;
+    }
+
+  private:
+    struct Slot {
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    const std::size_t mask;
+    const std::unique_ptr<Slot[]> slots;
+
+    // consumer side: position and the last seen tail
+    alignas(detail::RING_QUEUE_CACHE_LINE_SIZE) std::atomic_size_t head{0};
+    std::size_t tail_cache = 0;
+
+    // producer side: position and the last seen head
+    alignas(detail::RING_QUEUE_CACHE_LINE_SIZE) std::atomic_size_t tail{0};
+    std::size_t head_cache = 0;
+
+    detail::RingQueueWaiter not_empty;
+    detail::RingQueueWaiter not_full;
+};
+
+} // namespace merian
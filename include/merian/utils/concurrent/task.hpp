@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace merian {
+
+// A move-only void() callable for the thread pool. Callables up to INLINE_SIZE bytes (e.g. a
+// lambda capturing a few pointers, a std::function or a std::promise) are stored inline, larger
+// ones are allocated on the heap.
+class Task {
+  public:
+    static constexpr std::size_t INLINE_SIZE = 64;
+
+    Task() noexcept = default;
+
+    template <typename F>
+        requires(!std::is_same_v<std::remove_cvref_t<F>, Task> &&
+                 std::is_invocable_v<std::remove_cvref_t<F>&>)
+    Task(F&& function) {
+        using Function = std::remove_cvref_t<F>;
+        if constexpr (fits_inline<Function>()) {
+            new (storage) Function(std::forward<F>(function));
+            ops = &inline_ops<Function>;
+        } else {
+            *reinterpret_cast<Function**>(storage) = new Function(std::forward<F>(function));
+            ops = &heap_ops<Function>;
+        }
+    }
+
+    Task(const Task&) = delete;
+
+    Task(Task&& other) noexcept : ops(other.ops) {
+        if (ops) {
+            ops->move(other.storage, storage);
+            other.ops = nullptr;
+        }
+    }
+
+    Task& operator=(const Task&) = delete;
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            ops = other.ops;
+            if (ops) {
+                ops->move(other.storage, storage);
+                other.ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    ~Task() {
+        reset();
+    }
+
+    void operator()() {
+        assert(ops && "calling an empty task");
+        ops->invoke(storage);
+    }
+
+    explicit operator bool() const noexcept {
+        return ops != nullptr;
+    }
+
+    void reset() noexcept {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+    // True if a callable of this type is stored without allocation.
+    template <typename F> static constexpr bool fits_inline() {
+        return sizeof(F) <= INLINE_SIZE && alignof(F) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<F>;
+    }
+
+  private:
+    struct Ops {
+        void (*invoke)(std::byte* storage);
+        // move constructs into dst and destroys src
+        void (*move)(std::byte* src, std::byte* dst) noexcept;
+        void (*destroy)(std::byte* storage) noexcept;
+    };
+
+    template <typename F>
+    static constexpr Ops inline_ops{
+        [](std::byte* storage) { (*std::launder(reinterpret_cast<F*>(storage)))(); },
+        [](std::byte* src, std::byte* dst) noexcept {
+            F* function = std::launder(reinterpret_cast<F*>(src));
+            new (dst) F(std::move(*function));
+            function->~F();
+        },
+        [](std::byte* storage) noexcept { std::launder(reinterpret_cast<F*>(storage))->~F(); },
+    };
+
+    template <typename F>
+    static constexpr Ops heap_ops{
+        [](std::byte* storage) { (**reinterpret_cast<F**>(storage))(); },
+        [](std::byte* src, std::byte* dst) noexcept {
+            *reinterpret_cast<F**>(dst) = *reinterpret_cast<F**>(src);
+        },
+        [](std::byte* storage) noexcept { delete *reinterpret_cast<F**>(storage); },
+    };
+
+    const Ops* ops = nullptr;
+    alignas(std::max_align_t) std::byte storage[INLINE_SIZE];
+};
+
+} // namespace merian
@@ -1,19 +1,31 @@
 #pragma once
 
-#include "merian/utils/concurrent/concurrent_queue.hpp"
-
-#include <barrier>
+#include "merian/utils/concurrent/ring_queue.hpp"
+#include "merian/utils/concurrent/task.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <future>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <thread>
 #include <vector>
 
 namespace merian {
 
+// A work-stealing thread pool.
+//
+// Each worker owns a deque: tasks submitted from a worker are pushed to and popped from the back
+// of its own deque, idle workers steal from the front of the others. Tasks submitted from other
+// threads go through a shared lock-free injection queue. Locks are per deque, so workers only
+// contend when stealing.
 class ThreadPool {
   public:
-    // concurrency sets the number of threads. queue_size controls the size of the task queue.
-    // While the task queue is full, submit blocks.
+    // concurrency sets the number of threads.
     ThreadPool(const uint32_t concurrency = std::thread::hardware_concurrency());
 
     ~ThreadPool();
@@ -36,26 +48,38 @@ class ThreadPool {
     uint32_t size();
 
     template <typename T> std::future<T> submit(const std::function<T()>& function) {
-        std::shared_ptr<std::packaged_task<T()>> task =
-            std::make_shared<std::packaged_task<T()>>(function);
-        std::future<T> future = task->get_future();
-        tasks.push([task] { (*task)(); });
+        std::promise<T> promise;
+        std::future<T> future = promise.get_future();
+        execute([promise = std::move(promise), function]() mutable {
+            fulfill(promise, function);
+        });
         return future;
     }
 
     template <typename T> std::future<T> submit(const std::function<T()>&& function) {
-        std::shared_ptr<std::packaged_task<T()>> task =
-            std::make_shared<std::packaged_task<T()>>(function);
-        std::future<T> future = task->get_future();
-        tasks.push([task] { (*task)(); });
+        std::promise<T> promise;
+        std::future<T> future = promise.get_future();
+        execute([promise = std::move(promise), function = std::move(function)]() mutable {
+            fulfill(promise, function);
+        });
         return future;
     }
 
+    // Submits a task without a future. Does not allocate if the callable fits into a Task.
+    void execute(Task&& task);
+
+    // Runs one queued task on the calling thread, returns false if there was none. Lets threads
+    // that wait for tasks of this pool help instead of blocking a worker.
+    bool run_pending_task();
+
+    // True if called from one of the threads of this pool.
+    bool is_worker_thread() const;
+
     // returns the number of enqueued tasks. Note that the tasks currently being worked on aren't
     // counted.
     std::size_t queue_size();
 
-    // waits until all to this point submitted tasks are finished.
+    // waits until all to this point submitted tasks are finished. Must not be called from a task.
     void wait_idle();
 
     // waits until the task queue is empty. Note that threads might still work on their last item.
@@ -63,12 +87,100 @@ class ThreadPool {
     void wait_empty();
 
   private:
-    std::vector<std::thread> threads;
-    ConcurrentQueue<std::optional<std::function<void()>>> tasks;
+    // tasks submitted from non-worker threads, the overflow queue is used if it is full
+    static constexpr std::size_t INJECTION_QUEUE_CAPACITY = 1024;
+
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    template <typename T, typename F> static void fulfill(std::promise<T>& promise, F& function) {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                function();
+                promise.set_value();
+            } else {
+                promise.set_value(function());
+            }
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    }
+
+    void start_workers(const uint32_t concurrency);
+
+    void worker_loop(const uint32_t worker_index);
+
+    // own deque (back), injection queue and its overflow, then steal (front). worker_index ==
+    // size() for threads that are not workers of this pool.
+    std::optional<Task> take_task(const uint32_t worker_index);
+
+    void run_task(Task& task);
+
+    void notify_waiters();
 
-    std::barrier<void (*)(void) noexcept> wait_idle_barrier;
+    std::vector<std::thread> threads;
+    // one per worker, the last one is the overflow of the injection queue
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    MPMCRingQueue<Task> injection_queue{INJECTION_QUEUE_CAPACITY};
+
+    std::atomic_uint64_t pending{0};
+    // tasks that were taken but did not finish yet
+    std::atomic_uint64_t active{0};
+    std::atomic_uint32_t sleeping{0};
+    bool stop = false;
+
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_cv;
+    // notified when pending reaches 0 and when pending and active reach 0
+    std::condition_variable idle_cv;
 };
 
 using ThreadPoolHandle = std::shared_ptr<ThreadPool>;
 
+// A process-wide pool with one thread per hardware thread, created on first use. Shared by the
+// parallel algorithms (see utils.hpp) so they do not spawn threads per call.
+ThreadPool& get_default_thread_pool();
+
+// Tasks that can be awaited together. wait() runs tasks of the pool while the group is not done,
+// so groups can be waited for from within tasks of the same pool without deadlocking.
+//
+// The first exception thrown by a task is rethrown by wait().
+class TaskGroup {
+  public:
+    explicit TaskGroup(ThreadPool& thread_pool);
+
+    // Waits for all tasks, exceptions are dropped.
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename F> void run(F&& function) {
+        outstanding.fetch_add(1);
+        thread_pool.execute([this, function = std::forward<F>(function)]() mutable {
+            try {
+                function();
+            } catch (...) {
+                set_exception(std::current_exception());
+            }
+            finish();
+        });
+    }
+
+    void wait();
+
+  private:
+    void set_exception(std::exception_ptr exception);
+
+    void finish();
+
+    ThreadPool& thread_pool;
+    std::atomic_uint64_t outstanding{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::exception_ptr exception;
+};
+
 } // namespace merian
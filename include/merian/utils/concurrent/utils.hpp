@@ -2,49 +2,192 @@
 
 #include "merian/utils/concurrent/thread_pool.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <concepts>
 #include <cstdint>
 #include <functional>
+#include <iterator>
 #include <thread>
+#include <type_traits>
+#include <vector>
 
 namespace merian {
 
-// Run a function `count` times split into 'tasks' tasks.
-// The function gets the index [0,count) and the task index
-// [0,concurrency).
-inline void parallel_for(const uint32_t count,
-                         const std::function<void(uint32_t index, uint32_t thread_index)> function,
-                         ThreadPool& thread_pool,
-                         const uint32_t tasks = std::thread::hardware_concurrency()) {
+namespace detail {
+
+// Chunks per task if no grain size is given. More chunks balance uneven work better, fewer reduce
+// the contention on the shared counter.
+inline constexpr uint32_t PARALLEL_CHUNKS_PER_TASK = 8;
+
+inline uint32_t parallel_grain_size(const uint32_t count,
+                                    const uint32_t tasks,
+                                    const uint32_t grain_size) {
+    if (grain_size > 0) {
+        return grain_size;
+    }
+    return std::max(1u, count / (std::max(1u, tasks) * PARALLEL_CHUNKS_PER_TASK));
+}
+
+// Runs runner(task_index) for task_index in [0, tasks): task 0 on the calling thread, the others in
+// the pool. Waiting helps the pool, thus this can be called from tasks of the same pool.
+template <typename Runner>
+void parallel_run(const uint32_t tasks, Runner& runner, ThreadPool& thread_pool) {
+    TaskGroup group(thread_pool);
+    for (uint32_t task_index = 1; task_index < tasks; task_index++) {
+        group.run([&runner, task_index]() { runner(task_index); });
+    }
+    // if this throws the group destructor waits for the tasks that reference runner
+    runner(0);
+    group.wait();
+}
+
+} // namespace detail
+
+// Calls function(index, task_index) or function(index) for every index in [0, count).
+//
+// The range is split into chunks of grain_size indices (0 picks a size that results in a few chunks
+// per task) that up to `tasks` tasks take from a shared counter, so that uneven work is balanced.
+// The calling thread takes part. The task index in [0, tasks) can be used to address per-task
+// scratch memory, at most one call with the same task index runs at a time.
+//
+// Can be called from tasks of thread_pool (nesting). The first exception is rethrown.
+template <typename F>
+    requires std::invocable<F&, uint32_t, uint32_t> || std::invocable<F&, uint32_t>
+void parallel_for(const uint32_t count,
+                  F&& function,
+                  ThreadPool& thread_pool,
+                  const uint32_t tasks = std::thread::hardware_concurrency(),
+                  const uint32_t grain_size = 0) {
     if (count == 0)
         return;
 
-    std::vector<std::future<void>> futures;
-    uint32_t real_concurrency = std::min(count, tasks);
-    uint32_t count_per_thread = (count + real_concurrency - 1) / real_concurrency;
+    const uint32_t grain = detail::parallel_grain_size(count, tasks, grain_size);
+    const uint32_t chunk_count = (count + grain - 1) / grain;
+    const uint32_t real_tasks =
+        std::clamp(std::min(tasks, thread_pool.size() + 1), 1u, chunk_count);
 
-    for (uint32_t thread_index = 0; thread_index < real_concurrency; thread_index++) {
-        futures.emplace_back(
-            thread_pool.submit<void>([thread_index, count_per_thread, count, &function]() {
-                for (uint32_t index = thread_index * count_per_thread;
-                     index < std::min((thread_index + 1) * count_per_thread, count); index++) {
-                    function(index, thread_index);
+    std::atomic_uint32_t next_chunk{0};
+    const auto runner = [&](const uint32_t task_index) {
+        for (uint32_t chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+             chunk < chunk_count; chunk = next_chunk.fetch_add(1, std::memory_order_relaxed)) {
+            const uint32_t end = std::min(count - chunk * grain, grain) + chunk * grain;
+            for (uint32_t index = chunk * grain; index < end; index++) {
+                if constexpr (std::is_invocable_v<F&, uint32_t, uint32_t>) {
+                    function(index, task_index);
+                } else {
+                    function(index);
                 }
-            }));
+            }
+        }
+    };
+
+    if (real_tasks == 1) {
+        runner(0);
+        return;
     }
+    detail::parallel_run(real_tasks, runner, thread_pool);
+}
+
+// Like above, uses the default thread pool.
+template <typename F>
+    requires std::invocable<F&, uint32_t, uint32_t> || std::invocable<F&, uint32_t>
+void parallel_for(const uint32_t count,
+                  F&& function,
+                  const uint32_t tasks = std::thread::hardware_concurrency(),
+                  const uint32_t grain_size = 0) {
+    parallel_for(count, std::forward<F>(function), get_default_thread_pool(), tasks, grain_size);
+}
+
+// Reduces map(index) for index in [0, count) using reduce(T, T) -> T starting with identity.
+//
+// Each chunk of grain_size indices is reduced separately and the chunk results are combined in
+// index order. Thus, reduce must be associative and need not be commutative, and the result does
+// not depend on scheduling (e.g. floating point sums are reproducible for the same grain size).
+template <typename T, typename Map, typename Reduce>
+    requires std::invocable<Map&, uint32_t> && std::invocable<Reduce&, T, T>
+T parallel_reduce(const uint32_t count,
+                  const T& identity,
+                  Map&& map,
+                  Reduce&& reduce,
+                  ThreadPool& thread_pool = get_default_thread_pool(),
+                  const uint32_t grain_size = 0) {
+    if (count == 0)
+        return identity;
+
+    const uint32_t grain = detail::parallel_grain_size(
+        count, std::min(std::thread::hardware_concurrency(), thread_pool.size() + 1), grain_size);
+    const uint32_t chunk_count = (count + grain - 1) / grain;
 
-    for (auto& future : futures) {
-        future.get();
+    std::vector<T> partials(chunk_count, identity);
+    parallel_for(
+        chunk_count,
+        [&](const uint32_t chunk) {
+            const uint32_t end = std::min(count - chunk * grain, grain) + chunk * grain;
+            T partial = identity;
+            for (uint32_t index = chunk * grain; index < end; index++) {
+                partial = reduce(std::move(partial), map(index));
+            }
+            partials[chunk] = std::move(partial);
+        },
+        thread_pool, std::thread::hardware_concurrency(), 1);
+
+    T result = identity;
+    for (T& partial : partials) {
+        result = reduce(std::move(result), std::move(partial));
     }
+    return result;
 }
 
-// Run a function `count` times split into 'tasks' tasks.
-// The function gets the index [0,count) and the task index
-// [0,concurrency).
-inline void parallel_for(const uint32_t count,
-                         const std::function<void(uint32_t index, uint32_t thread_index)> function,
-                         const uint32_t tasks = std::thread::hardware_concurrency()) {
-    ThreadPool thread_pool(std::thread::hardware_concurrency());
-    parallel_for(count, function, thread_pool, tasks);
+// Sorts [first, last) with compare. Blocks of at least grain_size elements are sorted in parallel,
+// then neighboring blocks are merged pairwise in parallel. Not stable.
+template <typename RandomIt, typename Compare = std::less<>>
+    requires std::random_access_iterator<RandomIt>
+void parallel_sort(RandomIt first,
+                   RandomIt last,
+                   Compare compare = {},
+                   ThreadPool& thread_pool = get_default_thread_pool(),
+                   const std::size_t grain_size = 1 << 14) {
+    const std::size_t size = std::distance(first, last);
+    const std::size_t max_blocks = size / std::max<std::size_t>(grain_size, 1);
+    const std::size_t block_count = std::min<std::size_t>(max_blocks, thread_pool.size() + 1);
+    if (block_count < 2) {
+        std::sort(first, last, compare);
+        return;
+    }
+
+    // boundaries[i] is the start of block i, boundaries.back() == size
+    std::vector<std::size_t> boundaries(block_count + 1);
+    for (std::size_t i = 0; i <= block_count; i++) {
+        boundaries[i] = size * i / block_count;
+    }
+
+    parallel_for(
+        block_count,
+        [&](const uint32_t block) {
+            std::sort(first + boundaries[block], first + boundaries[block + 1], compare);
+        },
+        thread_pool, block_count, 1);
+
+    while (boundaries.size() > 2) {
+        const uint32_t merges = (boundaries.size() - 1) / 2;
+        parallel_for(
+            merges,
+            [&](const uint32_t merge) {
+                std::inplace_merge(first + boundaries[2 * merge], first + boundaries[2 * merge + 1],
+                                   first + boundaries[2 * merge + 2], compare);
+            },
+            thread_pool, merges, 1);
+
+        std::vector<std::size_t> merged;
+        for (std::size_t i = 0; i < boundaries.size(); i += 2) {
+            merged.emplace_back(boundaries[i]);
+        }
+        if (merged.back() != size) {
+            merged.emplace_back(size);
+        }
+        boundaries = std::move(merged);
+    }
 }
 
 } // namespace merian
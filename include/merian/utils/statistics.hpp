@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace merian {
+
+// Percentile p in [0, 100] of sorted values, linearly interpolated between the closest ranks (like
+// numpy's default). Returns 0 for no values.
+inline double percentile_of_sorted(const std::vector<double>& sorted, const double p) noexcept {
+    assert(std::is_sorted(sorted.begin(), sorted.end()));
+    if (sorted.empty()) {
+        return 0;
+    }
+    const double rank = std::clamp(p, 0., 100.) / 100. * (sorted.size() - 1);
+    const std::size_t lower = (std::size_t)std::floor(rank);
+    const std::size_t upper = std::min(lower + 1, sorted.size() - 1);
+    return sorted[lower] + (rank - lower) * (sorted[upper] - sorted[lower]);
+}
+
+// Order statistics of a set of samples, e.g. per-iteration timings of a benchmark.
+struct SampleStatistics {
+    uint64_t count = 0;
+    double min = 0;
+    double max = 0;
+    double mean = 0;
+    double median = 0;
+    double p95 = 0;
+    double p99 = 0;
+
+    static SampleStatistics compute(std::vector<double> samples) {
+        SampleStatistics stats;
+        if (samples.empty()) {
+            return stats;
+        }
+        std::sort(samples.begin(), samples.end());
+
+        stats.count = samples.size();
+        stats.min = samples.front();
+        stats.max = samples.back();
+        stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+        stats.median = percentile_of_sorted(samples, 50);
+        stats.p95 = percentile_of_sorted(samples, 95);
+        stats.p99 = percentile_of_sorted(samples, 99);
+        return stats;
+    }
+};
+
+// Fixed-size histogram of non-negative integers (e.g. durations in ns) for percentiles without
+// keeping the samples. Like HdrHistogram, each power of two is split linearly into SUB_BUCKETS
+// buckets, so percentiles have a relative error below 1 / SUB_BUCKETS. Values of at least
+// 2^MAX_BITS land in the last bucket; min() and max() are exact.
+class LogHistogram {
+  public:
+    static constexpr uint32_t SUB_BUCKET_BITS = 4;
+    static constexpr uint32_t SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+    // about 68 s for nanoseconds
+    static constexpr uint32_t MAX_BITS = 36;
+    static constexpr uint32_t BUCKET_COUNT = (MAX_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    void record(const uint64_t value) noexcept {
+        if (counts.empty()) {
+            // allocated on first use, many histograms are never recorded into
+            counts.resize(BUCKET_COUNT);
+        }
+        counts[bucket_index(value)]++;
+        total++;
+        min_value = std::min(min_value, value);
+        max_value = std::max(max_value, value);
+    }
+
+    void clear() noexcept {
+        std::fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        min_value = std::numeric_limits<uint64_t>::max();
+        max_value = 0;
+    }
+
+    uint64_t count() const noexcept {
+        return total;
+    }
+
+    uint64_t min() const noexcept {
+        return total > 0 ? min_value : 0;
+    }
+
+    uint64_t max() const noexcept {
+        return max_value;
+    }
+
+    // Percentile p in [0, 100] (nearest rank), the middle of the bucket that contains it clamped
+    // to [min(), max()]. The first and last rank are exact. Returns 0 if nothing was recorded.
+    uint64_t percentile(const double p) const noexcept {
+        if (total == 0) {
+            return 0;
+        }
+        const uint64_t rank = std::max<uint64_t>(
+            1, (uint64_t)std::ceil(std::clamp(p, 0., 100.) / 100. * (double)total));
+        // the extremes are known exactly
+        if (rank == 1) {
+            return min();
+        }
+        if (rank >= total) {
+            return max();
+        }
+
+        uint64_t seen = 0;
+        uint32_t index = 0;
+        for (; index < BUCKET_COUNT - 1; index++) {
+            seen += counts[index];
+            if (seen >= rank) {
+                break;
+            }
+        }
+        const auto [lower, width] = bucket_range(index);
+        return std::clamp(lower + (width - 1) / 2, min(), max());
+    }
+
+    static uint32_t bucket_index(const uint64_t value) noexcept {
+        const uint64_t clamped = std::min(value, (uint64_t(1) << MAX_BITS) - 1);
+        if (clamped < SUB_BUCKETS) {
+            return (uint32_t)clamped;
+        }
+        const uint32_t shift = std::bit_width(clamped) - 1 - SUB_BUCKET_BITS;
+        return ((shift + 1) * SUB_BUCKETS) + (uint32_t)((clamped >> shift) - SUB_BUCKETS);
+    }
+
+    // (lowest value, number of values) of a bucket
+    static std::pair<uint64_t, uint64_t> bucket_range(const uint32_t index) noexcept {
+        const uint32_t block = index / SUB_BUCKETS;
+        const uint64_t sub_bucket = index % SUB_BUCKETS;
+        if (block == 0) {
+            return {sub_bucket, 1};
+        }
+        const uint32_t shift = block - 1;
+        return {(SUB_BUCKETS + sub_bucket) << shift, uint64_t(1) << shift};
+    }
+
+  private:
+    std::vector<uint32_t> counts;
+    uint64_t total = 0;
+    uint64_t min_value = std::numeric_limits<uint64_t>::max();
+    uint64_t max_value = 0;
+};
+
+} // namespace merian
@@ -551,6 +551,12 @@ class CommandBuffer : public std::enable_shared_from_this<CommandBuffer> {
     // ------------------------------------------------------------
     // MISC
 
+    // Executes a secondary command buffer. The caller keeps it (and its pool) alive until this
+    // command buffer finished executing.
+    void execute_commands(const CommandBufferHandle& secondary) {
+        cmd.executeCommands(secondary->get_command_buffer());
+    }
+
     void set_event(const EventHandle& event, const vk::PipelineStageFlags stage_mask) {
         cmd.setEvent(*event, stage_mask);
         keep_until_pool_reset(event);
@@ -623,6 +629,21 @@ class CommandBuffer : public std::enable_shared_from_this<CommandBuffer> {
         keep_until_pool_reset(query_pool);
     }
 
+    template <vk::QueryType QUERY_TYPE>
+    void begin_query(const QueryPoolHandle<QUERY_TYPE>& query_pool,
+                     const uint32_t query = 0,
+                     const vk::QueryControlFlags flags = {}) {
+        assert(query < query_pool->get_query_count());
+        cmd.beginQuery(*query_pool, query, flags);
+        keep_until_pool_reset(query_pool);
+    }
+
+    template <vk::QueryType QUERY_TYPE>
+    void end_query(const QueryPoolHandle<QUERY_TYPE>& query_pool, const uint32_t query = 0) {
+        assert(query < query_pool->get_query_count());
+        cmd.endQuery(*query_pool, query);
+    }
+
     void write_acceleration_structures_properties(
         const QueryPoolHandle<vk::QueryType::eAccelerationStructureCompactedSizeKHR>& query_pool,
         const vk::ArrayProxy<const AccelerationStructureHandle> ass,
@@ -8,7 +8,9 @@
 #include "merian/vk/utils/cpu_queue.hpp"
 
 #include <functional>
+#include <iterator>
 #include <memory>
+#include <stdexcept>
 
 namespace merian {
 
@@ -17,13 +19,18 @@ using SubmissionHandle = std::shared_ptr<Submission>;
 
 // A chain of queue submissions being assembled: commands, wait/signal semaphores and
 // submit-time callbacks. Owns its (caching) command pool.
+//
+// A secondary Submission records into secondary command buffers (e.g. on a worker thread) and
+// cannot submit itself; execute_in() hands its recording, semaphores and callbacks to a primary
+// Submission.
 class Submission {
   public:
     Submission(const ContextHandle& context,
                const QueueHandle& queue,
-               const CPUQueueHandle& cpu_queue)
+               const CPUQueueHandle& cpu_queue,
+               const vk::CommandBufferLevel level = vk::CommandBufferLevel::ePrimary)
         : queue(queue), cpu_queue(cpu_queue),
-          pool(std::make_shared<CachingCommandPool>(CommandPool::create(queue))),
+          pool(std::make_shared<CachingCommandPool>(CommandPool::create(queue))), level(level),
           cpu_sync_semaphore(TimelineSemaphore::create(context)) {}
 
     Submission(const Submission&) = delete;
@@ -41,11 +48,16 @@ class Submission {
 
     const CommandBufferHandle& get_cmd() {
         if (!cmd) {
-            cmd = pool->create_and_begin();
+            cmd = pool->create_and_begin(level, vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+                                         &inheritance_info);
         }
         return cmd;
     }
 
+    bool is_secondary() const noexcept {
+        return level == vk::CommandBufferLevel::eSecondary;
+    }
+
     // ------------------------------------------------------------------------------------
 
     void add_wait_semaphore(const BinarySemaphoreHandle& wait_semaphore,
@@ -88,6 +100,13 @@ class Submission {
         pre_submit_callbacks.push_back(callback);
     }
 
+    // Called once before the next submit while its command buffer is still recording, e.g. to end
+    // a query that must not span command buffers.
+    void add_before_submit_callback(
+        const std::function<void(Submission& submission)>& callback) noexcept {
+        before_submit_callbacks.push_back(callback);
+    }
+
     // ------------------------------------------------------------------------------------
 
     // Queues the callback to be called when the commands recorded until this point have finished
@@ -118,6 +137,15 @@ class Submission {
     // Submits the recording so far with the accumulated semaphores; recording then continues on
     // a fresh command buffer.
     void submit(const vk::Fence& fence = VK_NULL_HANDLE) {
+        if (is_secondary()) {
+            throw std::runtime_error{"a secondary submission cannot be submitted"};
+        }
+        // the callbacks may add callbacks for the following submit
+        std::vector<std::function<void(Submission& submission)>> callbacks;
+        std::swap(callbacks, before_submit_callbacks);
+        for (const auto& callback : callbacks) {
+            callback(*this);
+        }
         get_cmd()->end();
         queue->submit(cmd, fence, signal_semaphores, wait_semaphores, wait_stages,
                       vk::TimelineSemaphoreSubmitInfo{wait_values, signal_values});
@@ -144,11 +172,41 @@ class Submission {
         submit(fence);
     }
 
+    // Secondary only: executes the recording so far in the command buffer of primary and moves
+    // the accumulated semaphores and callbacks there. Recording then continues on a fresh command
+    // buffer. Both must be reset only after the GPU finished the primary's submission.
+    void execute_in(Submission& primary) {
+        assert(is_secondary() && !primary.is_secondary());
+
+        if (cmd) {
+            cmd->end();
+            primary.get_cmd()->execute_commands(cmd);
+            cmd.reset();
+        }
+
+        const auto move_to = [](auto& dst, auto& src) {
+            dst.insert(dst.end(), std::make_move_iterator(src.begin()),
+                       std::make_move_iterator(src.end()));
+            src.clear();
+        };
+        move_to(primary.wait_semaphores, wait_semaphores);
+        move_to(primary.wait_values, wait_values);
+        move_to(primary.wait_stages, wait_stages);
+        move_to(primary.signal_semaphores, signal_semaphores);
+        move_to(primary.signal_values, signal_values);
+        move_to(primary.submit_callbacks, submit_callbacks);
+        move_to(primary.pre_submit_callbacks, pre_submit_callbacks);
+        move_to(primary.before_submit_callbacks, before_submit_callbacks);
+    }
+
   private:
     const QueueHandle queue;
     const CPUQueueHandle cpu_queue;
     const std::shared_ptr<CachingCommandPool> pool;
 
+    const vk::CommandBufferLevel level;
+    // Secondary command buffers are recorded outside of render passes.
+    const vk::CommandBufferInheritanceInfo inheritance_info{};
     CommandBufferHandle cmd = nullptr;
 
     TimelineSemaphoreHandle cpu_sync_semaphore;
@@ -162,6 +220,7 @@ class Submission {
     std::vector<std::function<void(const QueueHandle& queue, Submission& submission)>>
         submit_callbacks;
     std::vector<std::function<void(Submission& submission)>> pre_submit_callbacks;
+    std::vector<std::function<void(Submission& submission)>> before_submit_callbacks;
 };
 
 } // namespace merian
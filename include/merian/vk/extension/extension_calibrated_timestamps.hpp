@@ -0,0 +1,43 @@
+#pragma once
+
+#include "merian/vk/extension/extension.hpp"
+
+#include <chrono>
+#include <optional>
+
+namespace merian {
+
+// A device timestamp and the host time it was taken at.
+struct TimestampCalibration {
+    // in ticks of the device timestamp counter, multiply with timestampPeriod for ns
+    uint64_t device_ticks;
+    std::chrono::steady_clock::time_point host_time;
+    // upper bound of the error of host_time
+    std::chrono::nanoseconds max_deviation;
+};
+
+/**
+ * Enables VK_KHR_calibrated_timestamps, if supported, to relate GPU timestamps (e.g. of the
+ * profiler) to the CPU clock.
+ */
+class ExtensionCalibratedTimestamps : public ContextExtension {
+  public:
+    static constexpr const char* name = "merian-calibrated-timestamps";
+
+    DeviceSupportInfo query_device_support(const DeviceSupportQueryInfo& query_info) override;
+
+    void on_device_created(const DeviceHandle& device,
+                           const ExtensionContainer& extension_container) override;
+
+    // False if the extension or the device time domain is not supported.
+    bool is_available() const;
+
+    // Samples the device timestamp counter, std::nullopt if not available.
+    std::optional<TimestampCalibration> calibrate() const;
+
+  private:
+    DeviceHandle device;
+    bool available = false;
+};
+
+} // namespace merian
@@ -26,9 +26,22 @@ class ExtensionResources : public ContextExtension {
     StagingMemoryManagerHandle staging();
     DescriptorSetAllocatorHandle descriptor_pool();
 
+    // Limits of the staging memory manager (see StagingMemoryManager), applied to the current
+    // manager if it exists and to managers created later. A max_size of 0 means unlimited.
+    void set_staging_limits(const vk::DeviceSize max_size,
+                            const vk::DeviceSize stream_budget = vk::DeviceSize(256) * 1024 * 1024);
+
+    // Block size of staging memory managers created later, e.g. set it in the
+    // configure_extensions_callback of the context.
+    void set_staging_block_size(const vk::DeviceSize block_size);
+
   private:
     WeakContextHandle weak_context;
 
+    vk::DeviceSize staging_block_size = vk::DeviceSize(128) * 1024 * 1024;
+    vk::DeviceSize staging_max_size = 0;
+    vk::DeviceSize staging_stream_budget = vk::DeviceSize(256) * 1024 * 1024;
+
     std::weak_ptr<MemoryAllocator> _memory_allocator;
     std::weak_ptr<ResourceAllocator> _resource_allocator;
     std::weak_ptr<SamplerPool> _sampler_pool;
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "merian/vk/memory/memory_allocator.hpp"
+
+#include <optional>
+#include <spdlog/spdlog.h>
+#include <utility>
+#include <vector>
+
+namespace merian {
+
+class AliasingMemoryAllocator;
+using AliasingMemoryAllocatorHandle = std::shared_ptr<AliasingMemoryAllocator>;
+
+// A placement inside one of the heaps of an AliasingMemoryAllocator. Holds a shared reference to
+// the heap memory, so the heap stays alive as long as any placement does.
+class AliasingMemoryAllocation : public MemoryAllocation {
+  public:
+    AliasingMemoryAllocation() = delete;
+    AliasingMemoryAllocation(const AliasingMemoryAllocation&) = delete;
+    AliasingMemoryAllocation(AliasingMemoryAllocation&&) = delete;
+
+    AliasingMemoryAllocation(const ContextHandle& context,
+                             const AliasingMemoryAllocatorHandle& allocator,
+                             const MemoryAllocationHandle& heap,
+                             const vk::DeviceSize offset,
+                             const vk::DeviceSize size);
+
+    ~AliasingMemoryAllocation() override;
+
+    MemoryAllocationInfo get_memory_info() const override;
+
+    void bind_to_image(const ImageHandle& image,
+                       const vk::DeviceSize allocation_offset = 0ul) override;
+
+    void bind_to_buffer(const BufferHandle& buffer,
+                        const vk::DeviceSize allocation_offset = 0ul) override;
+
+    MemoryAllocatorHandle get_allocator() const override;
+
+    const vk::DeviceSize& get_size() const;
+
+    // offset into the heap allocation
+    const vk::DeviceSize& get_offset() const;
+
+    void properties(Properties& props) override;
+
+  private:
+    friend class AliasingMemoryAllocator;
+
+    const AliasingMemoryAllocatorHandle allocator;
+    const MemoryAllocationHandle heap;
+    const vk::DeviceSize offset;
+    const vk::DeviceSize size;
+
+    std::string name;
+};
+
+// Places allocations into shared memory heaps such that allocations whose lifetimes do not
+// overlap may share the same memory (transient resources of a render graph).
+//
+// A lifetime is an inclusive interval of abstract time steps (e.g. dependency layers). Set it
+// with set_lifetime() before each allocation; the placement is a first-fit over all heaps that
+// avoids every earlier placement with an overlapping lifetime. Without a lifetime, or for
+// mappable memory, the request is forwarded to the backing allocator unchanged.
+//
+// The caller is responsible for synchronization between the last access of one resource and the
+// first access of a resource that aliases it, and must not assume any memory contents.
+class AliasingMemoryAllocator : public MemoryAllocator {
+  public:
+    // Inclusive interval [first, last].
+    struct Lifetime {
+        uint32_t first;
+        uint32_t last;
+
+        bool overlaps(const Lifetime& other) const {
+            return first <= other.last && other.first <= last;
+        }
+    };
+
+  private:
+    AliasingMemoryAllocator(const MemoryAllocatorHandle& backing_allocator,
+                            const vk::DeviceSize min_heap_size);
+
+  public:
+    AliasingMemoryAllocator() = delete;
+
+    ~AliasingMemoryAllocator() override;
+
+    MemoryAllocationHandle
+    allocate_memory(const vk::MemoryPropertyFlags required_flags,
+                    const vk::MemoryRequirements& requirements,
+                    const std::string& debug_name = {},
+                    const MemoryMappingType mapping_type = MemoryMappingType::NONE,
+                    const vk::MemoryPropertyFlags preferred_flags = {},
+                    const bool dedicated = false,
+                    const float dedicated_priority = 1.0) override;
+
+    // The lifetime for the following allocations. std::nullopt forwards to the backing allocator.
+    // The owner is a caller-defined tag for the placements, see get_aliasing_owners().
+    void set_lifetime(const std::optional<Lifetime>& lifetime, const uint32_t owner = 0);
+
+    // Forgets all heaps and placements. The heap memory is freed when the last allocation that was
+    // placed into it is released.
+    void reset();
+
+    // Sum of all sizes that were placed since the last reset.
+    vk::DeviceSize get_requested_size() const;
+
+    // Sum of the sizes of all heaps that were allocated since the last reset.
+    vk::DeviceSize get_heap_size() const;
+
+    uint32_t get_heap_count() const;
+
+    uint32_t get_placement_count() const;
+
+    // Pairs (earlier, later) of distinct owners that have placements sharing memory, where the
+    // lifetime of earlier ends before the lifetime of later starts. The caller must order all
+    // accesses of earlier before the first access of later.
+    std::vector<std::pair<uint32_t, uint32_t>> get_aliasing_owners() const;
+
+  private:
+    struct Placement {
+        vk::DeviceSize offset;
+        vk::DeviceSize size;
+        Lifetime lifetime;
+        uint32_t owner;
+    };
+
+    struct Heap {
+        MemoryAllocationHandle memory;
+        vk::DeviceSize size;
+        // offset of the heap in its VkDeviceMemory, placements are aligned relative to it.
+        vk::DeviceSize memory_offset;
+        uint32_t memory_type_index;
+        vk::MemoryPropertyFlags memory_flags;
+        std::vector<Placement> placements;
+    };
+
+    // Returns the offset of the lowest gap in heap that fits, or std::nullopt.
+    std::optional<vk::DeviceSize> find_gap(const Heap& heap,
+                                           const vk::DeviceSize size,
+                                           const vk::DeviceSize alignment,
+                                           const Lifetime& lifetime) const;
+
+    const MemoryAllocatorHandle backing_allocator;
+    const vk::DeviceSize min_heap_size;
+    // Linear and optimal resources that alias or neighbor each other must respect this.
+    const vk::DeviceSize granularity;
+
+    std::optional<Lifetime> current_lifetime;
+    uint32_t current_owner = 0;
+    std::vector<Heap> heaps;
+    vk::DeviceSize requested_size = 0;
+
+  public:
+    static AliasingMemoryAllocatorHandle create(const MemoryAllocatorHandle& backing_allocator,
+                                                const vk::DeviceSize min_heap_size = 32ul << 20);
+};
+
+} // namespace merian
@@ -96,6 +96,9 @@ class BumpMemoryAllocator : public MemoryAllocator {
     // when the remaining capacity is insufficient.
     vk::DeviceSize allocate(const vk::MemoryRequirements& requirements);
 
+    // True if allocate() with the requirements would currently succeed.
+    bool fits(const vk::MemoryRequirements& requirements) const;
+
     // Resets the bump pointer to 0. Caller must ensure no in-flight reads of any prior
     // suballocation exist (e.g. only call after a fence/queue wait or when a parent
     // command buffer keeps the underlying buffer alive across the reuse).
@@ -109,6 +112,10 @@ class BumpMemoryAllocator : public MemoryAllocator {
     vk::DeviceSize get_free_size() const;
 
   private:
+    // Aligns offset so that the device address satisfies alignment.
+    vk::DeviceSize align_offset(const vk::DeviceSize offset,
+                                const vk::MemoryRequirements& requirements) const;
+
     const BufferHandle buffer;
     const MemoryAllocationInfo buffer_info;
     vk::MemoryPropertyFlags buffer_flags;
@@ -2,6 +2,7 @@
 
 #include "merian/utils/string.hpp"
 #include "merian/vk/context.hpp"
+#include "merian/vk/memory/memory_statistics.hpp"
 #include "merian/vk/memory/resource_allocations.hpp"
 
 #include <memory>
@@ -130,6 +131,17 @@ class MemoryAllocator : public std::enable_shared_from_this<MemoryAllocator> {
 
     // ------------------------------------------------------------------------------------
 
+    // Live memory of this allocator by owner (see MemoryOwnerScope) and debug name, and the
+    // budget of each memory heap. std::nullopt if the allocator does not track its allocations.
+    virtual std::optional<MemoryStatistics::Report> get_memory_statistics() {
+        return std::nullopt;
+    }
+
+    // Restarts the high-water marks of get_memory_statistics().
+    virtual void reset_memory_statistics_peaks() {}
+
+    // ------------------------------------------------------------------------------------
+
   public:
     const ContextHandle& get_context() {
         return context;
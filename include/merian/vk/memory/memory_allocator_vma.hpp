@@ -25,8 +25,10 @@ class VMAMemoryAllocation : public MemoryAllocation {
     VMAMemoryAllocation(const ContextHandle& context,
                         const std::shared_ptr<VMAMemoryAllocator>& allocator,
                         VmaAllocation allocation,
+                        MemoryStatistics::Allocation statistics_allocation,
                         void* persistent_mapped = nullptr)
         : MemoryAllocation(context), allocator(allocator), m_allocation(allocation),
+          statistics_allocation(std::move(statistics_allocation)),
           mapped_memory(persistent_mapped) {
         SPDLOG_TRACE("create VMA allocation ({})", fmt::ptr(this));
     }
@@ -80,6 +82,7 @@ class VMAMemoryAllocation : public MemoryAllocation {
   private:
     const std::shared_ptr<VMAMemoryAllocator> allocator;
     VmaAllocation m_allocation;
+    const MemoryStatistics::Allocation statistics_allocation;
 
     mutable std::mutex allocation_mutex;
     void* const mapped_memory;
@@ -122,8 +125,22 @@ class VMAMemoryAllocator : public MemoryAllocator {
 
     // ------------------------------------------------------------------------------------
 
+    // Heap budgets are exact if VK_EXT_memory_budget is enabled (see ExtensionVMA), else
+    // estimated by VMA.
+    std::optional<MemoryStatistics::Report> get_memory_statistics() override;
+
+    void reset_memory_statistics_peaks() override;
+
+    // ------------------------------------------------------------------------------------
+
   private:
+    // Creates the allocation handle and tracks it in the statistics.
+    std::shared_ptr<VMAMemoryAllocation> make_allocation(const VmaAllocation allocation,
+                                                         const VmaAllocationInfo& allocation_info,
+                                                         const std::string& debug_name);
+
     VmaAllocator vma_allocator;
+    MemoryStatistics statistics;
 
   public:
     static std::shared_ptr<VMAMemoryAllocator> create(const ContextHandle& context);
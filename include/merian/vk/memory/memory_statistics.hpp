@@ -0,0 +1,113 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace merian {
+
+/**
+ * Attributes the memory that is allocated on the calling thread while the scope is alive to
+ * `owner` (e.g. a graph node, the Scene or the staging manager) in the MemoryStatistics of the
+ * allocator. Scopes nest, the innermost owner wins.
+ *
+ * The owner string must outlive the scope.
+ */
+class [[nodiscard]] MemoryOwnerScope {
+  public:
+    explicit MemoryOwnerScope(const std::string_view owner);
+    ~MemoryOwnerScope();
+
+    MemoryOwnerScope(const MemoryOwnerScope&) = delete;
+    MemoryOwnerScope& operator=(const MemoryOwnerScope&) = delete;
+    MemoryOwnerScope(MemoryOwnerScope&&) = delete;
+    MemoryOwnerScope& operator=(MemoryOwnerScope&&) = delete;
+
+    // The innermost owner of the calling thread, empty if there is no scope.
+    static std::string_view current();
+};
+
+/**
+ * Live allocations of a memory allocator grouped by owner (see MemoryOwnerScope) and by debug
+ * name, per-heap usage and budget, and high-water marks of each. Thread-safe.
+ */
+class MemoryStatistics {
+  public:
+    struct Usage {
+        uint64_t bytes = 0;
+        uint64_t allocations = 0;
+        // high-water mark of bytes since creation or reset_peaks()
+        uint64_t peak_bytes = 0;
+    };
+
+    // Provided by the allocator, e.g. from VK_EXT_memory_budget.
+    struct HeapBudget {
+        uint64_t size = 0;
+        bool device_local = false;
+        // what the process can allocate from the heap without degrading performance
+        uint64_t budget = 0;
+        // allocated by the process (including other allocators), might be an estimate
+        uint64_t usage = 0;
+    };
+
+    struct Heap {
+        HeapBudget budget;
+        // high-water mark of budget.usage, sampled by get_report()
+        uint64_t peak_usage = 0;
+        // allocated through this allocator
+        Usage tracked;
+    };
+
+    struct Report {
+        std::vector<Heap> heaps;
+        std::map<std::string, Usage> by_owner;
+        std::map<std::string, Usage> by_name;
+        Usage total;
+    };
+
+    // A tracked allocation, pass to remove() when it is freed.
+    struct Allocation {
+        std::string owner;
+        std::string name;
+        uint64_t size = 0;
+        uint32_t heap_index = 0;
+    };
+
+    // Used for allocations without MemoryOwnerScope or debug name.
+    static constexpr std::string_view UNKNOWN_OWNER = "<unknown>";
+    static constexpr std::string_view UNNAMED = "<unnamed>";
+
+    explicit MemoryStatistics(const uint32_t heap_count);
+
+    // Tracks an allocation for the current owner (see MemoryOwnerScope).
+    Allocation add(const std::string_view name, const uint64_t size, const uint32_t heap_index);
+
+    void remove(const Allocation& allocation);
+
+    // Pass the current budget of each heap. Owners and names without live allocations are kept
+    // for their high-water mark until reset_peaks().
+    Report get_report(const std::vector<HeapBudget>& budgets);
+
+    // Resets high-water marks to the current values and forgets owners and names without live
+    // allocations.
+    void reset_peaks();
+
+    // The report as JSON, sizes in bytes.
+    static nlohmann::json to_json(const Report& report);
+
+  private:
+    std::mutex mutex;
+
+    std::map<std::string, Usage, std::less<>> by_owner;
+    std::map<std::string, Usage, std::less<>> by_name;
+    std::vector<Usage> heaps;
+    std::vector<uint64_t> heap_peak_usage;
+    Usage total;
+};
+
+} // namespace merian
@@ -3,12 +3,14 @@
 #include "merian/vk/extension/extension_vk_debug_utils.hpp"
 #include "merian/vk/memory/memory_allocator.hpp"
 #include "merian/vk/memory/resource_allocations.hpp"
+#include "merian/vk/memory/resource_pool.hpp"
 #include "merian/vk/memory/staging_memory_manager.hpp"
 #include "merian/vk/sampler/sampler_pool.hpp"
 
 #include <filesystem>
 #include <memory>
 #include <optional>
+#include <vector>
 #include <vulkan/vulkan.hpp>
 
 namespace merian {
@@ -43,6 +45,18 @@ class ResourceAllocator : public std::enable_shared_from_this<ResourceAllocator>
         return m_memAlloc;
     }
 
+    // Buffers and images that are requested with exclusive sharing are created with concurrent
+    // sharing between these queue families instead, so that they can be used on queues of
+    // different families without ownership transfers. Needs at least two distinct families, an
+    // empty vector restores exclusive sharing. Affects only resources created afterwards.
+    void set_concurrent_sharing(const std::vector<uint32_t>& queue_family_indices);
+
+    // Buffers and images created with create_buffer(info, ...) and create_image(info, ...) are
+    // taken from and tracked by the pool. nullptr disables pooling.
+    void set_resource_pool(const ResourcePoolHandle& resource_pool);
+
+    const ResourcePoolHandle& get_resource_pool() const;
+
     //--------------------------------------------------------------------------------------------------
 
     // Basic buffer creation
@@ -302,6 +316,11 @@ class ResourceAllocator : public std::enable_shared_from_this<ResourceAllocator>
     const DescriptorSetAllocatorHandle descriptor_pool;
     const std::shared_ptr<ExtensionVkDebugUtils> debug_utils;
 
+    // see set_concurrent_sharing()
+    std::vector<uint32_t> concurrent_queue_families;
+    // see set_resource_pool()
+    ResourcePoolHandle resource_pool;
+
     ImageViewHandle dummy_storage_image_view;
     TextureHandle dummy_texture;
     BufferHandle dummy_buffer;
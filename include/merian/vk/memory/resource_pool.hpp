@@ -0,0 +1,128 @@
+#pragma once
+
+#include "merian/vk/memory/memory_allocator.hpp"
+#include "merian/vk/memory/resource_allocations.hpp"
+
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <vector>
+
+namespace merian {
+
+class ResourcePool;
+using ResourcePoolHandle = std::shared_ptr<ResourcePool>;
+
+/**
+ * Retains released buffers and images to hand them out again for identical create infos, memory
+ * mapping and alignment. Used by ResourceAllocator::set_resource_pool(), e.g. to keep the
+ * resources of a graph across reconnects.
+ *
+ * Resources that are created through the pool are tracked. release_unused() moves the tracked
+ * resources that are not referenced anymore to the pool. Call age() once per reuse cycle (e.g. a
+ * graph reconnect), pooled resources that were not reused for max_age calls are destroyed.
+ *
+ * The caller must ensure that the GPU finished using a resource before calling release_unused().
+ * Reused images are in undefined layout, the contents of reused resources are undefined.
+ */
+class ResourcePool {
+  public:
+    ResourcePool(const uint32_t max_age = 2);
+
+    // Returns a pooled buffer for the create info or nullptr. Create infos with pNext are never
+    // pooled.
+    BufferHandle acquire(const vk::BufferCreateInfo& create_info,
+                         const MemoryMappingType mapping_type,
+                         const std::optional<vk::DeviceSize> min_alignment);
+
+    // Returns a pooled image for the create info or nullptr. Create infos with pNext are never
+    // pooled.
+    ImageHandle acquire(const vk::ImageCreateInfo& create_info,
+                        const MemoryMappingType mapping_type);
+
+    // Retain the buffer when it is released.
+    void track(const BufferHandle& buffer,
+               const vk::BufferCreateInfo& create_info,
+               const MemoryMappingType mapping_type,
+               const std::optional<vk::DeviceSize> min_alignment);
+
+    // Retain the image when it is released.
+    void track(const ImageHandle& image,
+               const vk::ImageCreateInfo& create_info,
+               const MemoryMappingType mapping_type);
+
+    // Pools the tracked resources that are only referenced by the pool.
+    void release_unused();
+
+    // Ages the pooled resources and destroys the ones that were not reused for max_age calls.
+    void age();
+
+    // Destroys all pooled resources.
+    void clear();
+
+    // -----------------------------------------------------------
+
+    uint32_t get_max_age() const;
+
+    void set_max_age(const uint32_t max_age);
+
+    // Number and memory of the resources that are currently pooled.
+    std::size_t get_pooled_count() const;
+    vk::DeviceSize get_pooled_size() const;
+
+    // Number of acquire() calls that returned a resource / nullptr since creation.
+    uint64_t get_hits() const;
+    uint64_t get_misses() const;
+
+  private:
+    // flags, size, usage, sharing mode, queue families, mapping type, min alignment
+    using BufferKey = std::tuple<VkBufferCreateFlags,
+                                 VkDeviceSize,
+                                 VkBufferUsageFlags,
+                                 VkSharingMode,
+                                 std::vector<uint32_t>,
+                                 MemoryMappingType,
+                                 VkDeviceSize>;
+    // flags, type, format, extent, mips, layers, samples, tiling, usage, sharing mode, queue
+    // families, mapping type
+    using ImageKey = std::tuple<VkImageCreateFlags,
+                                VkImageType,
+                                VkFormat,
+                                std::tuple<uint32_t, uint32_t, uint32_t>,
+                                uint32_t,
+                                uint32_t,
+                                VkSampleCountFlagBits,
+                                VkImageTiling,
+                                VkImageUsageFlags,
+                                VkSharingMode,
+                                std::vector<uint32_t>,
+                                MemoryMappingType>;
+
+    template <class Key, class Handle> struct Entry {
+        Key key;
+        Handle resource;
+        // calls to age() since the resource was pooled
+        uint32_t age = 0;
+    };
+
+    static BufferKey make_key(const vk::BufferCreateInfo& create_info,
+                              const MemoryMappingType mapping_type,
+                              const std::optional<vk::DeviceSize> min_alignment);
+
+    static ImageKey make_key(const vk::ImageCreateInfo& create_info,
+                             const MemoryMappingType mapping_type);
+
+    mutable std::mutex mutex;
+    uint32_t max_age;
+
+    std::vector<Entry<BufferKey, BufferHandle>> tracked_buffers;
+    std::vector<Entry<ImageKey, ImageHandle>> tracked_images;
+    std::vector<Entry<BufferKey, BufferHandle>> pooled_buffers;
+    std::vector<Entry<ImageKey, ImageHandle>> pooled_images;
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+} // namespace merian
@@ -4,25 +4,57 @@
 
 #include "merian/vk/command/command_buffer.hpp"
 #include "merian/vk/memory/bump_memory_allocator.hpp"
+#include "merian/vk/sync/semaphore_timeline.hpp"
 #include "merian/vk/utils/math.hpp"
 
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
+#include <span>
+#include <mutex>
+
 namespace merian {
 
+class Submission;
+
+/**
+ * Suballocates staging memory for uploads and downloads from host-visible blocks.
+ *
+ * Full blocks are kept in a ring and reused once the GPU finished with them. For that, call
+ * retire_on() with the submission that executes the recorded copies (or a later one on the same
+ * queue). Without retire_on() full blocks are released when their last allocation is destroyed.
+ *
+ * Set max_size to limit the memory of all blocks. When a new block would exceed the limit,
+ * the manager waits for the GPU to release the oldest block instead (back-pressure). Independent
+ * of the limit, released blocks exceeding keep_idle_blocks per direction are freed.
+ *
+ * The cmd_to_device() overloads that copy from host data split uploads larger than a block into
+ * block-sized chunks. The overloads that take a Submission additionally submit every chunk, so
+ * that the next chunk is filled while the previous ones are copied, with at most stream_budget
+ * bytes in flight.
+ */
 class StagingMemoryManager : public std::enable_shared_from_this<StagingMemoryManager> {
 
   public:
     // The buffer-buffer copy from or to the staging area, depending on up or download.
+    // Keep the struct (memory) alive until the copy is recorded with cmd_copy(), the staging block
+    // is not reused before.
     struct DeviceBufferCopy {
         BufferHandle src;
         BufferHandle dst;
         vk::BufferCopy region;
+        MemoryAllocationHandle memory;
     };
 
     // The buffer-image copy from or to the staging area, depending on up or download.
+    // Keep the struct (memory) alive until the copy is recorded with cmd_copy(), the staging block
+    // is not reused before.
     struct DeviceImageCopy {
         BufferHandle src;
         ImageHandle dst;
         vk::BufferImageCopy region;
+        MemoryAllocationHandle memory;
     };
 
     // Prepared image-to-buffer download.
@@ -41,9 +73,42 @@ class StagingMemoryManager : public std::enable_shared_from_this<StagingMemoryMa
         MemoryAllocationHandle memory;
     };
 
+    // Mapped staging memory of a finished download (see cmd_readback). The staging memory is not
+    // reused while the readback is alive, keep the handle to access the data later.
+    class Readback {
+      public:
+        Readback(const MemoryAllocationHandle& memory, const vk::DeviceSize size);
+        ~Readback();
+
+        Readback(const Readback&) = delete;
+        Readback& operator=(const Readback&) = delete;
+
+        const void* get_data() const {
+            return data;
+        }
+
+        vk::DeviceSize get_size() const {
+            return size;
+        }
+
+        template <class T> std::span<const T> as() const {
+            return {static_cast<const T*>(data), size / sizeof(T)};
+        }
+
+      private:
+        const MemoryAllocationHandle memory;
+        const vk::DeviceSize size;
+        const void* data;
+    };
+    using ReadbackHandle = std::shared_ptr<Readback>;
+    using ReadbackCallback = std::function<void(const ReadbackHandle& readback)>;
+
     // use vkCmdUpdateBuffer for sizes smaller than that
     static const vk::DeviceSize CMD_UPDATE_BUFFER_THRESHOLD = 65536;
 
+    // owner of the staging memory in the MemoryStatistics of the allocator
+    static constexpr std::string_view MEMORY_OWNER = "staging";
+
     StagingMemoryManager(StagingMemoryManager const&) = delete;
     StagingMemoryManager& operator=(StagingMemoryManager const&) = delete;
     StagingMemoryManager() = delete;
@@ -51,13 +116,21 @@ class StagingMemoryManager : public std::enable_shared_from_this<StagingMemoryMa
         const MemoryAllocatorHandle& memory_allocator,
         const vk::DeviceSize block_size = vk::DeviceSize(128) * 1024 * 1024,
         const vk::BufferUsageFlags upload_usage = vk::BufferUsageFlagBits::eTransferSrc,
-        const vk::BufferUsageFlags download_usage = vk::BufferUsageFlagBits::eTransferDst);
+        const vk::BufferUsageFlags download_usage = vk::BufferUsageFlagBits::eTransferDst,
+        const vk::DeviceSize max_size = 0,
+        const vk::DeviceSize stream_budget = vk::DeviceSize(256) * 1024 * 1024);
 
     ~StagingMemoryManager();
 
     // -------------------------------------------------------------------------
 
   public:
+    // Signals the staging timeline with the submission. The blocks used for staging until now
+    // can be reused once the submission finished executing. Call before the submission is
+    // submitted and in submission order, all copies from and to staging memory must be submitted
+    // before or with it on the same queue.
+    void retire_on(Submission& submission);
+
     // Request a staging area of size 'size' for uploads. The buffer and offset are returned to
     // queue the device copy on the command buffer.
     MemoryAllocationHandle
@@ -73,7 +146,7 @@ class StagingMemoryManager : public std::enable_shared_from_this<StagingMemoryMa
 
     // -------------------------------------------------------------------------
 
-    /* Stage data and return the copy; caller records it and handles layout. */
+    /* Stage data and return the copy; caller records it with cmd_copy() and handles layout. */
     DeviceImageCopy to_device(const ImageHandle& image,
                               const void* data,
                               const vk::ImageSubresourceLayers& subresource = first_layer(),
@@ -109,6 +182,16 @@ class StagingMemoryManager : public std::enable_shared_from_this<StagingMemoryMa
         cmd_to_device(cmd, image, data.data(), subresource, offset, optional_extent);
     }
 
+    /* Like cmd_to_device(cmd, image, ...) but uploads larger than the block size are streamed:
+     * Each chunk is submitted with the recording so far, afterwards recording continues on a fresh
+     * command buffer of the submission. Queries must not be active on the command buffer. */
+    void cmd_to_device(Submission& submission,
+                       const ImageHandle& image,
+                       const void* data,
+                       const vk::ImageSubresourceLayers& subresource = first_layer(),
+                       const vk::Offset3D offset = {},
+                       const std::optional<vk::Extent3D> optional_extent = std::nullopt);
+
     /* Prepare a download; caller records copy.src/copy.dst/copy.region. */
     DeviceImageDownload
     from_device(const ImageHandle& image,
@@ -126,8 +209,8 @@ class StagingMemoryManager : public std::enable_shared_from_this<StagingMemoryMa
 
     // -------------------------------------------------------------------------
 
-    /* Stages the data and return the pending copy for you to record. Use cmd_to_device for a
-     * vkCmdUpdateBuffer fast path on small sizes. */
+    /* Stages the data and return the pending copy for you to record with cmd_copy(). Use
+     * cmd_to_device for a vkCmdUpdateBuffer fast path on small sizes. */
     DeviceBufferCopy to_device(const BufferHandle& buffer,
                                const void* data,
                                const vk::DeviceSize offset = 0ul,
@@ -141,6 +224,15 @@ class StagingMemoryManager : public std::enable_shared_from_this<StagingMemoryMa
                        const vk::DeviceSize offset = 0ul,
                        const std::optional<vk::DeviceSize> optional_size = std::nullopt);
 
+    /* Like cmd_to_device(cmd, buffer, ...) but uploads larger than the block size are streamed:
+     * Each chunk is submitted with the recording so far, afterwards recording continues on a fresh
+     * command buffer of the submission. Queries must not be active on the command buffer. */
+    void cmd_to_device(Submission& submission,
+                       const BufferHandle& buffer,
+                       const void* data,
+                       const vk::DeviceSize offset = 0ul,
+                       const std::optional<vk::DeviceSize> optional_size = std::nullopt);
+
     /* Returns a staging allocation; the caller fills it via map()/unmap(). The copy to buffer is
      * already queued in cmd. Size defaults to buffer->get_size() - offset. */
     MemoryAllocationHandle
@@ -178,22 +270,189 @@ class StagingMemoryManager : public std::enable_shared_from_this<StagingMemoryMa
 
     // -------------------------------------------------------------------------
 
+    /* Records an upload returned by to_device(). The staging memory is kept until the next
+     * retire_on() finished, even if the copy was staged before an earlier retire_on(). */
+    void cmd_copy(const CommandBufferHandle& cmd, const DeviceImageCopy& copy);
+
+    /* Records an upload returned by to_device(). The staging memory is kept until the next
+     * retire_on() finished, even if the copy was staged before an earlier retire_on(). */
+    void cmd_copy(const CommandBufferHandle& cmd, const DeviceBufferCopy& copy);
+
+    // -------------------------------------------------------------------------
+
+    /* Records the download of the buffer range into the submission and calls callback on a
+     * thread of the CPUQueue once the GPU finished the copy (see Submission::sync_to_cpu). The
+     * buffer must be available for transfer reads. Size defaults to buffer->get_size() - offset.
+     */
+    void cmd_readback(Submission& submission,
+                      const BufferHandle& buffer,
+                      const ReadbackCallback& callback,
+                      const vk::DeviceSize offset = 0,
+                      const std::optional<vk::DeviceSize> optional_size = std::nullopt);
+
+    /* The image must be in a layout that is valid for transfer reads. The data is tightly packed.
+     * Extent defaults to image->get_extent() - offset. */
+    void cmd_readback(Submission& submission,
+                      const ImageHandle& image,
+                      const ReadbackCallback& callback,
+                      const vk::ImageSubresourceLayers& subresource = first_layer(),
+                      const vk::Offset3D offset = {},
+                      const std::optional<vk::Extent3D> optional_extent = std::nullopt);
+
+    /* Like cmd_readback with callback, the future is fulfilled instead. */
+    std::future<ReadbackHandle>
+    cmd_readback(Submission& submission,
+                 const BufferHandle& buffer,
+                 const vk::DeviceSize offset = 0,
+                 const std::optional<vk::DeviceSize> optional_size = std::nullopt);
+
+    /* Like cmd_readback with callback, the future is fulfilled instead. */
+    std::future<ReadbackHandle>
+    cmd_readback(Submission& submission,
+                 const ImageHandle& image,
+                 const vk::ImageSubresourceLayers& subresource = first_layer(),
+                 const vk::Offset3D offset = {},
+                 const std::optional<vk::Extent3D> optional_extent = std::nullopt);
+
+    // -------------------------------------------------------------------------
+
+    // Total bytes staged for uploads (including vkCmdUpdateBuffer) since creation. Take the
+    // difference of two calls to attribute traffic to a section of code.
+    uint64_t get_uploaded_bytes() const;
+
+    // Total bytes of staging space requested for downloads since creation.
+    uint64_t get_downloaded_bytes() const;
+
+    // Allocations up to this size are suballocated from blocks.
+    vk::DeviceSize get_block_size() const;
+
+    // Memory of all upload and download blocks that are currently allocated.
+    vk::DeviceSize get_allocated_size() const;
+
+    // 0 means unlimited. Individual allocations larger than the block size do not count.
+    vk::DeviceSize get_max_size() const;
+
+    void set_max_size(const vk::DeviceSize max_size);
+
+    // Max bytes of a streamed upload that are submitted but not yet copied.
+    vk::DeviceSize get_stream_budget() const;
+
+    void set_stream_budget(const vk::DeviceSize stream_budget);
+
+    // Released blocks that are kept for reuse per direction, further idle blocks are freed.
+    uint32_t get_keep_idle_blocks() const;
+
+    void set_keep_idle_blocks(const uint32_t keep_idle_blocks);
+
+    // Number of times the manager had to wait for the GPU to release a block or a streamed
+    // chunk.
+    uint64_t get_stall_count() const;
+
+    // Number of staging allocations that did not fit into a block and got an individual buffer.
+    uint64_t get_individual_count() const;
+
+    // -------------------------------------------------------------------------
+
   private:
+    struct Block {
+        BumpMemoryAllocatorHandle allocator;
+        // the epoch of the last retire_on() that covers all uses of the block
+        uint64_t last_use = 0;
+    };
+
+    struct Ring {
+        Block current;
+        // full blocks, oldest first
+        std::deque<Block> retired;
+    };
+
     const ContextHandle context;
     const MemoryAllocatorHandle allocator;
     const vk::DeviceSize block_size;
+    std::atomic<vk::DeviceSize> max_size;
+    std::atomic<vk::DeviceSize> stream_budget;
+    std::atomic_uint32_t keep_idle_blocks{2};
     vk::BufferUsageFlags upload_usage;
     vk::BufferUsageFlags download_usage;
 
     static constexpr vk::DeviceSize STAGING_ALIGNMENT = 16;
 
-    BumpMemoryAllocatorHandle upload_block;
-    BumpMemoryAllocatorHandle download_block;
+    mutable std::mutex mutex;
+    Ring upload_ring;
+    Ring download_ring;
+
+    // Signaled with epoch by retire_on(). Epochs are only used once retire_on() was called,
+    // before that full blocks are dropped.
+    const TimelineSemaphoreHandle timeline;
+    uint64_t epoch = 1;
+    // the last epoch that was actually submitted
+    std::atomic_uint64_t submitted_epoch{0};
+    vk::DeviceSize allocated_size = 0;
 
-    void create_upload_block();
-    void create_download_block();
+    std::atomic_uint64_t uploaded_bytes{0};
+    std::atomic_uint64_t downloaded_bytes{0};
+    std::atomic_uint64_t stall_count{0};
+    std::atomic_uint64_t individual_count{0};
+
+    BufferHandle create_block_buffer(const bool upload);
+
+    // Makes a block with at least size free bytes current. Reuses a retired block if the GPU
+    // released one, else creates a new block or waits if that would exceed max_size.
+    void next_block(Ring& ring, const bool upload);
+
+    // Moves the last use of the block that holds memory to the current epoch.
+    void pin(const MemoryAllocationHandle& memory);
+
+    // Frees the oldest released blocks of the ring that exceed keep_idle_blocks.
+    void trim_idle(Ring& ring);
+
+    // Returns the ring's oldest released block, or nullptr.
+    BumpMemoryAllocatorHandle take_released(Ring& ring, const bool wait);
+
+    // The submitted chunks of a streamed upload.
+    struct Stream {
+        // (epoch, bytes), oldest first
+        std::deque<std::pair<uint64_t, vk::DeviceSize>> in_flight;
+        vk::DeviceSize in_flight_bytes = 0;
+    };
 
-    MemoryAllocationHandle suballocate(BumpMemoryAllocatorHandle& block,
+    // Copies size bytes from data to staging memory and calls record with the command buffer
+    // and the staging buffer and offset. With a submission the chunk is submitted afterwards.
+    void stream_chunk(const CommandBufferHandle& cmd,
+                      Submission* submission,
+                      Stream& stream,
+                      const void* data,
+                      const vk::DeviceSize size,
+                      const std::function<void(const CommandBufferHandle& cmd,
+                                               const BufferHandle& staging_buffer,
+                                               const vk::DeviceSize staging_offset)>& record);
+
+    void stream_to_device(const CommandBufferHandle& cmd,
+                          Submission* submission,
+                          const BufferHandle& buffer,
+                          const void* data,
+                          const vk::DeviceSize offset,
+                          const vk::DeviceSize size);
+
+    void stream_to_device(const CommandBufferHandle& cmd,
+                          Submission* submission,
+                          const ImageHandle& image,
+                          const void* data,
+                          const vk::ImageSubresourceLayers& subresource,
+                          const vk::Offset3D offset,
+                          const vk::Extent3D extent);
+
+    // Makes the download visible to the host and calls callback once the submission finished.
+    void sync_readback(Submission& submission,
+                       const BufferHandle& staging_buffer,
+                       const MemoryAllocationHandle& memory,
+                       const vk::DeviceSize size,
+                       const ReadbackCallback& callback);
+
+    // Signals the next epoch with the submission, returns the epoch.
+    uint64_t signal_epoch(Submission& submission);
+
+    MemoryAllocationHandle suballocate(Block& block,
                                        vk::DeviceSize size,
                                        BufferHandle& buffer,
                                        vk::DeviceSize& buffer_offset);
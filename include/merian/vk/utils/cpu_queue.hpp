@@ -1,8 +1,10 @@
 #pragma once
 
+#include "merian/utils/concurrent/ring_queue.hpp"
 #include "merian/utils/concurrent/thread_pool.hpp"
 #include "merian/vk/sync/semaphore_timeline.hpp"
 
+#include <atomic>
 #include <barrier>
 #include <queue>
 
@@ -42,6 +44,9 @@ class CPUQueue {
     void wait_idle();
 
   private:
+    // submits beyond that go through the overflow queue
+    static constexpr std::size_t PENDING_QUEUE_CAPACITY = 1024;
+
     const ContextHandle context;
     const ThreadPoolHandle thread_pool;
     const TimelineSemaphoreHandle interrupt_semaphore;
@@ -52,9 +57,20 @@ class CPUQueue {
         std::function<void()> callback;
     };
 
-    // written by main thread, read by dispatcher thread
-    std::queue<PendingItem> pending;
+    void enqueue(PendingItem&& item);
+
+    // signals the interrupt semaphore, mtx must be held
+    void interrupt();
+
+    // written by any thread, read by dispatcher thread
+    MPMCRingQueue<PendingItem> pending{PENDING_QUEUE_CAPACITY};
+    // protected by mtx
+    std::queue<PendingItem> pending_overflow;
+    // protected by mtx
     uint64_t interrupt_value = 1;
+    // set by the dispatcher before it collects pending items. Submits only interrupt the
+    // dispatcher if it is set, i.e. at most once per dispatcher iteration instead of per submit.
+    std::atomic_bool interrupt_armed{true};
 
     // always conteins interrupt semaphore at position 0
     std::vector<TimelineSemaphoreHandle> waiting_semaphores;
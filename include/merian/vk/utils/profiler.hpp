@@ -1,11 +1,17 @@
 #pragma once
 
+#include "merian/utils/concurrent/ring_queue.hpp"
 #include "merian/utils/properties.hpp"
+#include "merian/utils/statistics.hpp"
 #include "merian/utils/stopwatch.hpp"
 #include "merian/vk/utils/query_pool.hpp"
 
 #include <limits>
+#include <map>
+#include <mutex>
 #include <optional>
+#include <string_view>
+#include <thread>
 
 namespace merian {
 
@@ -35,6 +41,23 @@ class ProfileScopeGPU;
  *     queue.submit(... fence);
  * }
  *
+ * CPU sections can be recorded from any thread (e.g. tasks of a ThreadPool or CPUQueue). The thread
+ * that created the profiler records directly, other threads record into a lock-free per-thread
+ * buffer that is merged on collect() and get_report(). The top-level sections of other threads
+ * are nested into the section passed as parent (see get_current_section()) or into the root.
+ * GPU sections, counters and reports are only supported on the creating thread.
+ *
+ * Intern section names that are not string literals once (intern()) and pass the SectionName, so
+ * that no string has to be formatted or hashed per capture.
+ *
+ * GPU sections can additionally capture pipeline statistics (shader invocations, primitives, ...)
+ * using cmd_begin_statistics() if a statistics query pool is set. These and other per-section
+ * values (add_section_counter()) are averaged per capture and reported with the section.
+ *
+ * For a timeline of individual sections (instead of averages) record a trace using
+ * start_trace() and stop_trace(). GPU timestamps are mapped to the CPU clock using
+ * ExtensionCalibratedTimestamps if it is loaded.
+ *
  * Does not support overlapping sub-regions. Use two profilers in that case.
  * Example:
  * |--------------|
@@ -43,56 +66,152 @@ class ProfileScopeGPU;
  *
  */
 class Profiler : public std::enable_shared_from_this<Profiler> {
+  public:
+    // An interned section name, compares by identity.
+    class SectionName {
+      public:
+        SectionName() = default;
+
+        const std::string& str() const {
+            assert(name);
+            return *name;
+        }
+
+        explicit operator bool() const {
+            return name != nullptr;
+        }
+
+        bool operator==(const SectionName&) const = default;
+
+      private:
+        friend Profiler;
+
+        explicit SectionName(const std::string* name) : name(name) {}
+
+        const std::string* name = nullptr;
+    };
+
   private:
-    using chrono_clock = std::chrono::high_resolution_clock;
+    using chrono_clock = std::chrono::steady_clock;
     friend ProfileScope;
     friend ProfileScopeGPU;
 
+    // Sum of a value that was recorded for a section over the report window.
+    struct SectionCounter {
+        SectionName name;
+        uint64_t sum{0};
+        uint32_t samples{0};
+    };
+
     struct CPUSection {
+        SectionName name;
         chrono_clock::time_point start;
         chrono_clock::time_point end;
         chrono_clock::time_point last_seen{};
 
         std::size_t parent_index;
         // Insertion order tracks execution order; child_cursor is the next insert position.
-        std::vector<std::pair<std::string, uint32_t>> children;
+        std::vector<std::pair<SectionName, uint32_t>> children;
         uint32_t child_cursor{0};
 
         uint32_t num_captures{0};
         uint64_t sum_duration_ns{0};
         uint64_t sq_sum_duration_ns{0};
+        LogHistogram duration_histogram_ns;
+        std::vector<SectionCounter> counters;
     };
 
     struct GPUSection {
+        SectionName name;
         // the query index for start. end has index + 1.
         // set to -1 if not in the command buffer
         uint32_t timestamp_idx{(uint32_t)-1};
         chrono_clock::time_point last_seen{};
 
         std::size_t parent_index;
-        std::vector<std::pair<std::string, uint32_t>> children;
+        std::vector<std::pair<SectionName, uint32_t>> children;
         uint32_t child_cursor{0};
 
         uint32_t num_captures{0};
         uint64_t sum_duration_ns{0};
         uint64_t sq_sum_duration_ns{0};
+        LogHistogram duration_histogram_ns;
+        std::vector<SectionCounter> counters;
+    };
+
+    struct PendingGPUSection {
+        uint32_t section_index;
+        // when cmd_start was called
+        chrono_clock::time_point recorded;
+    };
+
+    // Recorded by threads other than the owner, merged in merge_thread_buffers().
+    struct ThreadEvent {
+        // empty for the end of a section
+        SectionName name;
+        // for top-level sections of the thread
+        uint32_t parent;
+        chrono_clock::time_point time;
+    };
+
+    struct ThreadBuffer {
+        static constexpr std::size_t CAPACITY = 1024;
+
+        explicit ThreadBuffer(const uint32_t thread_index)
+            : thread_index(thread_index), events(CAPACITY) {}
+
+        // in the trace, 0 is the owning thread
+        const uint32_t thread_index;
+        SPSCRingQueue<ThreadEvent> events;
+        // sections that were skipped because the buffer was full
+        std::atomic_uint64_t dropped{0};
+
+        // recording thread: for each open section if its start was buffered
+        std::vector<bool> open;
+        // recording thread: ends of open buffered sections, there is always room for them
+        std::size_t owed_ends{0};
+
+        // owning thread: section index and start time of the open sections
+        std::vector<std::pair<uint32_t, chrono_clock::time_point>> merge_stack;
     };
 
   public:
+    struct TraceEvent {
+        SectionName name;
+        // relative to start_trace()
+        std::chrono::nanoseconds start;
+        std::chrono::nanoseconds end;
+        // index of the recording thread, 0 for GPU events
+        uint32_t thread;
+        bool gpu;
+    };
+
     struct ReportEntry {
         std::string name;
         // in ms
         double duration;
         // in ms
         double std_deviation;
+        // number of captures the values were computed from
+        uint32_t captures;
+        // in ms, percentiles of the captures (relative error < 1/16)
+        double p50;
+        double p95;
+        double p99;
+        // in ms
+        double max;
         // set if no captures landed in the last report window; value is ms since last_seen.
         std::optional<double> last_seen_ms_ago;
         std::vector<ReportEntry> children;
+        // mean per capture of pipeline statistics and section counters (see add_section_counter())
+        std::map<std::string, double> counters;
     };
 
     struct Report {
         std::vector<ReportEntry> cpu_report;
         std::vector<ReportEntry> gpu_report;
+        // latest value of each counter (see set_counter())
+        std::map<std::string, int64_t> counters;
 
         double cpu_total_std_deviation() const {
             if (cpu_report.empty()) {
@@ -129,7 +248,7 @@ class Profiler : public std::enable_shared_from_this<Profiler> {
         }
 
         operator bool() const {
-            return !cpu_report.empty() || !gpu_report.empty();
+            return !cpu_report.empty() || !gpu_report.empty() || !counters.empty();
         }
     };
 
@@ -145,10 +264,23 @@ class Profiler : public std::enable_shared_from_this<Profiler> {
 
     void set_query_pool(const QueryPoolHandle<vk::QueryType::eTimestamp>& query_pool);
 
+    // Enables cmd_begin_statistics(). Remember to reset the query pool after creation.
+    void set_statistics_query_pool(
+        const QueryPoolHandle<vk::QueryType::ePipelineStatistics>& statistics_query_pool);
+
+    // Thread-safe. Interned names are never released, do not intern names that change for every
+    // capture.
+    static SectionName intern(const std::string_view name);
+
     // Start a GPU section
     void cmd_start(
         const CommandBufferHandle& cmd,
-        const std::string& name,
+        const SectionName name,
+        const vk::PipelineStageFlagBits pipeline_stage = vk::PipelineStageFlagBits::eAllCommands);
+
+    void cmd_start(
+        const CommandBufferHandle& cmd,
+        const std::string_view name,
         const vk::PipelineStageFlagBits pipeline_stage = vk::PipelineStageFlagBits::eAllCommands);
 
     // Stop a GPU section
@@ -156,15 +288,37 @@ class Profiler : public std::enable_shared_from_this<Profiler> {
         const CommandBufferHandle& cmd,
         const vk::PipelineStageFlagBits pipeline_stage = vk::PipelineStageFlagBits::eAllCommands);
 
+    // Captures the pipeline statistics of the commands until cmd_end_statistics() for the innermost
+    // open GPU section. Statistics queries cannot be nested and must not span a render pass
+    // boundary. Does nothing if no statistics query pool is set.
+    void cmd_begin_statistics(const CommandBufferHandle& cmd);
+
+    void cmd_end_statistics(const CommandBufferHandle& cmd);
+
     // Collects the results from the GPU and resets the query pool.
     void collect(const bool wait = false, const bool keep_query_pool = false);
 
-    // Start a CPU section
-    void start(const std::string& name);
+    // Start a CPU section. On threads other than the owning thread, top-level sections are nested
+    // into parent (see get_current_section()).
+    void start(const SectionName name, const uint32_t parent = 0);
+
+    void start(const std::string_view name, const uint32_t parent = 0);
 
     // Stop a CPU section
     void end();
 
+    // The innermost open CPU section of the owning thread. Pass it to start() on other threads
+    // (e.g. to tasks that are spawned in this section) to nest their sections.
+    uint32_t get_current_section() const;
+
+    // Records a named value (e.g. a number of rebuilt objects). Counters are not averaged, the
+    // report contains the latest value.
+    void set_counter(const std::string& name, const int64_t value);
+
+    // Adds a value (e.g. uploaded bytes) to the innermost open CPU section of the owning thread.
+    // The report contains the mean per capture.
+    void add_section_counter(const SectionName name, const uint64_t value);
+
     Report get_report();
 
     // Convenience method that sets the next query pool, collects the results then resets query pool
@@ -179,7 +333,21 @@ class Profiler : public std::enable_shared_from_this<Profiler> {
     std::optional<Report>
     set_collect_get_every(const QueryPoolHandle<vk::QueryType::eTimestamp>& query_pool,
                           const uint32_t report_intervall_millis = 0,
-                          const uint32_t evict_after_ms = std::numeric_limits<uint32_t>::max());
+                          const uint32_t evict_after_ms = std::numeric_limits<uint32_t>::max(),
+                          const QueryPoolHandle<vk::QueryType::ePipelineStatistics>&
+                              statistics_query_pool = nullptr);
+
+    // Records the begin and end of every section from now on (in addition to the statistics).
+    void start_trace();
+
+    // Collects all outstanding GPU timestamps, waiting for them, and returns the events recorded
+    // since start_trace(). Make sure the GPU work was submitted before calling.
+    std::vector<TraceEvent> stop_trace();
+
+    bool is_tracing() const;
+
+    // Chrome trace event format (JSON), open with ui.perfetto.dev or chrome://tracing.
+    static std::string get_chrome_trace(const std::vector<TraceEvent>& events);
 
     // returns the report as string
     static std::string get_report_str(const Profiler::Report& report);
@@ -197,13 +365,53 @@ class Profiler : public std::enable_shared_from_this<Profiler> {
     template <typename SectionType>
     static void enter_child(std::vector<SectionType>& sections,
                             std::size_t parent_idx,
-                            const std::string& name,
+                            const SectionName name,
                             uint32_t& current_idx);
 
+    void collect(const QueryPoolHandle<vk::QueryType::eTimestamp>& query_pool,
+                 const bool wait,
+                 const bool keep_query_pool);
+
+    void collect_statistics(const bool wait, const bool keep_query_pool);
+
+    static void add_counter(std::vector<SectionCounter>& counters,
+                            const SectionName name,
+                            const uint64_t value);
+
+    bool on_owner_thread() const {
+        return std::this_thread::get_id() == owner_thread;
+    }
+
+    // The buffer of the calling thread, registers one on first use.
+    ThreadBuffer& get_thread_buffer();
+
+    void start_buffered(const SectionName name, const uint32_t parent);
+
+    void end_buffered();
+
+    // Moves the sections that other threads recorded into the tree.
+    void merge_thread_buffers();
+
+    // Updates the statistics of a CPU section and records the trace event.
+    void add_cpu_capture(const uint32_t section_index,
+                         const chrono_clock::time_point start,
+                         const chrono_clock::time_point end,
+                         const uint32_t thread_index);
+
+    // Identifies the open section in debug checks of ProfileScope.
+    uint32_t get_scope_token();
+
+    // Maps a raw GPU timestamp to the trace timeline.
+    std::chrono::nanoseconds trace_time(const uint64_t timestamp) const;
+
     const ContextHandle context;
     const float timestamp_period;
+    const std::thread::id owner_thread;
+    // distinguishes profilers in the thread-local buffer lookup (addresses can be reused)
+    const uint64_t id;
 
     QueryPoolHandle<vk::QueryType::eTimestamp> query_pool;
+    QueryPoolHandle<vk::QueryType::ePipelineStatistics> statistics_query_pool;
 
     Stopwatch report_intervall;
 
@@ -214,33 +422,61 @@ class Profiler : public std::enable_shared_from_this<Profiler> {
     std::vector<CPUSection> cpu_sections;
     std::vector<GPUSection> gpu_sections;
 
+    std::map<std::string, int64_t> counters;
+
     // Set in clear(); a section is fresh this period iff last_seen >= last_clear_time.
     chrono_clock::time_point last_clear_time;
 
-    std::unordered_map<QueryPoolHandle<vk::QueryType::eTimestamp>, std::vector<uint32_t>>
+    std::unordered_map<QueryPoolHandle<vk::QueryType::eTimestamp>,
+                       std::vector<PendingGPUSection>>
         pending_gpu_sections;
+
+    // GPU section index for each query of the statistics query pool.
+    std::unordered_map<QueryPoolHandle<vk::QueryType::ePipelineStatistics>,
+                       std::vector<uint32_t>>
+        pending_statistics;
+    bool statistics_active = false;
+
+    std::mutex thread_buffers_mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> thread_buffers;
+
+    // --- Trace ---
+
+    std::optional<chrono_clock::time_point> trace_start;
+    std::vector<TraceEvent> trace_events;
+    // a GPU timestamp and the corresponding time on the trace timeline
+    std::optional<std::pair<uint64_t, std::chrono::nanoseconds>> trace_gpu_reference;
 };
 using ProfilerHandle = std::shared_ptr<Profiler>;
 
 class ProfileScope {
   public:
-    ProfileScope(const ProfilerHandle& profiler, const std::string& name) : profiler(profiler) {
+    ProfileScope(const ProfilerHandle& profiler,
+                 const Profiler::SectionName name,
+                 const uint32_t parent = 0)
+        : profiler(profiler) {
         if (!profiler) {
             return;
         }
 
-        profiler->start(name);
+        profiler->start(name, parent);
 #ifndef NDEBUG
-        section_index = profiler->current_cpu_section;
+        section_index = profiler->get_scope_token();
 #endif
     }
 
+    ProfileScope(const ProfilerHandle& profiler,
+                 const std::string_view name,
+                 const uint32_t parent = 0)
+        : ProfileScope(profiler, profiler ? Profiler::intern(name) : Profiler::SectionName(),
+                       parent) {}
+
     ~ProfileScope() {
         if (!profiler)
             return;
 
 #ifndef NDEBUG
-        assert(section_index == profiler->current_cpu_section && "overlapping profiling sections?");
+        assert(section_index == profiler->get_scope_token() && "overlapping profiling sections?");
 #endif
 
         profiler->end();
@@ -258,7 +494,7 @@ class ProfileScopeGPU {
     // Make sure the command buffers stays valid
     ProfileScopeGPU(const ProfilerHandle& profiler,
                     const CommandBufferHandle& cmd,
-                    const std::string& name)
+                    const Profiler::SectionName name)
         : profiler(profiler), cmd(cmd) {
         if (!profiler)
             return;
@@ -267,17 +503,23 @@ class ProfileScopeGPU {
         profiler->cmd_start(cmd, name);
 
 #ifndef NDEBUG
-        cpu_section_index = profiler->current_cpu_section;
+        cpu_section_index = profiler->get_scope_token();
         gpu_section_index = profiler->current_gpu_section;
 #endif
     }
 
+    ProfileScopeGPU(const ProfilerHandle& profiler,
+                    const CommandBufferHandle& cmd,
+                    const std::string_view name)
+        : ProfileScopeGPU(
+              profiler, cmd, profiler ? Profiler::intern(name) : Profiler::SectionName()) {}
+
     ~ProfileScopeGPU() {
         if (!profiler)
             return;
 
 #ifndef NDEBUG
-        assert(cpu_section_index == profiler->current_cpu_section &&
+        assert(cpu_section_index == profiler->get_scope_token() &&
                "overlapping profiling sections?");
         assert(gpu_section_index == profiler->current_gpu_section &&
                "overlapping profiling sections?");
@@ -329,6 +571,9 @@ class [[nodiscard]] ScopedDefaultProfiler {
         merian::ProfileScope merian_profile_scope(profiler, name)
     #define MERIAN_PROFILE_SCOPE(...) \
         MERIAN_PP_EXPAND(MERIAN_PP_PICK_2(__VA_ARGS__, MERIAN_PROFILE_SCOPE_2, MERIAN_PROFILE_SCOPE_1)(__VA_ARGS__))
+    // For tasks on other threads: nests the scope into parent (see Profiler::get_current_section())
+    #define MERIAN_PROFILE_SCOPE_IN(profiler, parent, name) \
+        merian::ProfileScope merian_profile_scope(profiler, name, parent)
 
     #define MERIAN_PROFILE_SCOPE_GPU_2(cmd, name) \
         merian::ProfileScopeGPU merian_profile_scope(merian::get_default_profiler(), cmd, name)
@@ -342,6 +587,8 @@ class [[nodiscard]] ScopedDefaultProfiler {
     #define MERIAN_PROFILE_DISCARD_3(a, b, c) ((void)sizeof(a), (void)sizeof(b), (void)sizeof(c))
     #define MERIAN_PROFILE_SCOPE(...) \
         MERIAN_PP_EXPAND(MERIAN_PP_PICK_2(__VA_ARGS__, MERIAN_PROFILE_DISCARD_2, MERIAN_PROFILE_DISCARD_1)(__VA_ARGS__))
+    #define MERIAN_PROFILE_SCOPE_IN(profiler, parent, name) \
+        MERIAN_PROFILE_DISCARD_3(profiler, parent, name)
     #define MERIAN_PROFILE_SCOPE_GPU(...) \
         MERIAN_PP_EXPAND(MERIAN_PP_PICK_3(__VA_ARGS__, MERIAN_PROFILE_DISCARD_3, MERIAN_PROFILE_DISCARD_2)(__VA_ARGS__))
 #endif
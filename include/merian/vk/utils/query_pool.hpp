@@ -3,6 +3,7 @@
 #include "merian/vk/context.hpp"
 #include "merian/vk/utils/check_result.hpp"
 
+#include <bit>
 #include <memory>
 
 namespace merian {
@@ -15,12 +16,21 @@ class QueryPool : public std::enable_shared_from_this<QueryPool<QUERY_TYPE>>, pu
 
   public:
     // Creates a query pool and resets it.
+    //
+    // pipeline_statistics selects the counters of ePipelineStatistics queries, each query then
+    // returns one value per set bit in the order of the bits.
     QueryPool(const ContextHandle& context,
               const uint32_t query_count = 1024,
-              bool host_reset_after_creation = false)
-        : context(context), query_count(query_count) {
-
-        const vk::QueryPoolCreateInfo create_info({}, QUERY_TYPE, query_count);
+              bool host_reset_after_creation = false,
+              const vk::QueryPipelineStatisticFlags pipeline_statistics = {})
+        : context(context), query_count(query_count), pipeline_statistics(pipeline_statistics),
+          values_per_query(QUERY_TYPE == vk::QueryType::ePipelineStatistics
+                               ? std::popcount((VkQueryPipelineStatisticFlags)pipeline_statistics)
+                               : 1) {
+        assert(QUERY_TYPE == vk::QueryType::ePipelineStatistics || !pipeline_statistics);
+
+        const vk::QueryPoolCreateInfo create_info({}, QUERY_TYPE, query_count,
+                                                  pipeline_statistics);
         query_pool = context->get_device()->get_device().createQueryPool(create_info);
 
         if (host_reset_after_creation) {
@@ -69,26 +79,31 @@ class QueryPool : public std::enable_shared_from_this<QueryPool<QUERY_TYPE>>, pu
         return query_count;
     }
 
+    const vk::QueryPipelineStatisticFlags& get_pipeline_statistics() const {
+        return pipeline_statistics;
+    }
+
+    // Number of values each query returns (1 except for pipeline statistics).
+    uint32_t get_values_per_query() const {
+        return values_per_query;
+    }
+
+    // Returns get_values_per_query() values for each query.
     template <typename RETURN_TYPE>
     std::vector<RETURN_TYPE> get_query_pool_results(const uint32_t first_query,
                                                     const uint32_t query_count,
                                                     const vk::QueryResultFlags flags = {}) const {
-        std::vector<RETURN_TYPE> data(query_count);
+        std::vector<RETURN_TYPE> data((std::size_t)query_count * values_per_query);
         check_result(context->get_device()->get_device().getQueryPoolResults(
-                         query_pool, first_query, data.size(), sizeof(RETURN_TYPE) * data.size(),
-                         data.data(), sizeof(RETURN_TYPE), flags),
+                         query_pool, first_query, query_count, sizeof(RETURN_TYPE) * data.size(),
+                         data.data(), sizeof(RETURN_TYPE) * values_per_query, flags),
                      "could not get query results");
         return data;
     }
 
     template <typename RETURN_TYPE>
     std::vector<RETURN_TYPE> get_query_pool_results(const vk::QueryResultFlags flags = {}) const {
-        std::vector<RETURN_TYPE> data(query_count);
-        check_result(context->get_device()->get_device().getQueryPoolResults(
-                         query_pool, 0, data.size(), sizeof(RETURN_TYPE) * data.size(), data.data(),
-                         sizeof(RETURN_TYPE), flags),
-                     "could not get query results");
-        return data;
+        return get_query_pool_results<RETURN_TYPE>(0, query_count, flags);
     }
 
     std::vector<uint32_t> get_query_pool_results(const uint32_t first_query,
@@ -118,13 +133,18 @@ class QueryPool : public std::enable_shared_from_this<QueryPool<QUERY_TYPE>>, pu
   private:
     const ContextHandle context;
     const uint32_t query_count;
+    const vk::QueryPipelineStatisticFlags pipeline_statistics;
+    const uint32_t values_per_query;
     vk::QueryPool query_pool;
 
   public:
-    static QueryPoolHandle<QUERY_TYPE> create(const ContextHandle& context,
-                                              const uint32_t query_count = 1024,
-                                              bool host_reset_after_creation = false) {
-        return std::make_shared<QueryPool>(context, query_count, host_reset_after_creation);
+    static QueryPoolHandle<QUERY_TYPE>
+    create(const ContextHandle& context,
+           const uint32_t query_count = 1024,
+           bool host_reset_after_creation = false,
+           const vk::QueryPipelineStatisticFlags pipeline_statistics = {}) {
+        return std::make_shared<QueryPool>(context, query_count, host_reset_after_creation,
+                                           pipeline_statistics);
     }
 };
 
@@ -0,0 +1,306 @@
+// Compares two benchmark results of merian-graph-run --benchmark per profiler section and exits
+// with 1 if a section got slower than the noise threshold allows.
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Must match BenchmarkRecorder::FORMAT_VERSION of merian-graph-run.
+constexpr uint32_t SUPPORTED_FORMAT_VERSION = 1;
+
+constexpr int EXIT_REGRESSION = 1;
+constexpr int EXIT_ERROR = 2;
+
+void print_usage() {
+    fmt::print(
+        "usage: merian-benchmark-compare [options] baseline.json current.json\n"
+        "  --threshold=<percent>  slowdown per section that is considered noise (default 5)\n"
+        "  --min-delta=<ms>       absolute slowdown that is considered noise, keeps tiny\n"
+        "                         sections from failing on jitter (default 0.01)\n"
+        "  --metric=<name>        statistic to compare: min, median, p95, p99, max or mean\n"
+        "                         (default median)\n"
+        "  --only-regressions     do not print unchanged sections\n"
+        "  --help\n"
+        "exits with 1 if any section (or the CPU/GPU total or the time per iteration) regressed,\n"
+        "with 2 on invalid input.\n");
+}
+
+struct Options {
+    std::filesystem::path baseline;
+    std::filesystem::path current;
+    double threshold_percent = 5;
+    double min_delta_ms = 0.01;
+    std::string metric = "median";
+    bool only_regressions = false;
+};
+
+// Parses the value of an --option=value argument as number, logs an error if it is malformed.
+std::optional<double> parse_number(const std::string& arg) {
+    const std::string value = arg.substr(arg.find('=') + 1);
+    try {
+        std::size_t end;
+        const double number = std::stod(value, &end);
+        if (end == value.size()) {
+            return number;
+        }
+    } catch (const std::invalid_argument&) {
+    } catch (const std::out_of_range&) {
+    }
+    SPDLOG_ERROR("invalid number in '{}'", arg);
+    return std::nullopt;
+}
+
+std::optional<Options> parse(const std::vector<std::string>& args) {
+    Options options;
+    std::vector<std::filesystem::path> files;
+    for (size_t i = 1; i < args.size(); i++) {
+        const std::string& arg = args[i];
+        if (arg.starts_with("--threshold=")) {
+            const std::optional<double> threshold = parse_number(arg);
+            if (!threshold) {
+                return std::nullopt;
+            }
+            options.threshold_percent = *threshold;
+        } else if (arg.starts_with("--min-delta=")) {
+            const std::optional<double> min_delta = parse_number(arg);
+            if (!min_delta) {
+                return std::nullopt;
+            }
+            options.min_delta_ms = *min_delta;
+        } else if (arg.starts_with("--metric=")) {
+            options.metric = arg.substr(arg.find('=') + 1);
+            const std::vector<std::string> metrics = {"min", "median", "p95", "p99", "max", "mean"};
+            if (std::ranges::find(metrics, options.metric) == metrics.end()) {
+                SPDLOG_ERROR("invalid --metric '{}'", options.metric);
+                return std::nullopt;
+            }
+        } else if (arg == "--only-regressions") {
+            options.only_regressions = true;
+        } else if (arg.starts_with("-")) {
+            SPDLOG_ERROR("unknown option '{}'", arg);
+            return std::nullopt;
+        } else {
+            files.emplace_back(arg);
+        }
+    }
+    if (files.size() != 2) {
+        SPDLOG_ERROR("expected a baseline and a current benchmark result");
+        return std::nullopt;
+    }
+    options.baseline = files[0];
+    options.current = files[1];
+    return options;
+}
+
+std::optional<nlohmann::json> load(const std::filesystem::path& path) {
+    std::ifstream stream(path);
+    if (!stream) {
+        SPDLOG_ERROR("could not open '{}'", path.string());
+        return std::nullopt;
+    }
+    nlohmann::json json;
+    try {
+        json = nlohmann::json::parse(stream);
+    } catch (const nlohmann::json::exception& e) {
+        SPDLOG_ERROR("could not parse '{}': {}", path.string(), e.what());
+        return std::nullopt;
+    }
+    // value() throws if the document is not an object or the format is not a number
+    if (!json.is_object() || !json.contains("format") || !json["format"].is_number_unsigned() ||
+        json["format"].get<uint32_t>() != SUPPORTED_FORMAT_VERSION) {
+        SPDLOG_ERROR("'{}' is not a benchmark result of format {}", path.string(),
+                     SUPPORTED_FORMAT_VERSION);
+        return std::nullopt;
+    }
+    return json;
+}
+
+enum class Verdict {
+    UNCHANGED,
+    IMPROVED,
+    REGRESSED,
+    ADDED,
+    REMOVED,
+};
+
+struct Comparison {
+    std::string section;
+    std::optional<double> baseline_ms;
+    std::optional<double> current_ms;
+    Verdict verdict;
+};
+
+std::optional<double> get_ms(const nlohmann::json& stats, const std::string& metric) {
+    // sections that were never sampled carry no information
+    if (!stats.is_object() || stats.value("samples", 0u) == 0) {
+        return std::nullopt;
+    }
+    return stats.value(metric + "_ms", 0.);
+}
+
+Comparison compare(const std::string& section,
+                   const std::optional<double> baseline_ms,
+                   const std::optional<double> current_ms,
+                   const Options& options) {
+    Verdict verdict = Verdict::UNCHANGED;
+    if (!baseline_ms && current_ms) {
+        verdict = Verdict::ADDED;
+    } else if (baseline_ms && !current_ms) {
+        verdict = Verdict::REMOVED;
+    } else if (baseline_ms && current_ms) {
+        const double delta = *current_ms - *baseline_ms;
+        const double allowed = std::max(options.min_delta_ms,
+                                        *baseline_ms * options.threshold_percent / 100.);
+        if (delta > allowed) {
+            verdict = Verdict::REGRESSED;
+        } else if (-delta > allowed) {
+            verdict = Verdict::IMPROVED;
+        }
+    }
+    return Comparison{section, baseline_ms, current_ms, verdict};
+}
+
+std::optional<double> get_ms_per_iteration(const nlohmann::json& result) {
+    const nlohmann::json throughput = result.value("throughput", nlohmann::json::object());
+    if (!throughput.contains("ms_per_iteration") || result.value("iterations", 0u) == 0) {
+        return std::nullopt;
+    }
+    return throughput["ms_per_iteration"].get<double>();
+}
+
+std::string format_ms(const std::optional<double> ms) {
+    return ms ? fmt::format("{:.4f}", *ms) : "-";
+}
+
+std::string format_change(const Comparison& comparison) {
+    if (!comparison.baseline_ms || !comparison.current_ms || *comparison.baseline_ms == 0) {
+        return "";
+    }
+    return fmt::format("{:+.1f}%",
+                       (*comparison.current_ms / *comparison.baseline_ms - 1.) * 100.);
+}
+
+std::string format_verdict(const Verdict verdict) {
+    switch (verdict) {
+    case Verdict::UNCHANGED:
+        return "";
+    case Verdict::IMPROVED:
+        return "improved";
+    case Verdict::REGRESSED:
+        return "REGRESSED";
+    case Verdict::ADDED:
+        return "new";
+    case Verdict::REMOVED:
+        return "removed";
+    }
+    return "";
+}
+
+} // namespace
+
+int main(const int argc, const char** argv) {
+    const std::vector<std::string> args(argv, argv + argc);
+    if (std::ranges::any_of(args, [](const std::string& arg) { return arg == "--help"; })) {
+        print_usage();
+        return 0;
+    }
+    const auto options = parse(args);
+    if (!options) {
+        print_usage();
+        return EXIT_ERROR;
+    }
+
+    const std::optional<nlohmann::json> baseline = load(options->baseline);
+    const std::optional<nlohmann::json> current = load(options->current);
+    if (!baseline || !current) {
+        return EXIT_ERROR;
+    }
+
+    for (const char* key : {"graph", "time_delta_ms"}) {
+        if (baseline->value(key, nlohmann::json()) != current->value(key, nlohmann::json())) {
+            SPDLOG_WARN("'{}' differs between baseline ({}) and current ({}), the results might "
+                        "not be comparable",
+                        key, baseline->value(key, nlohmann::json()).dump(),
+                        current->value(key, nlohmann::json()).dump());
+        }
+    }
+
+    std::vector<Comparison> comparisons;
+    try {
+        // time per iteration is not a profiler section and always a mean over the run
+        comparisons.emplace_back(compare("ms per iteration", get_ms_per_iteration(*baseline),
+                                         get_ms_per_iteration(*current), *options));
+        for (const char* total : {"cpu_total", "gpu_total"}) {
+            comparisons.emplace_back(compare(total,
+                                             get_ms(baseline->value(total, nlohmann::json()),
+                                                    options->metric),
+                                             get_ms(current->value(total, nlohmann::json()),
+                                                    options->metric),
+                                             *options));
+        }
+        for (const char* kind : {"cpu", "gpu"}) {
+            const nlohmann::json baseline_sections =
+                baseline->value(kind, nlohmann::json::object());
+            const nlohmann::json current_sections =
+                current->value(kind, nlohmann::json::object());
+
+            std::set<std::string> sections;
+            for (const auto& [section, _] : baseline_sections.items()) {
+                sections.insert(section);
+            }
+            for (const auto& [section, _] : current_sections.items()) {
+                sections.insert(section);
+            }
+
+            for (const std::string& section : sections) {
+                comparisons.emplace_back(compare(
+                    fmt::format("{}: {}", kind, section),
+                    get_ms(baseline_sections.value(section, nlohmann::json()), options->metric),
+                    get_ms(current_sections.value(section, nlohmann::json()), options->metric),
+                    *options));
+            }
+        }
+    } catch (const nlohmann::json::exception& e) {
+        SPDLOG_ERROR("malformed benchmark result: {}", e.what());
+        return EXIT_ERROR;
+    }
+
+    std::size_t name_width = 7;
+    for (const Comparison& comparison : comparisons) {
+        name_width = std::max(name_width, comparison.section.size());
+    }
+
+    fmt::print("comparing {} with threshold {}% (at least {} ms)\n\n", options->metric,
+               options->threshold_percent, options->min_delta_ms);
+    fmt::print("{:<{}}  {:>12}  {:>12}  {:>8}\n", "section", name_width, "baseline ms",
+               "current ms", "change");
+    uint32_t regressions = 0;
+    for (const Comparison& comparison : comparisons) {
+        if (comparison.verdict == Verdict::REGRESSED) {
+            regressions++;
+        } else if (options->only_regressions) {
+            continue;
+        }
+        fmt::print("{:<{}}  {:>12}  {:>12}  {:>8}  {}\n", comparison.section, name_width,
+                   format_ms(comparison.baseline_ms), format_ms(comparison.current_ms),
+                   format_change(comparison), format_verdict(comparison.verdict));
+    }
+
+    if (regressions > 0) {
+        fmt::print("\n{} regression(s)\n", regressions);
+        return EXIT_REGRESSION;
+    }
+    fmt::print("\nno regressions\n");
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "benchmark.hpp"
+
+#include "merian/utils/statistics.hpp"
+
+namespace merian {
+
+void BenchmarkRecorder::record(const Profiler::Report& report) {
+    reports++;
+    record_entries(cpu_samples, cpu_counter_samples, report.cpu_report, "");
+    record_entries(gpu_samples, gpu_counter_samples, report.gpu_report, "");
+    if (!report.cpu_report.empty()) {
+        cpu_totals.emplace_back(report.cpu_total());
+    }
+    if (!report.gpu_report.empty()) {
+        gpu_totals.emplace_back(report.gpu_total());
+    }
+    for (const auto& [name, value] : report.counters) {
+        counters[name] = value;
+    }
+}
+
+void BenchmarkRecorder::record_entries(Samples& samples,
+                                       CounterSamples& counter_samples,
+                                       const std::vector<Profiler::ReportEntry>& entries,
+                                       const std::string& prefix) {
+    for (const Profiler::ReportEntry& entry : entries) {
+        const std::string path = prefix.empty() ? entry.name : prefix + "/" + entry.name;
+        if (entry.captures > 0 && !entry.last_seen_ms_ago) {
+            samples[path].emplace_back(entry.duration);
+            for (const auto& [name, value] : entry.counters) {
+                counter_samples[path][name].emplace_back(value);
+            }
+        }
+        record_entries(samples, counter_samples, entry.children, path);
+    }
+}
+
+uint64_t BenchmarkRecorder::recorded_reports() const {
+    return reports;
+}
+
+nlohmann::json BenchmarkRecorder::to_json(const std::vector<double>& samples) {
+    const SampleStatistics stats = SampleStatistics::compute(samples);
+    return {
+        {"samples", stats.count}, {"min_ms", stats.min}, {"median_ms", stats.median},
+        {"p95_ms", stats.p95},    {"p99_ms", stats.p99}, {"max_ms", stats.max},
+        {"mean_ms", stats.mean},
+    };
+}
+
+nlohmann::json BenchmarkRecorder::to_json(const nlohmann::json& run_info,
+                                          const uint64_t iterations,
+                                          const double wall_time_ms) const {
+    nlohmann::json result = run_info;
+    result["format"] = FORMAT_VERSION;
+    result["iterations"] = iterations;
+    result["wall_time_ms"] = wall_time_ms;
+    result["throughput"] = {
+        {"iterations_per_second", wall_time_ms > 0 ? iterations * 1000. / wall_time_ms : 0.},
+        {"ms_per_iteration", iterations > 0 ? wall_time_ms / iterations : 0.},
+    };
+
+    result["cpu_total"] = to_json(cpu_totals);
+    result["gpu_total"] = to_json(gpu_totals);
+    result["cpu"] = nlohmann::json::object();
+    for (const auto& [path, samples] : cpu_samples) {
+        result["cpu"][path] = to_json(samples);
+    }
+    result["gpu"] = nlohmann::json::object();
+    for (const auto& [path, samples] : gpu_samples) {
+        result["gpu"][path] = to_json(samples);
+    }
+    for (const auto& [kind, counter_samples] :
+         {std::pair{"cpu", &cpu_counter_samples}, std::pair{"gpu", &gpu_counter_samples}}) {
+        for (const auto& [path, counters_for_path] : *counter_samples) {
+            nlohmann::json& section_counters = result[kind][path]["counters"];
+            for (const auto& [name, samples] : counters_for_path) {
+                section_counters[name] = SampleStatistics::compute(samples).mean;
+            }
+        }
+    }
+    result["counters"] = counters;
+
+    return result;
+}
+
+} // namespace merian
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "merian/vk/utils/profiler.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace merian {
+
+// Collects per-iteration profiler reports (report interval 0) of a benchmark run and summarizes
+// them as order statistics per section.
+//
+// Sections are keyed by their path in the profiler tree, e.g. "Run/Preprocess nodes". Sections
+// that did not run in an iteration are not sampled for that iteration. Section counters (pipeline
+// statistics, staging traffic) are reported as mean over the sampled iterations.
+class BenchmarkRecorder {
+  public:
+    // Bump together with merian-benchmark-compare when the layout of to_json() changes.
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    void record(const Profiler::Report& report);
+
+    uint64_t recorded_reports() const;
+
+    // run_info is copied into the result (e.g. graph name, iteration counts, time delta).
+    nlohmann::json to_json(const nlohmann::json& run_info,
+                           const uint64_t iterations,
+                           const double wall_time_ms) const;
+
+  private:
+    using Samples = std::map<std::string, std::vector<double>>;
+    // path -> counter name -> samples
+    using CounterSamples = std::map<std::string, Samples>;
+
+    static void record_entries(Samples& samples,
+                               CounterSamples& counter_samples,
+                               const std::vector<Profiler::ReportEntry>& entries,
+                               const std::string& prefix);
+
+    static nlohmann::json to_json(const std::vector<double>& samples);
+
+    uint64_t reports = 0;
+    Samples cpu_samples;
+    Samples gpu_samples;
+    CounterSamples cpu_counter_samples;
+    CounterSamples gpu_counter_samples;
+    std::vector<double> cpu_totals;
+    std::vector<double> gpu_totals;
+    std::map<std::string, int64_t> counters;
+};
+
+} // namespace merian
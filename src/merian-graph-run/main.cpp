@@ -1,10 +1,14 @@
+#include "benchmark.hpp"
+
 #include "merian-graph/graph/graph.hpp"
 #include "merian-graph/graph/graph_description.hpp"
 #include "merian-graph/merian_graph_extension.hpp"
 #include "merian-graph/nodes/window/window_node.hpp"
 #include "merian/io/file_loader.hpp"
 #include "merian/plugin/plugins.hpp"
+#include "merian/utils/stopwatch.hpp"
 #include "merian/vk/context.hpp"
+#include "merian/vk/extension/extension_calibrated_timestamps.hpp"
 #include "merian/vk/extension/extension_device_fault.hpp"
 #include "merian/vk/extension/extension_resources.hpp"
 #include "merian/vk/extension/extension_vk_validation_layers.hpp"
@@ -21,6 +25,10 @@
 
 namespace {
 
+constexpr float DEFAULT_BENCHMARK_TIME_DELTA_MS = 1000.f / 60.f;
+constexpr uint64_t DEFAULT_BENCHMARK_ITERATIONS = 1000;
+constexpr uint64_t DEFAULT_TRACE_ITERATIONS = 100;
+
 std::atomic_bool stop{false};
 
 // Async-signal-safe: only touch the atomic, never lock or log.
@@ -41,6 +49,20 @@ void print_usage() {
         "                                instead of following the wall clock\n"
         "  --print-times                 print the profiler report after the last iteration,\n"
         "                                averaged over the whole run\n"
+        "  --print-barriers              print the barrier schedule of the graph after the last\n"
+        "                                iteration\n"
+        "  --benchmark=<out.json>        run --warmup-iterations, then --max-iterations (default\n"
+        "                                1000) measured iterations and write min/median/p95/p99/\n"
+        "                                max of the CPU and GPU time per profiler section and the\n"
+        "                                throughput to out.json. --time-delta defaults to 16.667\n"
+        "  --warmup-iterations=<N>       iterations before measuring in --benchmark (default 100)\n"
+        "  --trace=<out.json>            record a timeline of the CPU and GPU profiler sections\n"
+        "                                and write it in Chrome trace format (open with\n"
+        "                                ui.perfetto.dev). Starts after the warmup in --benchmark\n"
+        "  --trace-iterations=<N>        iterations to record with --trace (default 100)\n"
+        "  --memory-statistics=<out.json> write the live GPU memory by owner and debug name,\n"
+        "                                heap budgets and high-water marks after the last\n"
+        "                                iteration\n"
         "  --<name> <value>              set an override declared in the graph's \"cli\" block;\n"
         "                                may appear before or after graph.json, in any order\n"
         "                                variant selections persist when the graph is stored;\n"
@@ -57,6 +79,12 @@ struct Options {
     std::optional<uint64_t> max_iterations;
     std::optional<float> time_delta_ms;
     bool print_times = false;
+    bool print_barriers = false;
+    std::optional<std::filesystem::path> benchmark_output;
+    uint64_t warmup_iterations = 100;
+    std::optional<std::filesystem::path> trace_output;
+    uint64_t trace_iterations = DEFAULT_TRACE_ITERATIONS;
+    std::optional<std::filesystem::path> memory_statistics_output;
     // Non-runner tokens in command-line order; classified against the graph's cli block once
     // the config is loaded. A pre-config override's value is kept adjacent to its --name.
     std::vector<std::string> graph_args;
@@ -93,6 +121,18 @@ std::optional<Options> parse(const std::vector<std::string>& args) {
             options.time_delta_ms = std::stof(arg.substr(arg.find('=') + 1));
         } else if (arg == "--print-times") {
             options.print_times = true;
+        } else if (arg == "--print-barriers") {
+            options.print_barriers = true;
+        } else if (arg.starts_with("--benchmark=")) {
+            options.benchmark_output = arg.substr(arg.find('=') + 1);
+        } else if (arg.starts_with("--warmup-iterations=")) {
+            options.warmup_iterations = std::stoull(arg.substr(arg.find('=') + 1));
+        } else if (arg.starts_with("--trace=")) {
+            options.trace_output = arg.substr(arg.find('=') + 1);
+        } else if (arg.starts_with("--trace-iterations=")) {
+            options.trace_iterations = std::stoull(arg.substr(arg.find('=') + 1));
+        } else if (arg.starts_with("--memory-statistics=")) {
+            options.memory_statistics_output = arg.substr(arg.find('=') + 1);
         } else if (arg.starts_with("--loglevel=")) {
             spdlog::set_level(spdlog::level::from_str(arg.substr(arg.find('=') + 1)));
         } else if (arg.starts_with("--plugin-path=")) {
@@ -118,6 +158,29 @@ std::optional<Options> parse(const std::vector<std::string>& args) {
     return options;
 }
 
+bool write_file(const std::filesystem::path& path, const std::string& content) {
+    std::ofstream stream(path);
+    if (!stream) {
+        SPDLOG_ERROR("could not open '{}' for writing", path.string());
+        return false;
+    }
+    stream << content;
+    return true;
+}
+
+bool write_json(const std::filesystem::path& path, const nlohmann::json& json) {
+    return write_file(path, json.dump(4) + '\n');
+}
+
+bool write_trace(const std::filesystem::path& path,
+                 const std::vector<merian::Profiler::TraceEvent>& events) {
+    if (!write_file(path, merian::Profiler::get_chrome_trace(events))) {
+        return false;
+    }
+    SPDLOG_INFO("wrote trace with {} events to {}", events.size(), path.string());
+    return true;
+}
+
 // Fallback when no config is given: a cleared window with the ImGui overlay.
 void build_default_graph(const merian::GraphHandle& graph) {
     const std::string window = graph->add_node("Window", "window");
@@ -206,6 +269,10 @@ int main(const int argc, const char** argv) {
     if (options->validation) {
         context_extensions.emplace_back(merian::ExtensionVkValidationLayers::name);
     }
+    if (options->trace_output) {
+        // optional, maps the GPU timestamps onto the CPU timeline
+        context_extensions.emplace_back(merian::ExtensionCalibratedTimestamps::name);
+    }
 
     const merian::ContextHandle context = merian::Context::create({
         .context_extensions = context_extensions,
@@ -228,24 +295,103 @@ int main(const int argc, const char** argv) {
         build_default_graph(graph);
     }
 
+    const bool benchmark = options->benchmark_output.has_value();
     if (options->time_delta_ms) {
         graph->set_time_delta_overwrite(*options->time_delta_ms);
+    } else if (benchmark) {
+        // time-dependent work (animations, accumulation) must not depend on the machine's speed
+        graph->set_time_delta_overwrite(DEFAULT_BENCHMARK_TIME_DELTA_MS);
     }
-    if (options->print_times) {
+    if (benchmark) {
+        // One report per iteration, the recorder computes the statistics.
+        graph->set_profiler_report_interval(0);
+#ifndef MERIAN_PROFILER_ENABLE
+        SPDLOG_WARN("built without MERIAN_PROFILER_ENABLE, the benchmark only contains the "
+                    "throughput. Configure with -Dperformance_profiling=true.");
+#endif
+    } else if (options->print_times) {
         // Suppress the periodic report, so the one taken at the end spans every iteration.
         graph->set_profiler_report_interval(std::numeric_limits<uint32_t>::max());
     }
+#ifndef MERIAN_PROFILER_ENABLE
+    if (options->trace_output) {
+        SPDLOG_WARN("built without MERIAN_PROFILER_ENABLE, the trace will be empty. Configure "
+                    "with -Dperformance_profiling=true.");
+    }
+#endif
+
+    const uint64_t warmup_iterations = benchmark ? options->warmup_iterations : 0;
+    const std::optional<uint64_t> max_iterations =
+        benchmark ? options->max_iterations.value_or(DEFAULT_BENCHMARK_ITERATIONS)
+                  : options->max_iterations;
+    merian::BenchmarkRecorder recorder;
+    merian::Stopwatch measurement;
+    uint64_t iterations = 0;
+    // graph->run() calls including the warmup
+    uint64_t runs = 0;
+    double wall_time_ms = 0;
+    bool tracing = false;
+    // Stopping the trace drains the GPU, its time and the next report are not measured.
+    double excluded_ms = 0;
+    bool skip_report = false;
 
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
 
     try {
-        for (uint64_t iteration = 0;
-             !stop && (!options->max_iterations || iteration < *options->max_iterations);
-             iteration++) {
+        for (; !stop && runs < warmup_iterations; runs++) {
+            graph->run();
+        }
+        if (benchmark) {
+            SPDLOG_INFO("warmup done, measuring {} iterations", *max_iterations);
+            graph->set_on_run_report(
+                [&](const merian::Profiler::Report& report) {
+                    // The report is collected during run `runs` but holds the GPU times of the
+                    // iteration that used the in-flight slot before.
+                    if (runs < warmup_iterations + graph->get_iterations_in_flight()) {
+                        return;
+                    }
+                    if (skip_report) {
+                        skip_report = false;
+                        return;
+                    }
+                    recorder.record(report);
+                });
+        }
+
+        if (options->trace_output) {
+            graph->start_trace();
+            tracing = true;
+        }
+
+        measurement.reset();
+        for (; !stop && (!max_iterations || iterations < *max_iterations); iterations++, runs++) {
+            if (tracing && iterations == options->trace_iterations) {
+                const merian::Stopwatch stop_trace;
+                if (!write_trace(*options->trace_output, graph->stop_trace())) {
+                    return 1;
+                }
+                tracing = false;
+                excluded_ms += stop_trace.millis();
+                skip_report = true;
+            }
             graph->run();
         }
         graph->wait();
+        wall_time_ms = measurement.millis() - excluded_ms;
+
+        if (tracing && !write_trace(*options->trace_output, graph->stop_trace())) {
+            return 1;
+        }
+
+        if (benchmark) {
+            // The reports of the last measured iterations arrive with the following runs.
+            const uint32_t iterations_in_flight = graph->get_iterations_in_flight();
+            for (uint32_t i = 0; i < iterations_in_flight; i++, runs++) {
+                graph->run();
+            }
+            graph->wait();
+        }
     } catch (const merian::VulkanException& e) {
         SPDLOG_ERROR("aborting on Vulkan error: {}", e.what());
         auto fault_ext = context->get_context_extension<merian::ExtensionDeviceFault>(true);
@@ -255,9 +401,40 @@ int main(const int argc, const char** argv) {
         return 1;
     }
 
+    if (benchmark) {
+        const nlohmann::json run_info = {
+            {"graph", config_path ? config_path->filename().string() : "default"},
+            {"version", MERIAN_VERSION},
+            {"warmup_iterations", warmup_iterations},
+            {"time_delta_ms", options->time_delta_ms.value_or(DEFAULT_BENCHMARK_TIME_DELTA_MS)},
+        };
+        if (!write_json(*options->benchmark_output,
+                        recorder.to_json(run_info, iterations, wall_time_ms))) {
+            return 1;
+        }
+        SPDLOG_INFO("wrote benchmark of {} iterations ({:.3f} ms per iteration) to {}",
+                    iterations, iterations > 0 ? wall_time_ms / iterations : 0.,
+                    options->benchmark_output->string());
+    }
     if (options->print_times) {
         fmt::print("{}", merian::Profiler::get_report_str(graph->get_run_report()));
     }
+    if (options->print_barriers) {
+        fmt::print("{}", graph->get_barrier_schedule());
+    }
+    if (options->memory_statistics_output) {
+        const std::optional<merian::MemoryStatistics::Report> report =
+            graph->get_memory_statistics();
+        if (!report) {
+            SPDLOG_ERROR("the memory allocator does not track its allocations");
+            return 1;
+        }
+        if (!write_json(*options->memory_statistics_output,
+                        merian::MemoryStatistics::to_json(*report))) {
+            return 1;
+        }
+        SPDLOG_INFO("wrote memory statistics to {}", options->memory_statistics_output->string());
+    }
 
     SPDLOG_INFO("shutting down");
     return 0;
@@ -11,19 +11,22 @@ VkImageIn::on_pre_process([[maybe_unused]] Submission& submission,
                           [[maybe_unused]] const NodeHandle& node,
                           std::vector<vk::ImageMemoryBarrier2>& image_barriers,
                           [[maybe_unused]] std::vector<vk::BufferMemoryBarrier2>& buffer_barriers) {
-    constexpr vk::AccessFlags2 all_access =
-        vk::AccessFlagBits2::eMemoryWrite | vk::AccessFlagBits2::eMemoryRead;
-    constexpr vk::PipelineStageFlags2 all_stages = vk::PipelineStageFlagBits2::eAllCommands;
-
     if (!resource) {
         return {};
     }
     const auto& res = debugable_ptr_cast<ImageArrayResource>(resource);
+    // The layer barriers order the accesses, only layout transitions need an image barrier.
+    vk::PipelineStageFlags2 stages = res->access.stages;
+    vk::AccessFlags2 access = res->access.access;
+    if (res->access.empty()) {
+        stages = vk::PipelineStageFlagBits2::eAllCommands;
+        access = vk::AccessFlagBits2::eMemoryWrite | vk::AccessFlagBits2::eMemoryRead;
+    }
     for (uint32_t i = 0; i < get_array_size(); i++) {
         const auto& image = res->get_image(i);
         if (image && image->get_current_layout() != vk::ImageLayout::eGeneral) {
-            image_barriers.push_back(image->barrier2(vk::ImageLayout::eGeneral, all_access,
-                                                     all_access, all_stages, all_stages));
+            image_barriers.push_back(
+                image->barrier2(vk::ImageLayout::eGeneral, access, access, stages, stages));
         }
     }
     return {};
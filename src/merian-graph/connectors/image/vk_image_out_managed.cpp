@@ -39,17 +39,15 @@ Connector::ConnectorStatusFlags ManagedVkImageOut::on_pre_process(
     [[maybe_unused]] const NodeHandle& node,
     std::vector<vk::ImageMemoryBarrier2>& image_barriers,
     [[maybe_unused]] std::vector<vk::BufferMemoryBarrier2>& buffer_barriers) {
-    constexpr vk::AccessFlags2 all_access =
-        vk::AccessFlagBits2::eMemoryWrite | vk::AccessFlagBits2::eMemoryRead;
-    constexpr vk::PipelineStageFlags2 all_stages = vk::PipelineStageFlagBits2::eAllCommands;
-
     const auto& res = debugable_ptr_cast<ManagedImageArrayResource>(resource);
+    // The layer barriers order the accesses, only layout transitions need an image barrier.
+    const vk::PipelineStageFlags2 stages = res->access.stages;
+    const vk::AccessFlags2 access = res->access.access;
     for (const auto& image : res->images) {
-        if (!persistent || image->get_current_layout() != vk::ImageLayout::eGeneral) {
-            image_barriers.push_back(
-                image->barrier2(vk::ImageLayout::eGeneral, all_access, all_access, all_stages,
-                                all_stages, VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED,
-                                all_levels_and_layers(), !persistent));
+        if (res->aliased || image->get_current_layout() != vk::ImageLayout::eGeneral) {
+            image_barriers.push_back(image->barrier2(
+                vk::ImageLayout::eGeneral, access, access, stages, stages, VK_QUEUE_FAMILY_IGNORED,
+                VK_QUEUE_FAMILY_IGNORED, all_levels_and_layers(), res->aliased));
         }
     }
 
@@ -66,6 +64,8 @@ GraphResourceHandle ManagedVkImageOut::create_resource(
     const ResourceAllocatorHandle alloc = persistent ? allocator : aliasing_allocator;
 
     const auto res = std::make_shared<ManagedImageArrayResource>(get_array_size());
+    res->access = combined_access;
+    res->aliased = alloc != allocator;
 
     assert(get_array_size() == create_infos.size());
     for (uint32_t i = 0; i < get_array_size(); i++) {
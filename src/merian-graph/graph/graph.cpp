@@ -37,15 +37,47 @@ Graph::Graph(const GraphCreateInfo& create_info)
                       in_flight_data.profiler_query_pool =
                           std::make_shared<merian::QueryPool<vk::QueryType::eTimestamp>>(
                               context, 1024, true);
+                      if (context->get_device()
+                              ->get_enabled_features()
+                              .get_features()
+                              .pipelineStatisticsQuery == VK_TRUE) {
+                          in_flight_data.profiler_statistics_query_pool =
+                              QueryPool<vk::QueryType::ePipelineStatistics>::create(
+                                  context, 512, true,
+                                  vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives |
+                                      vk::QueryPipelineStatisticFlagBits::eClippingPrimitives |
+                                      vk::QueryPipelineStatisticFlagBits::
+                                          eVertexShaderInvocations |
+                                      vk::QueryPipelineStatisticFlagBits::
+                                          eFragmentShaderInvocations |
+                                      vk::QueryPipelineStatisticFlagBits::
+                                          eComputeShaderInvocations);
+                      }
                       return in_flight_data;
                   }),
-      run_profiler(std::make_shared<merian::Profiler>(context)), run_info(resource_allocator) {
+      run_profiler(std::make_shared<merian::Profiler>(context)), run_info(resource_allocator),
+      parallel_run_info(resource_allocator) {
 
     debug_utils = context->get_context_extension<ExtensionVkDebugUtils>(true);
     time_connect_reference = time_reference = std::chrono::high_resolution_clock::now();
     duration_elapsed = 0ns;
     context_extension = context->get_context_extension<MerianGraphExtension>();
 
+    aliasing_memory_allocator =
+        AliasingMemoryAllocator::create(resource_allocator->get_memory_allocator());
+    aliasing_resource_allocator = std::make_shared<ResourceAllocator>(
+        context, aliasing_memory_allocator, resource_allocator->get_staging(),
+        resource_allocator->get_sampler_pool(), resource_allocator->get_descriptor_pool());
+    graph_resource_allocator = std::make_shared<ResourceAllocator>(
+        context, resource_allocator->get_memory_allocator(), resource_allocator->get_staging(),
+        resource_allocator->get_sampler_pool(), resource_allocator->get_descriptor_pool());
+    graph_resource_allocator->set_resource_pool(std::make_shared<ResourcePool>());
+
+    if (context->get_number_compute_queues() > 0) {
+        async_compute_queue = context->get_queue_C();
+        async_compute_semaphore = TimelineSemaphore::create(context);
+    }
+
     // An ImGui node sends imgui_event each frame with a Properties to render into.
     register_event_listener(
         "//", [this](const GraphEvent::Info& info, const GraphEvent::Data& data) {
@@ -112,6 +144,13 @@ void Graph::run() {
     }
 
     in_flight_data.submission->reset();
+    for (const SubmissionHandle& secondary : in_flight_data.secondary_submissions) {
+        secondary->reset();
+    }
+    // the last graphics submission of the iteration waited for the async compute queue
+    if (in_flight_data.async_submission) {
+        in_flight_data.async_submission->reset();
+    }
 
     // Compute time stuff
     assert(time_overwrite < TIME_OVERWRITE_COUNT);
@@ -141,7 +180,7 @@ void Graph::run() {
     // CONNECT and PREPROCESS
     do {
         // While connection nodes can signalize that they need to reconnect
-        while (needs_reconnect) {
+        while (get_needs_reconnect()) {
             connect();
         }
 
@@ -163,20 +202,29 @@ void Graph::run() {
         run_info.elapsed = duration_elapsed;
         run_info.elapsed_since_connect = duration_elapsed_since_connect;
 
+        parallel_run_info.iteration_semaphore = run_info.iteration_semaphore;
+        parallel_run_info.shader_object_allocator = run_info.shader_object_allocator;
+        parallel_run_info.iteration = run_info.iteration;
+        parallel_run_info.total_iteration = run_info.total_iteration;
+        parallel_run_info.in_flight_index = run_info.in_flight_index;
+        parallel_run_info.iterations_in_flight = run_info.iterations_in_flight;
+        parallel_run_info.time_delta = run_info.time_delta;
+        parallel_run_info.elapsed = run_info.elapsed;
+        parallel_run_info.elapsed_since_connect = run_info.elapsed_since_connect;
+
         // While preprocessing nodes can signalize that they need to reconnect as well
         {
             MERIAN_PROFILE_SCOPE(profiler, "Preprocess nodes");
             for (auto& layer : layers)
                 for (auto& node : layer.nodes) {
                     NodeData& data = node_data.at(node);
-                    MERIAN_PROFILE_SCOPE(profiler, fmt::format("{} ({})", data.identifier,
-                                                               registry.node_type_name(node)));
+                    MERIAN_PROFILE_SCOPE(profiler, data.profiler_section);
                     const uint32_t set_idx = data.set_index(run_iteration);
                     Node::NodeStatusFlags flags =
                         node->pre_process(data.resource_maps[set_idx], run_info);
                     if ((flags & Node::NodeStatusFlagBits::NEEDS_RECONNECT) != 0u) {
                         SPDLOG_DEBUG("node {} requested reconnect in pre_process", data.identifier);
-                        request_reconnect();
+                        request_reconnect(node);
                     }
                     if ((flags & Node::NodeStatusFlagBits::RESET_IN_FLIGHT_DATA) != 0u) {
                         in_flight_data.in_flight_data[node].reset();
@@ -186,7 +234,7 @@ void Graph::run() {
                     }
                 }
         }
-    } while (needs_reconnect);
+    } while (get_needs_reconnect());
 
     // RUN
     Submission& submission = *in_flight_data.submission;
@@ -197,27 +245,62 @@ void Graph::run() {
     }
     {
         MERIAN_PROFILE_SCOPE_GPU(profiler, submission.get_cmd(), "Run nodes");
-        for (auto& layer : layers) {
+        std::vector<PendingAsyncBatch> pending_async;
+        for (uint32_t layer_index = 0; layer_index < layers.size(); layer_index++) {
+            const Layer& layer = layers[layer_index];
+            if (!pending_async.empty()) {
+                join_async_compute(submission, layer.graphics_nodes, pending_async);
+            }
             if (layer.barrier.dstStageMask) {
                 submission.get_cmd()->barrier(layer.barrier);
             }
 
-            for (auto& node : layer.nodes) {
+            if (!layer.async_compute_nodes.empty()) {
+                MERIAN_PROFILE_SCOPE(profiler, layer.async_compute_profiler_section);
+                pending_async.emplace_back(
+                    run_async_compute_batch(in_flight_data, layer.async_compute_nodes));
+            }
+
+            if (parallel_recording && layer.graphics_nodes.size() > 1 && thread_pool->size() > 0) {
+                // GPU sections cannot be recorded concurrently, the nodes only get CPU sections
+                MERIAN_PROFILE_SCOPE_GPU(profiler, submission.get_cmd(),
+                                         layer.parallel_profiler_section);
+                const std::vector<Node::NodeStatusFlags> flags =
+                    run_layer_parallel(in_flight_data, layer.graphics_nodes, profiler);
+                for (uint32_t i = 0; i < layer.graphics_nodes.size(); i++) {
+                    const NodeHandle& node = layer.graphics_nodes[i];
+                    apply_run_node_flags(node, node_data.at(node), flags[i]);
+                }
+                continue;
+            }
+
+            for (const auto& node : layer.graphics_nodes) {
                 NodeData& data = node_data.at(node);
 
                 if (debug_utils) {
-                    const std::string node_debug_name =
-                        fmt::format("{} ({})", data.identifier, registry.node_type_name(node));
-                    debug_utils->cmd_begin_label(*submission.get_cmd(), node_debug_name);
-                    SPDLOG_TRACE("running node: {}", node_debug_name);
+                    debug_utils->cmd_begin_label(*submission.get_cmd(),
+                                                 data.profiler_section.str());
+                    SPDLOG_TRACE("running node: {}", data.profiler_section.str());
                 }
 
-                run_node(submission, node, data, profiler);
+                const Node::NodeStatusFlags flags =
+                    run_node(submission, node, data, run_info, profiler);
 
                 if (debug_utils)
                     debug_utils->cmd_end_label(*submission.get_cmd());
+
+                apply_run_node_flags(node, data, flags);
             }
         }
+
+        if (!pending_async.empty()) {
+            // the iteration (fence, iteration semaphore) finishes after the async compute work
+            submission.submit();
+            submission.add_wait_semaphore(async_compute_semaphore,
+                                          vk::PipelineStageFlagBits::eAllCommands,
+                                          async_compute_semaphore_value);
+            submission.get_cmd();
+        }
     }
 
     // FINISH RUN: submit
@@ -231,6 +314,7 @@ void Graph::run() {
 
         MERIAN_PROFILE_SCOPE(profiler, "end run");
         submission.add_signal_semaphore(iteration_semaphore, run_iteration + 1);
+        resource_allocator->get_staging()->retire_on(submission);
         submission.finish(ring_fences.reset());
     }
     {
@@ -276,6 +360,10 @@ void Graph::request_reconnect() {
     needs_reconnect = true;
 }
 
+void Graph::request_reconnect(const NodeHandle& node) {
+    reconnect_requests.insert(node);
+}
+
 void Graph::set_time_delta_overwrite(const float delta_ms) {
     time_overwrite = TIME_OVERWRITE_DELTA;
     time_delta_overwrite_ms = delta_ms;
@@ -285,6 +373,10 @@ void Graph::set_profiler_report_interval(const uint32_t millis) {
     profiler_report_intervall_ms = millis;
 }
 
+uint32_t Graph::get_iterations_in_flight() const {
+    return desired_iterations_in_flight;
+}
+
 Profiler::Report Graph::get_run_report() {
     if (!profiler_enable) {
         return {};
@@ -292,8 +384,24 @@ Profiler::Report Graph::get_run_report() {
     return run_profiler->get_report();
 }
 
+void Graph::start_trace() {
+    if (!profiler_enable) {
+        SPDLOG_WARN("profiler is disabled, cannot record a trace");
+        return;
+    }
+    run_profiler->start_trace();
+}
+
+std::vector<Profiler::TraceEvent> Graph::stop_trace() {
+    if (!run_profiler->is_tracing()) {
+        return {};
+    }
+    wait();
+    return run_profiler->stop_trace();
+}
+
 bool Graph::get_needs_reconnect() const {
-    return needs_reconnect;
+    return needs_reconnect || !reconnect_requests.empty();
 }
 
 std::ranges::keys_view<std::ranges::ref_view<const std::map<std::string, NodeHandle>>>
@@ -301,6 +409,10 @@ Graph::identifiers() {
     return std::as_const(node_for_identifier) | std::ranges::views::keys;
 }
 
+std::optional<MemoryStatistics::Report> Graph::get_memory_statistics() {
+    return resource_allocator->get_memory_allocator()->get_memory_statistics();
+}
+
 ProfilerHandle Graph::prepare_profiler_for_run(InFlightData& in_flight_data) {
     if (!profiler_enable) {
         last_run_report = {};
@@ -308,128 +420,388 @@ ProfilerHandle Graph::prepare_profiler_for_run(InFlightData& in_flight_data) {
     }
 
     auto report = run_profiler->set_collect_get_every(
-        in_flight_data.profiler_query_pool, profiler_report_intervall_ms, profiler_evict_after_ms);
+        in_flight_data.profiler_query_pool, profiler_report_intervall_ms, profiler_evict_after_ms,
+        in_flight_data.profiler_statistics_query_pool);
 
     if (report) {
         last_run_report = std::move(*report);
         cpu_time_history.set(time_history_current, last_run_report.cpu_total());
         gpu_time_history.set(time_history_current, last_run_report.gpu_total());
         time_history_current++;
+        on_run_report(last_run_report);
     }
 
     return run_profiler;
 }
 
-void Graph::run_node(Submission& submission,
-                     const NodeHandle& node,
-                     NodeData& data,
-                     [[maybe_unused]] const ProfilerHandle& profiler) {
-    const uint32_t set_idx = data.set_index(run_iteration);
+std::vector<Node::NodeStatusFlags>
+Graph::run_layer_parallel(InFlightData& in_flight_data,
+                          const std::vector<NodeHandle>& nodes,
+                          [[maybe_unused]] const ProfilerHandle& profiler) {
+    const uint32_t group_count = std::min<uint32_t>(nodes.size(), thread_pool->size() + 1);
+    while (in_flight_data.secondary_submissions.size() < group_count) {
+        in_flight_data.secondary_submissions.emplace_back(std::make_shared<Submission>(
+            context, queue, cpu_queue, vk::CommandBufferLevel::eSecondary));
+    }
 
-    MERIAN_PROFILE_SCOPE_GPU(
-        profiler, submission.get_cmd(),
-        fmt::format("{} ({})", data.identifier, registry.node_type_name(node)));
+    Submission& submission = *in_flight_data.submission;
+    std::vector<Node::NodeStatusFlags> flags(nodes.size(), 0);
 
+    // The connector callbacks modify shared resource state (layouts, input counters) and run on
+    // this thread. Their barriers are recorded in the primary before and after the layer.
     std::vector<vk::ImageMemoryBarrier2> image_barriers;
     std::vector<vk::BufferMemoryBarrier2> buffer_barriers;
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+        flags[i] |= pre_process_connectors(submission, nodes[i], node_data.at(nodes[i]),
+                                           image_barriers, buffer_barriers);
+    }
+    record_barriers(submission, image_barriers, buffer_barriers);
+
+    // nests the sections of the workers into the layer section
+    [[maybe_unused]] const uint32_t profiler_parent =
+        profiler ? profiler->get_current_section() : 0;
+    // contiguous groups keep the within-layer order when executing the secondaries in order
+    const auto record_group = [&](const uint32_t group) {
+        Submission& secondary = *in_flight_data.secondary_submissions[group];
+        const std::size_t begin = nodes.size() * group / group_count;
+        const std::size_t end = nodes.size() * (group + 1) / group_count;
+        for (std::size_t i = begin; i < end; i++) {
+            const NodeHandle& node = nodes[i];
+            NodeData& data = node_data.at(node);
+
+            if (debug_utils) {
+                debug_utils->cmd_begin_label(*secondary.get_cmd(), data.profiler_section.str());
+            }
+
+            {
+                MERIAN_PROFILE_SCOPE_IN(profiler, profiler_parent, data.profiler_section);
+                flags[i] |= process_node(secondary, node, data, parallel_run_info, nullptr);
+            }
+
+            if (debug_utils)
+                debug_utils->cmd_end_label(*secondary.get_cmd());
+        }
+    };
 
     {
-        // Call connector callbacks (pre_process) and record descriptor set updates
-        for (auto& [input, per_input_info] : data.input_connections) {
-            if (!per_input_info.node) {
-                // optional input not connected
-                continue;
+        // Nodes record GPU sections into the default profiler, hide it while recording.
+        const ScopedDefaultProfiler scoped_no_profiler{nullptr};
+
+        TaskGroup recording(*thread_pool);
+        for (uint32_t group = 1; group < group_count; group++) {
+            recording.run([&record_group, group]() { record_group(group); });
+        }
+        record_group(0);
+        // rethrows exceptions of the workers
+        recording.wait();
+    }
+
+    for (uint32_t group = 0; group < group_count; group++) {
+        in_flight_data.secondary_submissions[group]->execute_in(submission);
+    }
+
+    for (std::size_t i = 0; i < nodes.size(); i++) {
+        flags[i] |= post_process_connectors(submission, nodes[i], node_data.at(nodes[i]),
+                                            image_barriers, buffer_barriers);
+    }
+    record_barriers(submission, image_barriers, buffer_barriers);
+
+    return flags;
+}
+
+Graph::PendingAsyncBatch Graph::run_async_compute_batch(InFlightData& in_flight_data,
+                                                        const std::vector<NodeHandle>& nodes) {
+    assert(async_compute_queue);
+    Submission& submission = *in_flight_data.submission;
+    if (!in_flight_data.async_submission) {
+        in_flight_data.async_submission =
+            std::make_shared<Submission>(context, async_compute_queue, cpu_queue);
+    }
+    Submission& async_submission = *in_flight_data.async_submission;
+
+    // The batch depends on everything recorded on the graphics queue so far. Recording continues
+    // right away since open profiler scopes refer to the current command buffer.
+    submission.add_signal_semaphore(async_compute_semaphore, ++async_compute_semaphore_value);
+    submission.submit();
+    submission.get_cmd();
+
+    async_submission.add_wait_semaphore(async_compute_semaphore,
+                                        vk::PipelineStageFlagBits::eAllCommands,
+                                        async_compute_semaphore_value);
+    // orders against earlier batches on the compute queue (the layer barriers are graphics only)
+    async_submission.get_cmd()->barrier(vk::MemoryBarrier2{
+        vk::PipelineStageFlagBits2::eAllCommands, vk::AccessFlagBits2::eMemoryWrite,
+        vk::PipelineStageFlagBits2::eAllCommands,
+        vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite});
+
+    PendingAsyncBatch batch;
+    {
+        // The profiler records into the graphics command buffer.
+        const ScopedDefaultProfiler scoped_no_profiler{nullptr};
+        for (const NodeHandle& node : nodes) {
+            NodeData& data = node_data.at(node);
+            const uint32_t set_idx = data.set_index(run_iteration);
+            for (const auto& [input, per_input_info] : data.input_connections) {
+                batch.resources.insert(
+                    std::get<0>(per_input_info.precomputed_resources[set_idx]).get());
+            }
+            for (const auto& [output, per_output_info] : data.output_connections) {
+                batch.resources.insert(
+                    std::get<0>(per_output_info.precomputed_resources[set_idx]).get());
             }
 
-            auto& [resource, resource_index] = per_input_info.precomputed_resources[set_idx];
-            const Connector::ConnectorStatusFlags flags =
-                input->on_pre_process(submission, resource, node, image_barriers, buffer_barriers);
-            if ((flags & Connector::ConnectorStatusFlagBits::NEEDS_RECONNECT) != 0u) {
-                SPDLOG_DEBUG("input connector {} at node {} requested reconnect.",
-                             data.input_name_for_connector.at(input), data.identifier);
-                request_reconnect();
+            if (debug_utils) {
+                debug_utils->cmd_begin_label(*async_submission.get_cmd(),
+                                             data.profiler_section.str());
             }
+
+            const Node::NodeStatusFlags flags =
+                run_node(async_submission, node, data, parallel_run_info, nullptr);
+
+            if (debug_utils)
+                debug_utils->cmd_end_label(*async_submission.get_cmd());
+
+            apply_run_node_flags(node, data, flags);
         }
-        for (auto& [output, per_output_info] : data.output_connections) {
-            auto& [resource, resource_index] = per_output_info.precomputed_resources[set_idx];
-            const Connector::ConnectorStatusFlags flags =
-                output->on_pre_process(submission, resource, node, image_barriers, buffer_barriers);
-            if ((flags & Connector::ConnectorStatusFlagBits::NEEDS_RECONNECT) != 0u) {
-                SPDLOG_DEBUG("output connector {} at node {} requested reconnect.",
-                             data.output_name_for_connector.at(output), data.identifier);
-                request_reconnect();
+    }
+    batch.resources.erase(nullptr);
+
+    batch.value = ++async_compute_semaphore_value;
+    async_submission.add_signal_semaphore(async_compute_semaphore, batch.value);
+    async_submission.finish();
+
+    return batch;
+}
+
+void Graph::join_async_compute(Submission& submission,
+                               const std::vector<NodeHandle>& nodes,
+                               std::vector<PendingAsyncBatch>& pending) {
+    uint64_t wait_value = 0;
+    for (const NodeHandle& node : nodes) {
+        const NodeData& data = node_data.at(node);
+        const uint32_t set_idx = data.set_index(run_iteration);
+        const auto check = [&](const GraphResourceHandle& resource) {
+            for (const PendingAsyncBatch& batch : pending) {
+                if (batch.value > wait_value && batch.resources.contains(resource.get())) {
+                    wait_value = batch.value;
+                }
             }
+        };
+        for (const auto& [input, per_input_info] : data.input_connections) {
+            check(std::get<0>(per_input_info.precomputed_resources[set_idx]));
         }
+        for (const auto& [output, per_output_info] : data.output_connections) {
+            check(std::get<0>(per_output_info.precomputed_resources[set_idx]));
+        }
+    }
+    if (wait_value == 0) {
+        return;
+    }
+
+    // A wait applies to the whole batch, so only the following commands wait. Waiting for a value
+    // also covers all batches that signaled earlier values.
+    submission.submit();
+    submission.add_wait_semaphore(async_compute_semaphore, vk::PipelineStageFlagBits::eAllCommands,
+                                  wait_value);
+    submission.get_cmd();
+    std::erase_if(pending,
+                  [&](const PendingAsyncBatch& batch) { return batch.value <= wait_value; });
+}
+
+void Graph::apply_run_node_flags(const NodeHandle& node,
+                                 const NodeData& data,
+                                 const Node::NodeStatusFlags flags) {
+    if ((flags & Node::NodeStatusFlagBits::NEEDS_RECONNECT) != 0u) {
+        request_reconnect(node);
+    }
+    if ((flags & Node::NodeStatusFlagBits::REMOVE_NODE) != 0u) {
+        remove_node(data.identifier);
+    }
+}
+
+Node::NodeStatusFlags Graph::run_node(Submission& submission,
+                                      const NodeHandle& node,
+                                      NodeData& data,
+                                      const NodeProcessInfo& info,
+                                      [[maybe_unused]] const ProfilerHandle& profiler) {
+    Node::NodeStatusFlags result = 0;
+
+    MERIAN_PROFILE_SCOPE_GPU(profiler, submission.get_cmd(), data.profiler_section);
+
+    std::vector<vk::ImageMemoryBarrier2> image_barriers;
+    std::vector<vk::BufferMemoryBarrier2> buffer_barriers;
+
+    result |= pre_process_connectors(submission, node, data, image_barriers, buffer_barriers);
+    record_barriers(submission, image_barriers, buffer_barriers);
+
+    result |= process_node(submission, node, data, info, profiler);
+
+    result |= post_process_connectors(submission, node, data, image_barriers, buffer_barriers);
+    record_barriers(submission, image_barriers, buffer_barriers);
+
+    return result;
+}
+
+void Graph::record_barriers(Submission& submission,
+                            std::vector<vk::ImageMemoryBarrier2>& image_barriers,
+                            std::vector<vk::BufferMemoryBarrier2>& buffer_barriers) {
+    if (!image_barriers.empty()) {
+        submission.get_cmd()->barrier(image_barriers);
+        image_barriers.clear();
+    }
+    if (!buffer_barriers.empty()) {
+        submission.get_cmd()->barrier(buffer_barriers);
+        buffer_barriers.clear();
+    }
+}
 
-        if (!image_barriers.empty()) {
-            submission.get_cmd()->barrier(image_barriers);
-            image_barriers.clear();
+Node::NodeStatusFlags
+Graph::pre_process_connectors(Submission& submission,
+                              const NodeHandle& node,
+                              NodeData& data,
+                              std::vector<vk::ImageMemoryBarrier2>& image_barriers,
+                              std::vector<vk::BufferMemoryBarrier2>& buffer_barriers) {
+    const uint32_t set_idx = data.set_index(run_iteration);
+    Node::NodeStatusFlags result = 0;
+
+    // Call connector callbacks (pre_process) and record descriptor set updates
+    for (auto& [input, per_input_info] : data.input_connections) {
+        if (!per_input_info.node) {
+            // optional input not connected
+            continue;
         }
-        if (!buffer_barriers.empty()) {
-            submission.get_cmd()->barrier(buffer_barriers);
-            buffer_barriers.clear();
+
+        auto& [resource, resource_index] = per_input_info.precomputed_resources[set_idx];
+        const Connector::ConnectorStatusFlags flags =
+            input->on_pre_process(submission, resource, node, image_barriers, buffer_barriers);
+        if ((flags & Connector::ConnectorStatusFlagBits::NEEDS_RECONNECT) != 0u) {
+            SPDLOG_DEBUG("input connector {} at node {} requested reconnect.",
+                         data.input_name_for_connector.at(input), data.identifier);
+            result |= Node::NodeStatusFlagBits::NEEDS_RECONNECT;
+        }
+    }
+    for (auto& [output, per_output_info] : data.output_connections) {
+        auto& [resource, resource_index] = per_output_info.precomputed_resources[set_idx];
+        const Connector::ConnectorStatusFlags flags =
+            output->on_pre_process(submission, resource, node, image_barriers, buffer_barriers);
+        if ((flags & Connector::ConnectorStatusFlagBits::NEEDS_RECONNECT) != 0u) {
+            SPDLOG_DEBUG("output connector {} at node {} requested reconnect.",
+                         data.output_name_for_connector.at(output), data.identifier);
+            result |= Node::NodeStatusFlagBits::NEEDS_RECONNECT;
         }
     }
 
-    {
-        try {
-            const Node::NodeStatusFlags flags =
-                node->process(data.resource_maps[set_idx], run_info, submission);
-            if ((flags & Node::NodeStatusFlagBits::NEEDS_RECONNECT) != 0u) {
-                SPDLOG_DEBUG("node {} requested reconnect in process", data.identifier);
-                request_reconnect();
-            }
-            if ((flags & Node::NodeStatusFlagBits::REMOVE_NODE) != 0u) {
-                remove_node(data.identifier);
+    return result;
+}
+
+Node::NodeStatusFlags Graph::process_node(Submission& submission,
+                                          const NodeHandle& node,
+                                          NodeData& data,
+                                          const NodeProcessInfo& info,
+                                          [[maybe_unused]] const ProfilerHandle& profiler) {
+    const uint32_t set_idx = data.set_index(run_iteration);
+    Node::NodeStatusFlags result = 0;
+
+#ifdef MERIAN_PROFILER_ENABLE
+    // Attribute the dispatched work and the staging traffic of the node to its section.
+    // Only for serially recorded nodes (the profiler is not passed otherwise), the staging
+    // manager is shared between all nodes.
+    const StagingMemoryManagerHandle& staging = resource_allocator->get_staging();
+    const uint64_t uploaded_bytes = staging->get_uploaded_bytes();
+    const uint64_t downloaded_bytes = staging->get_downloaded_bytes();
+    // A node may submit while processing (e.g. a streamed upload). The query must end in the
+    // command buffer it began in, the statistics then only cover the commands before the submit.
+    const auto statistics_active = std::make_shared<bool>(false);
+    if (profiler) {
+        profiler->cmd_begin_statistics(submission.get_cmd());
+        *statistics_active = true;
+        submission.add_before_submit_callback([profiler, statistics_active](Submission& s) {
+            if (*statistics_active) {
+                profiler->cmd_end_statistics(s.get_cmd());
+                *statistics_active = false;
             }
-        } catch (const graph_errors::node_error& e) {
-            data.errors_queued.emplace_back(fmt::format("node error: {}", e.what()));
-        } catch (const GLSLShaderCompiler::compilation_failed& e) {
-            data.errors_queued.emplace_back(fmt::format("compilation failed: {}", e.what()));
-        }
-        if (!data.errors_queued.empty()) {
-            SPDLOG_ERROR("executing node '{}' failed:\n - {}", data.identifier,
-                         fmt::join(data.errors_queued, "\n   - "));
-            request_reconnect();
-            SPDLOG_ERROR("emergency reconnect.");
+        });
+    }
+#endif
+    const MemoryOwnerScope memory_owner{data.identifier};
+
+    try {
+        const Node::NodeStatusFlags flags =
+            node->process(data.resource_maps[set_idx], info, submission);
+        if ((flags & Node::NodeStatusFlagBits::NEEDS_RECONNECT) != 0u) {
+            SPDLOG_DEBUG("node {} requested reconnect in process", data.identifier);
         }
+        result |= flags & (Node::NodeStatusFlagBits::NEEDS_RECONNECT |
+                           Node::NodeStatusFlagBits::REMOVE_NODE);
+    } catch (const graph_errors::node_error& e) {
+        data.errors_queued.emplace_back(fmt::format("node error: {}", e.what()));
+    } catch (const GLSLShaderCompiler::compilation_failed& e) {
+        data.errors_queued.emplace_back(fmt::format("compilation failed: {}", e.what()));
+    }
+    if (!data.errors_queued.empty()) {
+        SPDLOG_ERROR("executing node '{}' failed:\n - {}", data.identifier,
+                     fmt::join(data.errors_queued, "\n   - "));
+        result |= Node::NodeStatusFlagBits::NEEDS_RECONNECT;
+        SPDLOG_ERROR("emergency reconnect.");
     }
 
-    {
-        // Call connector callbacks (post_process) and record descriptor set updates
-        for (auto& [input, per_input_info] : data.input_connections) {
-            if (!per_input_info.node) {
-                // optional input not connected
-                continue;
-            }
+#ifdef MERIAN_PROFILER_ENABLE
+    if (profiler) {
+        static const Profiler::SectionName uploaded_bytes_name = Profiler::intern("uploaded bytes");
+        static const Profiler::SectionName downloaded_bytes_name =
+            Profiler::intern("downloaded bytes");
 
-            auto& [resource, resource_index] = per_input_info.precomputed_resources[set_idx];
-            const Connector::ConnectorStatusFlags flags =
-                input->on_post_process(submission, resource, node, image_barriers, buffer_barriers);
-            if ((flags & Connector::ConnectorStatusFlagBits::NEEDS_RECONNECT) != 0u) {
-                SPDLOG_DEBUG("input connector {} at node {} requested reconnect.",
-                             data.input_name_for_connector.at(input), data.identifier);
-                request_reconnect();
-            }
+        if (*statistics_active) {
+            profiler->cmd_end_statistics(submission.get_cmd());
+            *statistics_active = false;
         }
-        for (auto& [output, per_output_info] : data.output_connections) {
-            auto& [resource, resource_index] = per_output_info.precomputed_resources[set_idx];
-            const Connector::ConnectorStatusFlags flags = output->on_post_process(
-                submission, resource, node, image_barriers, buffer_barriers);
-            if ((flags & Connector::ConnectorStatusFlagBits::NEEDS_RECONNECT) != 0u) {
-                SPDLOG_DEBUG("output connector {} at node {} requested reconnect.",
-                             data.output_name_for_connector.at(output), data.identifier);
-                request_reconnect();
-            }
+        profiler->add_section_counter(uploaded_bytes_name,
+                                      staging->get_uploaded_bytes() - uploaded_bytes);
+        profiler->add_section_counter(downloaded_bytes_name,
+                                      staging->get_downloaded_bytes() - downloaded_bytes);
+    }
+#endif
+
+    return result;
+}
+
+Node::NodeStatusFlags
+Graph::post_process_connectors(Submission& submission,
+                               const NodeHandle& node,
+                               NodeData& data,
+                               std::vector<vk::ImageMemoryBarrier2>& image_barriers,
+                               std::vector<vk::BufferMemoryBarrier2>& buffer_barriers) {
+    const uint32_t set_idx = data.set_index(run_iteration);
+    Node::NodeStatusFlags result = 0;
+
+    // Call connector callbacks (post_process) and record descriptor set updates
+    for (auto& [input, per_input_info] : data.input_connections) {
+        if (!per_input_info.node) {
+            // optional input not connected
+            continue;
         }
 
-        if (!image_barriers.empty()) {
-            submission.get_cmd()->barrier(image_barriers);
+        auto& [resource, resource_index] = per_input_info.precomputed_resources[set_idx];
+        const Connector::ConnectorStatusFlags flags =
+            input->on_post_process(submission, resource, node, image_barriers, buffer_barriers);
+        if ((flags & Connector::ConnectorStatusFlagBits::NEEDS_RECONNECT) != 0u) {
+            SPDLOG_DEBUG("input connector {} at node {} requested reconnect.",
+                         data.input_name_for_connector.at(input), data.identifier);
+            result |= Node::NodeStatusFlagBits::NEEDS_RECONNECT;
         }
-        if (!buffer_barriers.empty()) {
-            submission.get_cmd()->barrier(buffer_barriers);
+    }
+    for (auto& [output, per_output_info] : data.output_connections) {
+        auto& [resource, resource_index] = per_output_info.precomputed_resources[set_idx];
+        const Connector::ConnectorStatusFlags flags =
+            output->on_post_process(submission, resource, node, image_barriers, buffer_barriers);
+        if ((flags & Connector::ConnectorStatusFlagBits::NEEDS_RECONNECT) != 0u) {
+            SPDLOG_DEBUG("output connector {} at node {} requested reconnect.",
+                         data.output_name_for_connector.at(output), data.identifier);
+            result |= Node::NodeStatusFlagBits::NEEDS_RECONNECT;
         }
     }
+
+    return result;
 }
 
 } // namespace merian
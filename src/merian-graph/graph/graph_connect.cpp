@@ -3,6 +3,8 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <map>
+#include <set>
 #include <tuple>
 
 namespace merian {
@@ -10,6 +12,14 @@ namespace merian {
 void Graph::connect() {
     ProfilerHandle profiler = std::make_shared<Profiler>(context);
     const ScopedDefaultProfiler scoped_default_profiler{profiler};
+
+    // Only node requests can be served by rebuilding their downstream cone; anything else (edits,
+    // graph settings, failed connects) rebuilds the whole graph.
+    const bool full_reconnect = needs_reconnect || !incremental_reconnect;
+    std::unordered_set<NodeHandle> requesting_nodes;
+    std::swap(requesting_nodes, reconnect_requests);
+    std::vector<NodeHandle> rebuilt_nodes;
+    bool incremental = false;
     {
         MERIAN_PROFILE_SCOPE(profiler, "connect");
 
@@ -36,116 +46,148 @@ void Graph::connect() {
             wait();
         }
 
-        {
-            MERIAN_PROFILE_SCOPE(profiler, "reset");
-            reset_connections();
+        if (!full_reconnect) {
+            MERIAN_PROFILE_SCOPE(profiler, "connect downstream");
+            incremental = connect_downstream(requesting_nodes, rebuilt_nodes);
+            if (!incremental) {
+                SPDLOG_DEBUG("cannot reconnect incrementally, reconnecting the whole graph");
+                rebuilt_nodes.clear();
+            }
         }
 
-        std::vector<NodeHandle> topology;
-        {
-            MERIAN_PROFILE_SCOPE(profiler, "connect nodes");
-            /*
-             * The connetion procedure works roughtly as follows:
-             * - while not all nodes were visited
-             *      - check if nodes must be disabled (required inputs cannot be satisfied)
-             *      - search nodes that are satisfied
-             *      - connect those nodes outputs with inputs
-             * - check if nodes must be disabled because of dependencies on backward edges are
-             * not satisfied
-             * - cleanup output connections to disabled nodes
-             * - call on_connect callbacks on the connectors
-             */
-            if (!connect_nodes(topology)) {
-                SPDLOG_WARN(
-                    "Connecting nodes failed :( But attempted self healing. Retry, please!");
-                needs_reconnect = true;
-                return;
+        if (!incremental) {
+            {
+                MERIAN_PROFILE_SCOPE(profiler, "reset");
+                reset_connections();
             }
-        }
 
-        {
-            MERIAN_PROFILE_SCOPE(profiler, "build layers");
-            build_layers(topology);
-        }
+            std::vector<NodeHandle> topology;
+            {
+                MERIAN_PROFILE_SCOPE(profiler, "connect nodes");
+                /*
+                 * The connetion procedure works roughtly as follows:
+                 * - while not all nodes were visited
+                 *      - check if nodes must be disabled (required inputs cannot be satisfied)
+                 *      - search nodes that are satisfied
+                 *      - connect those nodes outputs with inputs
+                 * - check if nodes must be disabled because of dependencies on backward edges
+                 * are not satisfied
+                 * - cleanup output connections to disabled nodes
+                 * - call on_connect callbacks on the connectors
+                 */
+                if (!connect_nodes(topology)) {
+                    SPDLOG_WARN(
+                        "Connecting nodes failed :( But attempted self healing. Retry, please!");
+                    needs_reconnect = true;
+                    return;
+                }
+            }
 
-        {
-            MERIAN_PROFILE_SCOPE(profiler, "allocate resources");
-            allocate_resources();
-        }
+            {
+                MERIAN_PROFILE_SCOPE(profiler, "build layers");
+                build_layers(topology);
+            }
 
-        {
-            MERIAN_PROFILE_SCOPE(profiler, "precompute resources");
-            precompute_resources();
+            {
+                MERIAN_PROFILE_SCOPE(profiler, "allocate resources");
+                allocate_resources();
+            }
+
+            {
+                MERIAN_PROFILE_SCOPE(profiler, "build barriers");
+                build_barriers();
+            }
+
+            {
+                MERIAN_PROFILE_SCOPE(profiler, "precompute resources");
+                precompute_resources();
+            }
+
+            for (const auto& layer : layers) {
+                rebuilt_nodes.insert(rebuilt_nodes.end(), layer.nodes.begin(), layer.nodes.end());
+            }
         }
 
+        // once per connect, also if the incremental reconnect fell back to a full one
+        graph_resource_allocator->get_resource_pool()->age();
+
         {
             MERIAN_PROFILE_SCOPE(profiler, "on_connected");
-            Submission submission(context, queue, cpu_queue);
-            for (const auto& layer : layers)
-                for (const NodeHandle& node : layer.nodes) {
-                    for (auto& [output, per_output_info] : node_data.at(node).output_connections) {
-                        std::vector<GraphResourceHandle> resources;
-                        resources.reserve(per_output_info.resources.size());
-                        for (const auto& per_resource : per_output_info.resources) {
-                            resources.push_back(per_resource.resource);
-                        }
-                        output->on_connected(submission, resources);
-                    }
-                }
-
-            for (auto& layer : layers)
-                for (auto& node : layer.nodes) {
-                    NodeData& data = node_data.at(node);
-                    MERIAN_PROFILE_SCOPE(profiler, fmt::format("{} ({})", data.identifier,
-                                                               registry.node_type_name(node)));
-                    SPDLOG_DEBUG("on_connected node: {} ({})", data.identifier,
-                                 registry.node_type_name(node));
-                    const NodeIOLayout io_layout(this, &data, node, /*allow_delayed*/ true);
-                    const NodeIO io(this, &data, node, data.set_index(0));
-                    try {
-                        const Node::NodeStatusFlags flags = node->on_connected(
-                            io_layout, io, NodeConnectionInfo{ring_fences.size()}, submission);
-                        needs_reconnect |= flags & Node::NodeStatusFlagBits::NEEDS_RECONNECT;
-                        if ((flags & Node::NodeStatusFlagBits::RESET_IN_FLIGHT_DATA) != 0u) {
-                            for (uint32_t i = 0; i < ring_fences.size(); i++) {
-                                ring_fences.get(i).user_data.in_flight_data.at(node).reset();
-                            }
-                        }
-                        if ((flags & Node::NodeStatusFlagBits::REMOVE_NODE) != 0u) {
-                            remove_node(data.identifier);
-                        }
-                    } catch (const graph_errors::node_error& e) {
-                        data.errors_queued.emplace_back(fmt::format("node error: {}", e.what()));
-                    } catch (const GLSLShaderCompiler::compilation_failed& e) {
-                        data.errors_queued.emplace_back(
-                            fmt::format("compilation failed: {}", e.what()));
-                    }
-                    if (!data.errors_queued.empty()) {
-                        SPDLOG_ERROR("on_connected on node '{}' failed:\n - {}", data.identifier,
-                                     fmt::join(data.errors_queued, "\n   - "));
-                        request_reconnect();
-                        SPDLOG_ERROR("emergency reconnect.");
-                    }
-                }
-
-            submission.finish();
-            queue->wait_idle();
+            call_on_connected(rebuilt_nodes, profiler);
         }
     }
 
-    {
+    if (!incremental) {
+        // listeners of nodes that were not rebuilt stay registered
         MERIAN_PROFILE_SCOPE(profiler, "register user event listener");
         for (const auto& [event_pattern, event_listener] : user_event_pattern_listener) {
             register_event_listener_for_connect(event_pattern, event_listener);
         }
     }
 
+    SPDLOG_DEBUG("rebuilt {} nodes ({})", rebuilt_nodes.size(),
+                 incremental ? "incremental" : "full");
+    profiler->set_counter("rebuilt nodes", rebuilt_nodes.size());
+
     run_iteration = 0;
     last_build_report = profiler->get_report();
     time_connect_reference = std::chrono::high_resolution_clock::now();
     duration_elapsed_since_connect = 0ns;
 }
 
+void Graph::call_on_connected(const std::vector<NodeHandle>& nodes,
+                              [[maybe_unused]] const ProfilerHandle& profiler) {
+    Submission submission(context, queue, cpu_queue);
+    for (const NodeHandle& node : nodes) {
+        const MemoryOwnerScope memory_owner{node_data.at(node).identifier};
+        for (auto& [output, per_output_info] : node_data.at(node).output_connections) {
+            std::vector<GraphResourceHandle> resources;
+            resources.reserve(per_output_info.resources.size());
+            for (const auto& per_resource : per_output_info.resources) {
+                resources.push_back(per_resource.resource);
+            }
+            output->on_connected(submission, resources);
+        }
+    }
+
+    for (const NodeHandle& node : nodes) {
+        NodeData& data = node_data.at(node);
+        MERIAN_PROFILE_SCOPE(profiler, data.profiler_section);
+        const MemoryOwnerScope memory_owner{data.identifier};
+        SPDLOG_DEBUG("on_connected node: {} ({})", data.identifier, registry.node_type_name(node));
+        const NodeIOLayout io_layout(this, &data, node, /*allow_delayed*/ true);
+        const NodeIO io(this, &data, node, data.set_index(0));
+        try {
+            const Node::NodeStatusFlags flags = node->on_connected(
+                io_layout, io, NodeConnectionInfo{ring_fences.size()}, submission);
+            if ((flags & Node::NodeStatusFlagBits::NEEDS_RECONNECT) != 0u) {
+                request_reconnect(node);
+            }
+            if ((flags & Node::NodeStatusFlagBits::RESET_IN_FLIGHT_DATA) != 0u) {
+                for (uint32_t i = 0; i < ring_fences.size(); i++) {
+                    ring_fences.get(i).user_data.in_flight_data.at(node).reset();
+                }
+            }
+            if ((flags & Node::NodeStatusFlagBits::REMOVE_NODE) != 0u) {
+                remove_node(data.identifier);
+            }
+        } catch (const graph_errors::node_error& e) {
+            data.errors_queued.emplace_back(fmt::format("node error: {}", e.what()));
+        } catch (const GLSLShaderCompiler::compilation_failed& e) {
+            data.errors_queued.emplace_back(fmt::format("compilation failed: {}", e.what()));
+        }
+        if (!data.errors_queued.empty()) {
+            SPDLOG_ERROR("on_connected on node '{}' failed:\n - {}", data.identifier,
+                         fmt::join(data.errors_queued, "\n   - "));
+            request_reconnect();
+            SPDLOG_ERROR("emergency reconnect.");
+        }
+    }
+
+    submission.finish();
+    queue->wait_idle();
+}
+
 void Graph::reset_connections() {
     SPDLOG_DEBUG("reset connections");
 
@@ -154,38 +196,17 @@ void Graph::reset_connections() {
     for (auto& [node, data] : node_data) {
         data.reset();
     }
+    // keep the released resources for the next allocate_resources()
+    graph_resource_allocator->get_resource_pool()->release_unused();
+    // heaps are freed with the last resource placed into them
+    aliasing_memory_allocator->reset();
+    aliasing_owners.clear();
     event_listeners.clear();
 }
 
 bool Graph::cache_node_input_connectors() {
     for (auto& [node, data] : node_data) {
-        // Cache input connectors in node_data and check that there are no name conflicts.
-        try {
-            auto input_descriptors = node->describe_inputs();
-            for (const auto& desc : input_descriptors) {
-                data.input_connectors.push_back(desc.connector);
-                if (data.input_connector_for_name.contains(desc.name)) {
-                    throw graph_errors::connector_error{
-                        fmt::format("node {} contains two input connectors with the same name {}",
-                                    registry.node_type_name(node), desc.name)};
-                }
-                data.input_connector_for_name[desc.name] = desc.connector;
-                data.input_name_for_connector[desc.connector] = desc.name;
-                data.connector_access[desc.connector] = desc.access;
-                data.input_delay[desc.connector] = desc.delay;
-                data.input_optional[desc.connector] = desc.optional;
-                data.bind_field_name[desc.connector] = "in_" + desc.name;
-            }
-        } catch (const graph_errors::node_error& e) {
-            data.errors.emplace_back(fmt::format("node error: {}", e.what()));
-        } catch (const GLSLShaderCompiler::compilation_failed& e) {
-            data.errors.emplace_back(fmt::format("compilation failed: {}", e.what()));
-        }
-        if (!data.errors.empty()) {
-            SPDLOG_ERROR("node '{}' ({}) failed to describe its inputs and is disabled:\n - {}",
-                         data.identifier, registry.node_type_name(node),
-                         fmt::join(data.errors, "\n   - "));
-        }
+        cache_node_input_connectors(node, data);
     }
 
     // Store connectors that might be connected (there may still be an invalid connection...)
@@ -230,6 +251,36 @@ bool Graph::cache_node_input_connectors() {
     return true;
 }
 
+void Graph::cache_node_input_connectors(const NodeHandle& node, NodeData& data) {
+    // Cache input connectors in node_data and check that there are no name conflicts.
+    try {
+        auto input_descriptors = node->describe_inputs();
+        for (const auto& desc : input_descriptors) {
+            data.input_connectors.push_back(desc.connector);
+            if (data.input_connector_for_name.contains(desc.name)) {
+                throw graph_errors::connector_error{
+                    fmt::format("node {} contains two input connectors with the same name {}",
+                                registry.node_type_name(node), desc.name)};
+            }
+            data.input_connector_for_name[desc.name] = desc.connector;
+            data.input_name_for_connector[desc.connector] = desc.name;
+            data.connector_access[desc.connector] = desc.access;
+            data.input_delay[desc.connector] = desc.delay;
+            data.input_optional[desc.connector] = desc.optional;
+            data.bind_field_name[desc.connector] = "in_" + desc.name;
+        }
+    } catch (const graph_errors::node_error& e) {
+        data.errors.emplace_back(fmt::format("node error: {}", e.what()));
+    } catch (const GLSLShaderCompiler::compilation_failed& e) {
+        data.errors.emplace_back(fmt::format("compilation failed: {}", e.what()));
+    }
+    if (!data.errors.empty()) {
+        SPDLOG_ERROR("node '{}' ({}) failed to describe its inputs and is disabled:\n - {}",
+                     data.identifier, registry.node_type_name(node),
+                     fmt::join(data.errors, "\n   - "));
+    }
+}
+
 void Graph::cache_node_output_connectors(const NodeHandle& node, NodeData& data) {
     try {
         auto output_descriptors =
@@ -622,106 +673,350 @@ bool Graph::connect_nodes(std::vector<NodeHandle>& topology) {
     return true;
 }
 
+bool Graph::connect_downstream(const std::unordered_set<NodeHandle>& requesting_nodes,
+                               std::vector<NodeHandle>& cone_topology) {
+    if (layers.empty()) {
+        return false;
+    }
+
+    // The requesting nodes and all nodes that consume their outputs, transitively.
+    std::unordered_set<NodeHandle> cone;
+    std::vector<NodeHandle> stack(requesting_nodes.begin(), requesting_nodes.end());
+    while (!stack.empty()) {
+        const NodeHandle node = stack.back();
+        stack.pop_back();
+        if (!cone.insert(node).second) {
+            continue;
+        }
+        const NodeData& data = node_data.at(node);
+        if (data.resource_maps.empty()) {
+            // not part of the current topology (disabled, erroneous,...)
+            return false;
+        }
+        const bool async = async_compute && async_compute_queue &&
+                           node->get_queue_affinity() == Node::QueueAffinity::ASYNC_COMPUTE;
+        if (data.async_compute != async) {
+            // changes the queue family sharing of all graph resources
+            return false;
+        }
+        for (const auto& [output, per_output_info] : data.output_connections) {
+            for (const auto& [dst_node, dst_input] : per_output_info.inputs) {
+                stack.push_back(dst_node);
+            }
+        }
+    }
+    for (const auto& layer : layers) {
+        for (const NodeHandle& node : layer.nodes) {
+            if (cone.contains(node)) {
+                cone_topology.push_back(node);
+            }
+        }
+    }
+    SPDLOG_DEBUG("reconnecting {} nodes downstream of {} requesting nodes", cone_topology.size(),
+                 requesting_nodes.size());
+
+    // --- Remember the wiring by name, the connectors are described again ---
+    // From here on a failure leaves the graph inconsistent, the caller must reconnect fully.
+    struct InputState {
+        uint32_t delay;
+        bool optional;
+        ConnectorAccess access;
+        // nullptr for unconnected optional inputs
+        NodeHandle src;
+        std::string src_output;
+    };
+    struct NodeState {
+        std::map<std::string, InputState> inputs;
+        std::set<std::string> outputs;
+        std::set<std::string> disabled_outputs;
+    };
+    std::unordered_map<NodeHandle, NodeState> old_state;
+    for (const NodeHandle& node : cone_topology) {
+        NodeData& data = node_data.at(node);
+        NodeState& state = old_state[node];
+        for (const auto& [input, per_input_info] : data.input_connections) {
+            InputState& input_state = state.inputs[data.input_name_for_connector.at(input)];
+            input_state = InputState{data.input_delay.at(input), data.input_optional.at(input),
+                                     data.connector_access.at(input), per_input_info.node, {}};
+            if (!per_input_info.node) {
+                continue;
+            }
+            NodeData& src_data = node_data.at(per_input_info.node);
+            input_state.src_output = src_data.output_name_for_connector.at(per_input_info.output);
+            if (!cone.contains(per_input_info.node)) {
+                // reconnected below with the new input connector
+                std::erase(src_data.output_connections.at(per_input_info.output).inputs,
+                           std::make_tuple(node, input));
+            }
+        }
+        for (const auto& [output, name] : data.output_name_for_connector) {
+            state.outputs.insert(name);
+            if (data.disabled_outputs.contains(output)) {
+                state.disabled_outputs.insert(name);
+            }
+        }
+    }
+
+    remove_event_listeners(cone);
+    for (const NodeHandle& node : cone_topology) {
+        node_data.at(node).reset();
+    }
+    graph_resource_allocator->get_resource_pool()->release_unused();
+    // The memory of released transient resources is not reused until the next full reconnect.
+    for (auto& owner : aliasing_owners) {
+        if (owner.first && cone.contains(owner.first)) {
+            owner = {};
+        }
+    }
+
+    const auto connect_input = [&](const NodeHandle& node, NodeData& data,
+                                   const InputConnectorHandle& input, const InputState& state) {
+        NodeData& src_data = node_data.at(state.src);
+        const auto output = src_data.output_connector_for_name.find(state.src_output);
+        if (output == src_data.output_connector_for_name.end() ||
+            (state.delay > 0 && !output->second->supports_delay)) {
+            return false;
+        }
+        data.input_connections.try_emplace(input,
+                                           NodeData::PerInputInfo{state.src, output->second});
+        src_data.output_connections.at(output->second).inputs.emplace_back(node, input);
+        return true;
+    };
+
+    // --- Describe again in topological order with the same wiring ---
+    for (const NodeHandle& node : cone_topology) {
+        NodeData& data = node_data.at(node);
+        const NodeState& state = old_state.at(node);
+
+        cache_node_input_connectors(node, data);
+        if (!data.errors.empty() || data.input_connectors.size() != state.inputs.size()) {
+            return false;
+        }
+        for (const InputConnectorHandle& input : data.input_connectors) {
+            const auto it = state.inputs.find(data.input_name_for_connector.at(input));
+            if (it == state.inputs.end() || it->second.delay != data.input_delay.at(input) ||
+                it->second.optional != data.input_optional.at(input)) {
+                return false;
+            }
+            const InputState& input_state = it->second;
+            if (!input_state.src) {
+                data.input_connections.try_emplace(input, NodeData::PerInputInfo());
+                continue;
+            }
+            if (!cone.contains(input_state.src) &&
+                input_state.access != data.connector_access.at(input)) {
+                // the resources of the producer were created for the old access
+                return false;
+            }
+            // delayed inputs may come from nodes that were not described yet
+            if (input_state.delay == 0 && !connect_input(node, data, input, input_state)) {
+                return false;
+            }
+        }
+
+        cache_node_output_connectors(node, data);
+        if (!data.errors.empty()) {
+            return false;
+        }
+        std::set<std::string> outputs;
+        std::set<std::string> disabled_outputs;
+        for (const auto& [output, name] : data.output_name_for_connector) {
+            outputs.insert(name);
+            if (data.disabled_outputs.contains(output)) {
+                disabled_outputs.insert(name);
+            }
+        }
+        if (outputs != state.outputs || disabled_outputs != state.disabled_outputs) {
+            return false;
+        }
+    }
+    for (const NodeHandle& node : cone_topology) {
+        NodeData& data = node_data.at(node);
+        for (const InputConnectorHandle& input : data.input_connectors) {
+            const InputState& input_state =
+                old_state.at(node).inputs.at(data.input_name_for_connector.at(input));
+            if (input_state.src && input_state.delay > 0 &&
+                !connect_input(node, data, input, input_state)) {
+                return false;
+            }
+        }
+    }
+
+    // --- Connector callbacks, every edge into the cone ---
+    for (const NodeHandle& node : cone_topology) {
+        NodeData& data = node_data.at(node);
+        for (const auto& [input, per_input_info] : data.input_connections) {
+            if (!per_input_info.node) {
+                continue;
+            }
+            try {
+                per_input_info.output->on_connect_input(input);
+                input->on_connect_output(per_input_info.output);
+            } catch (const graph_errors::invalid_connection& e) {
+                SPDLOG_ERROR("Removing invalid connection {}, {} -> {}, {}. Reason: {}",
+                             node_data.at(per_input_info.node).identifier,
+                             node_data.at(per_input_info.node)
+                                 .output_name_for_connector.at(per_input_info.output),
+                             data.identifier, data.input_name_for_connector.at(input), e.what());
+                remove_connection(per_input_info.node, node,
+                                  data.input_name_for_connector.at(input));
+                return false;
+            }
+        }
+    }
+
+    // --- Resources of the cone only, the levels did not change ---
+    for (const NodeHandle& node : cone_topology) {
+        allocate_node_resources(node, node_data.at(node), /*alias_transient*/ false);
+    }
+    for (const NodeHandle& node : cone_topology) {
+        precompute_node_resources(node, node_data.at(node));
+    }
+    build_barriers();
+
+    return true;
+}
+
 void Graph::allocate_resources() {
-    for (const auto& layer : layers)
+    for (const auto& layer : layers) {
         for (const auto& node : layer.nodes) {
-            auto& data = node_data.at(node);
-            for (auto& [output, per_output_info] : data.output_connections) {
-                uint32_t max_delay = 0;
-                for (auto& input : per_output_info.inputs) {
-                    max_delay = std::max(
-                        max_delay,
-                        node_data.at(std::get<0>(input)).input_delay.at(std::get<1>(input)));
-                }
+            allocate_node_resources(node, node_data.at(node), alias_transient_resources);
+        }
+    }
 
-                const std::string& output_name = data.output_name_for_connector.at(output);
+    SPDLOG_DEBUG("placed {} transient allocations ({}) into {} aliasing heaps ({})",
+                 aliasing_memory_allocator->get_placement_count(),
+                 format_size(aliasing_memory_allocator->get_requested_size()),
+                 aliasing_memory_allocator->get_heap_count(),
+                 format_size(aliasing_memory_allocator->get_heap_size()));
+}
 
-                SPDLOG_DEBUG("creating, connecting and allocating {} resources for output {} on "
-                             "node {} ({})",
-                             max_delay + 1, output_name, data.identifier,
-                             registry.node_type_name(node));
-                ConnectorAccess combined_access = data.connector_access.at(output);
-                for (const auto& [input_node, input] : per_output_info.inputs) {
-                    combined_access =
-                        combined_access | node_data.at(input_node).connector_access.at(input);
-                }
+void Graph::allocate_node_resources(const NodeHandle& node,
+                                    NodeData& data,
+                                    const bool alias_transient) {
+    const MemoryOwnerScope memory_owner{data.identifier};
+    for (auto& [output, per_output_info] : data.output_connections) {
+        uint32_t max_delay = 0;
+        for (auto& input : per_output_info.inputs) {
+            max_delay = std::max(
+                max_delay, node_data.at(std::get<0>(input)).input_delay.at(std::get<1>(input)));
+        }
 
-                for (uint32_t i = 0; i <= max_delay; i++) {
-                    const GraphResourceHandle res = output->create_resource(
-                        per_output_info.inputs, combined_access, resource_allocator,
-                        resource_allocator, i, ring_fences.size());
-                    per_output_info.resources.emplace_back(res);
-                }
-            }
+        const std::string& output_name = data.output_name_for_connector.at(output);
+
+        SPDLOG_DEBUG("creating, connecting and allocating {} resources for output {} on "
+                     "node {} ({})",
+                     max_delay + 1, output_name, data.identifier, registry.node_type_name(node));
+        ConnectorAccess combined_access = data.connector_access.at(output);
+        uint32_t last_level = data.level;
+        bool accessed_async = data.async_compute;
+        for (const auto& [input_node, input] : per_output_info.inputs) {
+            combined_access = combined_access | node_data.at(input_node).connector_access.at(input);
+            last_level = std::max(last_level, node_data.at(input_node).level);
+            accessed_async |= node_data.at(input_node).async_compute;
+        }
+
+        // Without delayed readers the contents are dead after the last consuming layer.
+        // build_barriers orders all accesses of an output before the first access of an output
+        // that is placed into the same memory, so outputs with disjoint layer intervals can share
+        // memory. The async compute queue is not ordered by the layer barriers.
+        const bool transient = alias_transient && max_delay == 0 && !accessed_async;
+        if (transient) {
+            aliasing_memory_allocator->set_lifetime(
+                AliasingMemoryAllocator::Lifetime{data.level, last_level}, aliasing_owners.size());
+            aliasing_owners.emplace_back(node, output);
+        }
+        const ResourceAllocatorHandle& aliasing_allocator =
+            transient ? aliasing_resource_allocator : graph_resource_allocator;
+
+        // Outputs that are produced or consumed on the async compute queue are shared between the
+        // queue families instead of transferring their ownership. All others stay exclusive, which
+        // keeps compression and optimal layouts.
+        std::vector<uint32_t> sharing_families;
+        if (accessed_async && async_compute_queue &&
+            async_compute_queue->get_queue_family_index() != queue->get_queue_family_index()) {
+            sharing_families = {queue->get_queue_family_index(),
+                                async_compute_queue->get_queue_family_index()};
+        }
+        graph_resource_allocator->set_concurrent_sharing(sharing_families);
+
+        for (uint32_t i = 0; i <= max_delay; i++) {
+            const GraphResourceHandle res = output->create_resource(
+                per_output_info.inputs, combined_access, graph_resource_allocator,
+                aliasing_allocator, i, ring_fences.size());
+            per_output_info.resources.emplace_back(res);
         }
+        aliasing_memory_allocator->set_lifetime(std::nullopt);
+        graph_resource_allocator->set_concurrent_sharing({});
+    }
 }
 
 void Graph::precompute_resources() {
-    for (auto& layer : layers)
-        for (auto& dst_node : layer.nodes) {
-            auto& dst_data = node_data.at(dst_node);
-
-            // --- FIND NUMBER OF RESOURCE COMBINATIONS ---
-            // the lowest number of per-iteration resource maps needed (delayed accesses cycle).
-            std::vector<uint32_t> num_resources;
-            // ... number of resources in the corresponding outputs for own inputs
-            for (auto& [dst_input, per_input_info] : dst_data.input_connections) {
-                if (!per_input_info.node) {
-                    // optional input is not connected
-                    continue;
-                }
-                num_resources.push_back(node_data.at(per_input_info.node)
-                                            .output_connections[per_input_info.output]
-                                            .resources.size());
-            }
-            // ... number of resources in own outputs
-            for (auto& [_, per_output_info] : dst_data.output_connections) {
-                num_resources.push_back(per_output_info.resources.size());
-            }
-
-            uint32_t num_sets = std::max(lcm(num_resources), ring_fences.size());
-            // make sure it is at least RING_SIZE to allow updates while iterations are in-flight
-            // solve k * num_sets >= RING_SIZE
-            const uint32_t k = (ring_fences.size() + num_sets - 1) / num_sets;
-            num_sets *= k;
-
-            SPDLOG_DEBUG("needing {} resource maps for node {} ({})", num_sets, dst_data.identifier,
-                         registry.node_type_name(dst_node));
-
-            // --- PRECOMPUTE RESOURCES for each iteration ---
-            for (uint32_t set_idx = 0; set_idx < num_sets; set_idx++) {
-                // precompute resources for inputs
-                for (auto& [input, per_input_info] : dst_data.input_connections) {
-                    if (!per_input_info.node) {
-                        // optional input not connected
-                        per_input_info.precomputed_resources.emplace_back(nullptr, -1ul);
-                    } else {
-                        NodeData& src_data = node_data.at(per_input_info.node);
-                        assert(src_data.errors.empty());
-                        assert(src_data.enabled && !src_data.unsupported);
-                        auto& resources =
-                            src_data.output_connections.at(per_input_info.output).resources;
-                        const uint32_t num_resources = resources.size();
-                        const uint32_t resource_index =
-                            (set_idx + num_resources - dst_data.input_delay.at(input)) %
-                            num_resources;
-                        auto& resource = resources[resource_index];
-                        per_input_info.precomputed_resources.emplace_back(resource.resource,
-                                                                          resource_index);
-                    }
-                }
-                // precompute resources for outputs
-                for (auto& [_, per_output_info] : dst_data.output_connections) {
-                    const uint32_t resource_index = set_idx % per_output_info.resources.size();
-                    auto& resource = per_output_info.resources[resource_index];
-                    per_output_info.precomputed_resources.emplace_back(resource.resource,
-                                                                       resource_index);
-                }
+    for (auto& layer : layers) {
+        for (auto& node : layer.nodes) {
+            precompute_node_resources(node, node_data.at(node));
+        }
+    }
+}
+
+void Graph::precompute_node_resources(const NodeHandle& dst_node, NodeData& dst_data) {
+    // --- FIND NUMBER OF RESOURCE COMBINATIONS ---
+    // the lowest number of per-iteration resource maps needed (delayed accesses cycle).
+    std::vector<uint32_t> num_resources;
+    // ... number of resources in the corresponding outputs for own inputs
+    for (auto& [dst_input, per_input_info] : dst_data.input_connections) {
+        if (!per_input_info.node) {
+            // optional input is not connected
+            continue;
+        }
+        num_resources.push_back(node_data.at(per_input_info.node)
+                                    .output_connections[per_input_info.output]
+                                    .resources.size());
+    }
+    // ... number of resources in own outputs
+    for (auto& [_, per_output_info] : dst_data.output_connections) {
+        num_resources.push_back(per_output_info.resources.size());
+    }
 
-                // precompute resource maps
-                dst_data.resource_maps.emplace_back(this, &dst_data, dst_node, set_idx);
+    uint32_t num_sets = std::max(lcm(num_resources), ring_fences.size());
+    // make sure it is at least RING_SIZE to allow updates while iterations are in-flight
+    // solve k * num_sets >= RING_SIZE
+    const uint32_t k = (ring_fences.size() + num_sets - 1) / num_sets;
+    num_sets *= k;
+
+    SPDLOG_DEBUG("needing {} resource maps for node {} ({})", num_sets, dst_data.identifier,
+                 registry.node_type_name(dst_node));
+
+    // --- PRECOMPUTE RESOURCES for each iteration ---
+    for (uint32_t set_idx = 0; set_idx < num_sets; set_idx++) {
+        // precompute resources for inputs
+        for (auto& [input, per_input_info] : dst_data.input_connections) {
+            if (!per_input_info.node) {
+                // optional input not connected
+                per_input_info.precomputed_resources.emplace_back(nullptr, -1ul);
+            } else {
+                NodeData& src_data = node_data.at(per_input_info.node);
+                assert(src_data.errors.empty());
+                assert(src_data.enabled && !src_data.unsupported);
+                auto& resources = src_data.output_connections.at(per_input_info.output).resources;
+                const uint32_t num_resources = resources.size();
+                const uint32_t resource_index =
+                    (set_idx + num_resources - dst_data.input_delay.at(input)) % num_resources;
+                auto& resource = resources[resource_index];
+                per_input_info.precomputed_resources.emplace_back(resource.resource,
+                                                                  resource_index);
             }
         }
+        // precompute resources for outputs
+        for (auto& [_, per_output_info] : dst_data.output_connections) {
+            const uint32_t resource_index = set_idx % per_output_info.resources.size();
+            auto& resource = per_output_info.resources[resource_index];
+            per_output_info.precomputed_resources.emplace_back(resource.resource, resource_index);
+        }
+
+        // precompute resource maps
+        dst_data.resource_maps.emplace_back(this, &dst_data, dst_node, set_idx);
+    }
 }
 
 void Graph::build_layers(const std::vector<NodeHandle>& topology) {
@@ -744,6 +1039,12 @@ void Graph::build_layers(const std::vector<NodeHandle>& topology) {
     for (const NodeHandle& node : topology) {
         layers[node_data.at(node).level].nodes.push_back(node);
     }
+    for (uint32_t layer_index = 0; layer_index < layer_count; layer_index++) {
+        layers[layer_index].parallel_profiler_section =
+            Profiler::intern(fmt::format("layer {} (parallel)", layer_index));
+        layers[layer_index].async_compute_profiler_section =
+            Profiler::intern(fmt::format("layer {} (async compute)", layer_index));
+    }
 
     // deterministic within-layer order: user linearization_order, ties by identifier
     for (auto& layer : layers) {
@@ -754,45 +1055,148 @@ void Graph::build_layers(const std::vector<NodeHandle>& topology) {
                       return std::tie(data_a.linearization_order, data_a.identifier) <
                              std::tie(data_b.linearization_order, data_b.identifier);
                   });
+
+        for (const NodeHandle& node : layer.nodes) {
+            NodeData& data = node_data.at(node);
+            data.async_compute = async_compute && async_compute_queue &&
+                                 node->get_queue_affinity() == Node::QueueAffinity::ASYNC_COMPUTE;
+            if (data.async_compute) {
+                layer.async_compute_nodes.push_back(node);
+            } else {
+                layer.graphics_nodes.push_back(node);
+            }
+        }
     }
+}
 
-    struct Masks {
-        vk::PipelineStageFlags2 stages;
-        vk::AccessFlags2 access;
-        vk::AccessFlags2 write_access;
+void Graph::build_barriers() {
+    struct Access {
+        uint32_t level;
+        ConnectorAccess access;
+        std::string name;
+    };
+    // accesses to the resources of each output within one iteration (delayed reads excluded)
+    std::unordered_map<OutputConnectorHandle, std::vector<Access>> accesses;
+    const auto write_access = [](const ConnectorAccess& access) {
+        return access.is_write() ? access.access : vk::AccessFlags2{};
     };
-    std::vector<Masks> masks(layer_count);
-    Masks all{};
-    for (uint32_t l = 0; l < layer_count; l++) {
-        for (const NodeHandle& node : layers[l].nodes) {
-            for (const auto& [connector, access] : node_data.at(node).connector_access) {
-                masks[l].stages |= access.stages;
-                masks[l].access |= access.access;
-                if (access.is_write()) {
-                    masks[l].write_access |= access.access;
+
+    // also called again for an incremental reconnect
+    for (Layer& layer : layers) {
+        layer.barrier = vk::MemoryBarrier2{};
+        layer.dependencies.clear();
+    }
+
+    ConnectorAccess all{};
+    vk::AccessFlags2 all_write_access{};
+    for (const auto& layer : layers) {
+        for (const NodeHandle& node : layer.nodes) {
+            const NodeData& data = node_data.at(node);
+            for (const auto& [output, per_output_info] : data.output_connections) {
+                std::vector<Access>& output_accesses = accesses[output];
+                output_accesses.push_back(Access{
+                    data.level, data.connector_access.at(output),
+                    fmt::format("{}/{}", data.identifier,
+                                data.output_name_for_connector.at(output))});
+                for (const auto& [input_node, input] : per_output_info.inputs) {
+                    const NodeData& input_data = node_data.at(input_node);
+                    if (input_data.input_delay.at(input) > 0) {
+                        continue;
+                    }
+                    output_accesses.push_back(Access{
+                        input_data.level, input_data.connector_access.at(input),
+                        fmt::format("{}/{}", input_data.identifier,
+                                    input_data.input_name_for_connector.at(input))});
                 }
             }
+            for (const auto& [connector, access] : data.connector_access) {
+                all = all | access;
+                all_write_access |= write_access(access);
+            }
+        }
+    }
+
+    // Orders src before dst at the layer of dst. The barrier is recorded at the start of the layer
+    // and thus also covers src in all earlier layers.
+    const auto add_dependency = [&](const Access& src, const Access& dst, const char* kind) {
+        if (src.access.empty() || dst.access.empty()) {
+            return;
+        }
+        Layer& layer = layers[dst.level];
+        layer.barrier.srcStageMask |= src.access.stages;
+        layer.barrier.srcAccessMask |= write_access(src.access);
+        layer.barrier.dstStageMask |= dst.access.stages;
+        layer.barrier.dstAccessMask |= dst.access.access;
+        layer.dependencies.emplace_back(fmt::format("{} {} -> {}", kind, src.name, dst.name));
+    };
+
+    for (const auto& [output, output_accesses] : accesses) {
+        for (const Access& dst : output_accesses) {
+            for (const Access& src : output_accesses) {
+                if (src.level >= dst.level) {
+                    continue;
+                }
+                if (src.access.is_write()) {
+                    add_dependency(src, dst, dst.access.is_write() ? "WAW" : "RAW");
+                } else if (dst.access.is_write()) {
+                    add_dependency(src, dst, "WAR");
+                }
+            }
+        }
+    }
+
+    // The first access of a resource placed into memory of an earlier resource must wait for all
+    // accesses of the earlier one.
+    for (const auto& [earlier, later] : aliasing_memory_allocator->get_aliasing_owners()) {
+        if (!aliasing_owners[earlier].first || !aliasing_owners[later].first) {
+            // the placement was released by an incremental reconnect
+            continue;
+        }
+        const std::vector<Access>& earlier_accesses = accesses.at(aliasing_owners[earlier].second);
+        const std::vector<Access>& later_accesses = accesses.at(aliasing_owners[later].second);
+        // the producer comes first
+        const Access& first = later_accesses.front();
+        for (const Access& src : earlier_accesses) {
+            if (src.level < first.level) {
+                add_dependency(src, first, "ALIAS");
+            }
         }
-        all.stages |= masks[l].stages;
-        all.access |= masks[l].access;
-        all.write_access |= masks[l].write_access;
     }
 
-    // src covers all previous layers cumulatively (a layer-1 write read in layer 4 must be
-    // covered; execution dependencies also chain into earlier iterations on the same queue).
     // layers[0] orders the whole frame against the previous iteration (delayed inputs, ring
     // reuse).
-    if (layer_count > 0) {
+    if (!layers.empty()) {
         layers[0].barrier =
-            vk::MemoryBarrier2{all.stages, all.write_access, all.stages, all.access};
+            vk::MemoryBarrier2{all.stages, all_write_access, all.stages, all.access};
+        layers[0].dependencies = {"previous iteration"};
     }
-    Masks prefix{};
-    for (uint32_t l = 1; l < layer_count; l++) {
-        prefix.stages |= masks[l - 1].stages;
-        prefix.write_access |= masks[l - 1].write_access;
-        layers[l].barrier = vk::MemoryBarrier2{prefix.stages, prefix.write_access, masks[l].stages,
-                                               masks[l].access};
+
+    SPDLOG_DEBUG("barrier schedule:\n{}", get_barrier_schedule());
+}
+
+std::string Graph::get_barrier_schedule() const {
+    std::string schedule;
+    for (uint32_t l = 0; l < layers.size(); l++) {
+        const Layer& layer = layers[l];
+        std::vector<std::string> node_names;
+        for (const NodeHandle& node : layer.nodes) {
+            node_names.emplace_back(node_data.at(node).identifier);
+        }
+        schedule += fmt::format("layer {}: {}\n", l, fmt::join(node_names, ", "));
+        if (!layer.barrier.dstStageMask) {
+            schedule += "  no barrier\n\n";
+            continue;
+        }
+        schedule += fmt::format("  src: {} {}\n", vk::to_string(layer.barrier.srcStageMask),
+                                vk::to_string(layer.barrier.srcAccessMask));
+        schedule += fmt::format("  dst: {} {}\n", vk::to_string(layer.barrier.dstStageMask),
+                                vk::to_string(layer.barrier.dstAccessMask));
+        for (const std::string& dependency : layer.dependencies) {
+            schedule += fmt::format("  - {}\n", dependency);
+        }
+        schedule += "\n";
     }
+    return schedule;
 }
 
 std::string Graph::make_error_input_not_connected(const InputConnectorHandle& input,
@@ -133,6 +133,8 @@ const std::string& Graph::add_node(const std::shared_ptr<Node>& node,
     node_for_identifier[node_identifier] = node;
     auto [it, inserted] = node_data.try_emplace(node, node_identifier);
     assert(inserted);
+    it->second.profiler_section = Profiler::intern(fmt::format(
+        "{} ({})", node_identifier, NodeRegistry::get_instance().node_type_name(node)));
 
     const InstanceSupportInfo& instance_support = context_extension->get_instance_support(node);
     if (instance_support.supported) {
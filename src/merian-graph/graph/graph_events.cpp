@@ -16,7 +16,9 @@ void Graph::register_event_listener(const std::string& event_pattern,
 }
 
 void Graph::register_event_listener_for_connect(const std::string& event_pattern,
-                                                const GraphEvent::Listener& event_listener) {
+                                                const GraphEvent::Listener& event_listener,
+                                                const NodeHandle& owner) {
+    const EventListener listener{owner, event_listener};
     split(event_pattern, ",", [&](const std::string& split_pattern) {
         std::smatch match;
         if (!std::regex_match(split_pattern, match, EVENT_REGEX)) {
@@ -31,10 +33,10 @@ void Graph::register_event_listener_for_connect(const std::string& event_pattern
         if (node_name.empty()) {
             registered = true;
             if (node_identifier.empty()) {
-                event_listeners["user"][event_name].emplace_back(event_listener);
-                event_listeners["graph"][event_name].emplace_back(event_listener);
+                event_listeners["user"][event_name].push_back(listener);
+                event_listeners["graph"][event_name].push_back(listener);
             } else if (node_identifier == "user" || node_identifier == "graph") {
-                event_listeners[node_identifier][event_name].emplace_back(event_listener);
+                event_listeners[node_identifier][event_name].push_back(listener);
             } else {
                 registered = false;
             }
@@ -42,7 +44,7 @@ void Graph::register_event_listener_for_connect(const std::string& event_pattern
         for (const auto& [identifier, node] : node_for_identifier) {
             if ((node_name.empty() || registry.node_type_name(node) == node_name) &&
                 (node_identifier.empty() || identifier == node_identifier)) {
-                event_listeners[identifier][event_name].emplace_back(event_listener);
+                event_listeners[identifier][event_name].push_back(listener);
                 registered = true;
             }
         }
@@ -57,6 +59,16 @@ void Graph::register_event_listener_for_connect(const std::string& event_pattern
     });
 }
 
+void Graph::remove_event_listeners(const std::unordered_set<NodeHandle>& owners) {
+    for (auto& [identifier, listeners_for_event] : event_listeners) {
+        for (auto& [event_name, listeners] : listeners_for_event) {
+            std::erase_if(listeners, [&](const EventListener& listener) {
+                return listener.owner && owners.contains(listener.owner);
+            });
+        }
+    }
+}
+
 void Graph::send_graph_event(const std::string& event_name,
                              const GraphEvent::Data& data,
                              const bool notify_all) {
@@ -88,11 +100,11 @@ void Graph::send_event(const GraphEvent::Info& event_info,
     if (event_it != identifier_it->second.end()) {
         if (notify_all) {
             for (const auto& listener : event_it->second) {
-                listener(event_info, data);
+                listener.listener(event_info, data);
             }
         } else {
             for (const auto& listener : event_it->second) {
-                if (listener(event_info, data)) {
+                if (listener.listener(event_info, data)) {
                     break;
                 }
             }
@@ -104,11 +116,11 @@ void Graph::send_event(const GraphEvent::Info& event_info,
     if (event_any_it != identifier_it->second.end()) {
         if (notify_all) {
             for (const auto& listener : event_any_it->second) {
-                listener(event_info, data);
+                listener.listener(event_info, data);
             }
         } else {
             for (const auto& listener : event_any_it->second) {
-                if (listener(event_info, data)) {
+                if (listener.listener(event_info, data)) {
                     break;
                 }
             }
@@ -130,4 +142,9 @@ void Graph::set_on_post_submit(const std::function<void()>& on_post_submit) {
     this->on_post_submit = on_post_submit;
 }
 
+void Graph::set_on_run_report(
+    const std::function<void(const Profiler::Report& report)>& on_run_report) {
+    this->on_run_report = on_run_report;
+}
+
 } // namespace merian
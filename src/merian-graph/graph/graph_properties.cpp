@@ -4,6 +4,7 @@
 #include "merian-graph/nodes/window/window_node.hpp"
 
 #include <algorithm>
+#include <fstream>
 #include <spdlog/spdlog.h>
 
 namespace merian {
@@ -62,6 +63,28 @@ void Graph::graph_properties(Properties& props) {
     props.st_separate();
     if (props.is_ui() && !layers.empty()) {
         props.output_text("dependency layers: {}", layers.size());
+        if (props.st_begin_child("barrier_schedule", "Barrier Schedule")) {
+            props.output_text(get_barrier_schedule());
+            props.st_end_child();
+        }
+    }
+
+    props.st_separate();
+    props.config_bool("incremental reconnect", incremental_reconnect,
+                      "If enabled, a node that requests a reconnect only rebuilds itself and the "
+                      "nodes downstream of it. The number of rebuilt nodes is shown in the report "
+                      "of the last graph build.");
+    if (props.config_bool("alias transient resources", alias_transient_resources,
+                          "Outputs that are neither persistent nor read delayed share memory with "
+                          "outputs whose producer-to-last-consumer layers do not overlap.")) {
+        request_reconnect();
+    }
+    if (props.is_ui()) {
+        props.output_text("transient memory: {} in {} heaps ({} for {} resources without aliasing)",
+                          format_size(aliasing_memory_allocator->get_heap_size()),
+                          aliasing_memory_allocator->get_heap_count(),
+                          format_size(aliasing_memory_allocator->get_requested_size()),
+                          aliasing_memory_allocator->get_placement_count());
     }
 
     props.st_separate();
@@ -70,6 +93,19 @@ void Graph::graph_properties(Properties& props) {
                       "run starts. HIGHLY RECOOMMENDED as it limits memory allocations and "
                       "prevents the queue to fill up indefinitely.");
     props.output_text("tasks in queue: {}", thread_pool->queue_size());
+    props.config_bool("parallel recording", parallel_recording,
+                      "If enabled, the nodes of a layer are recorded into secondary command "
+                      "buffers on the thread pool. Nodes are then profiled per layer only.");
+    if (async_compute_queue) {
+        if (props.config_bool(
+                "async compute", async_compute,
+                "If enabled, nodes that prefer the async compute queue are recorded there and "
+                "overlap with the graphics work of the following layers.")) {
+            request_reconnect();
+        }
+    } else {
+        props.output_text("async compute: no compute queue available");
+    }
 
     props.st_separate();
     static_cast<void>(
@@ -151,6 +187,99 @@ void Graph::profiler_properties(Properties& props) {
     }
 }
 
+void Graph::memory_properties(Properties& props) {
+    const std::optional<MemoryStatistics::Report> report = get_memory_statistics();
+    if (!report) {
+        props.output_text("the memory allocator does not track its allocations");
+        return;
+    }
+
+    props.st_separate("Heaps");
+    for (uint32_t i = 0; i < report->heaps.size(); i++) {
+        const MemoryStatistics::Heap& heap = report->heaps[i];
+        props.output_text("heap {}{}: {} / {} budget (peak {}), size {}", i,
+                          heap.budget.device_local ? " (device local)" : "",
+                          format_size(heap.budget.usage), format_size(heap.budget.budget),
+                          format_size(heap.peak_usage), format_size(heap.budget.size));
+        props.output_text("   tracked: {} in {} allocations (peak {})",
+                          format_size(heap.tracked.bytes), heap.tracked.allocations,
+                          format_size(heap.tracked.peak_bytes));
+    }
+
+    const auto output_sorted = [&](const std::map<std::string, MemoryStatistics::Usage>& usages) {
+        std::vector<std::pair<std::string, MemoryStatistics::Usage>> sorted(usages.begin(),
+                                                                           usages.end());
+        std::ranges::sort(sorted, std::greater<>{},
+                          [](const auto& entry) { return entry.second.bytes; });
+        for (const auto& [key, usage] : sorted) {
+            props.output_text("{}: {} in {} allocations (peak {})", key, format_size(usage.bytes),
+                              usage.allocations, format_size(usage.peak_bytes));
+        }
+    };
+
+    props.st_separate("Owners");
+    props.output_text("total: {} in {} allocations (peak {})", format_size(report->total.bytes),
+                      report->total.allocations, format_size(report->total.peak_bytes));
+    output_sorted(report->by_owner);
+    if (props.st_begin_child("by_name", "By Debug Name")) {
+        output_sorted(report->by_name);
+        props.st_end_child();
+    }
+
+    const ResourcePoolHandle& pool = graph_resource_allocator->get_resource_pool();
+    props.st_separate("Resource Pool");
+    props.output_text("pooled: {} resources ({}), {} hits, {} misses", pool->get_pooled_count(),
+                      format_size(pool->get_pooled_size()), pool->get_hits(), pool->get_misses());
+    uint32_t max_age = pool->get_max_age();
+    if (props.config_uint("keep for reconnects", max_age,
+                          "Released graph resources are reused by later reconnects with identical "
+                          "create infos and destroyed if unused for that many reconnects.")) {
+        pool->set_max_age(max_age);
+    }
+    if (props.config_bool("clear pool")) {
+        pool->clear();
+    }
+
+    const StagingMemoryManagerHandle& staging = resource_allocator->get_staging();
+    props.st_separate("Staging");
+    props.output_text("blocks: {} / {}, {} stalls, {} individual",
+                      format_size(staging->get_allocated_size()),
+                      staging->get_max_size() != 0 ? format_size(staging->get_max_size())
+                                                   : "unlimited",
+                      staging->get_stall_count(), staging->get_individual_count());
+    uint32_t staging_max_mib = static_cast<uint32_t>(staging->get_max_size() >> 20);
+    if (props.config_uint("max staging (MiB)", staging_max_mib,
+                          "Limits the staging blocks, new uploads wait for the GPU to release a "
+                          "block instead. 0 means unlimited.")) {
+        staging->set_max_size(vk::DeviceSize(staging_max_mib) << 20);
+    }
+    uint32_t stream_budget_mib = static_cast<uint32_t>(staging->get_stream_budget() >> 20);
+    if (props.config_uint("stream budget (MiB)", stream_budget_mib,
+                          "Max bytes of a streamed upload that are in flight.", 1)) {
+        staging->set_stream_budget(vk::DeviceSize(stream_budget_mib) << 20);
+    }
+    uint32_t keep_idle_blocks = staging->get_keep_idle_blocks();
+    if (props.config_uint("keep idle blocks", keep_idle_blocks,
+                          "Released staging blocks kept for reuse per direction, further idle "
+                          "blocks are freed.")) {
+        staging->set_keep_idle_blocks(keep_idle_blocks);
+    }
+
+    props.st_separate();
+    if (props.config_bool("reset peaks")) {
+        resource_allocator->get_memory_allocator()->reset_memory_statistics_peaks();
+    }
+    if (props.is_ui()) {
+        static_cast<void>(
+            props.config_text("json path", memory_statistics_path, false,
+                              "Path for Dump JSON, e.g. to compare the memory of two runs."));
+        if (props.config_bool("Dump JSON") && !memory_statistics_path.empty()) {
+            std::ofstream(memory_statistics_path) << MemoryStatistics::to_json(*report).dump(2);
+            SPDLOG_INFO("wrote memory statistics to {}", memory_statistics_path);
+        }
+    }
+}
+
 void Graph::properties(Properties& props) {
     needs_reconnect |= props.config_bool("Rebuild");
     props.st_no_space();
@@ -283,6 +412,11 @@ void Graph::properties(Properties& props) {
         props.st_end_child();
     }
 
+    if (props.st_begin_child("memory", "Memory", Properties::ChildFlagBits::FRAMED)) {
+        memory_properties(props);
+        props.st_end_child();
+    }
+
     if (props.st_begin_child("nodes", "Nodes",
                              Properties::ChildFlagBits::DEFAULT_OPEN |
                                  Properties::ChildFlagBits::FRAMED)) {
@@ -328,7 +462,7 @@ void Graph::properties(Properties& props) {
                     const Node::NodeStatusFlags flags = node->properties(props);
                     if ((flags & Node::NodeStatusFlagBits::NEEDS_RECONNECT) != 0u) {
                         SPDLOG_DEBUG("node {} requested reconnect", data.identifier);
-                        request_reconnect();
+                        request_reconnect(node);
                     }
                     if ((flags & Node::NodeStatusFlagBits::REMOVE_NODE) != 0u) {
                         remove_node(data.identifier);
@@ -348,7 +482,7 @@ void Graph::properties(Properties& props) {
 static const VkImageInHandle window_display_input = VkImageIn::create();
 
 void Graph::io_props_for_node(Properties& config, NodeHandle& node, NodeData& data) {
-    if (!needs_reconnect && !data.output_connections.empty() &&
+    if (!get_needs_reconnect() && !data.output_connections.empty() &&
         config.st_begin_child("outputs", "Outputs")) {
         for (auto& [output, per_output_info] : data.output_connections) {
             const std::string& output_name = data.output_name_for_connector.at(output);
@@ -405,7 +539,7 @@ void Graph::io_props_for_node(Properties& config, NodeHandle& node, NodeData& da
         }
         config.st_end_child();
     }
-    if (!needs_reconnect && !data.input_connectors.empty() &&
+    if (!get_needs_reconnect() && !data.input_connectors.empty() &&
         config.st_begin_child("inputs", "Inputs")) {
         for (const auto& input : data.input_connectors) {
             const std::string& input_name = data.input_name_for_connector.at(input);
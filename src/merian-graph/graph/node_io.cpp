@@ -47,7 +47,7 @@ NodeIOLayout::output_for_input(const InputConnectorHandle& input_connector) cons
 
 void NodeIOLayout::register_event_listener(const std::string& event_pattern,
                                            const GraphEvent::Listener& event_listener) const {
-    graph->register_event_listener_for_connect(event_pattern, event_listener);
+    graph->register_event_listener_for_connect(event_pattern, event_listener, node);
 }
 
 // --- NodeIO ---
@@ -107,7 +107,7 @@ std::vector<OutputConnectorDescriptor> ErrorPlot::describe_outputs(const NodeIOL
 
 ErrorPlot::NodeStatusFlags ErrorPlot::on_connected(const NodeIOLayout& io_layout,
                                                    [[maybe_unused]] const NodeIO& io,
-                                                   const NodeConnectionInfo& info,
+                                                   [[maybe_unused]] const NodeConnectionInfo& info,
                                                    [[maybe_unused]] Submission& submission) {
     io_layout.register_event_listener(
         "/graph/reload_shaders", [this](const GraphEvent::Info&, const GraphEvent::Data& force) {
@@ -117,15 +117,6 @@ ErrorPlot::NodeStatusFlags ErrorPlot::on_connected(const NodeIOLayout& io_layout
             return true;
         });
 
-    readback_buffers.resize(info.iterations_in_flight);
-    for (BufferHandle& buffer : readback_buffers) {
-        if (!buffer) {
-            buffer = allocator->create_buffer(sizeof(float4), vk::BufferUsageFlagBits::eTransferDst,
-                                              MemoryMappingType::HOST_ACCESS_RANDOM,
-                                              "error_plot readback");
-        }
-    }
-
     return {};
 }
 
@@ -190,18 +181,18 @@ ErrorPlot::process(const NodeIO& io, const NodeProcessInfo& info, Submission& su
     }
 
     // 4. non-blocking readback of the reduced value (must not stall the graph)
-    const BufferHandle readback = readback_buffers[info.get_in_flight_index()];
     cmd->barrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eTransfer,
                  io[con_error]->buffer_barrier(vk::AccessFlagBits::eShaderWrite,
                                                vk::AccessFlagBits::eTransferRead));
-    cmd->copy(static_cast<const BufferHandle&>(io[con_error]), readback);
-    submission.sync_to_cpu([this, readback]() {
-        const float4 value = *readback->get_memory()->map_as<float4>();
-        readback->get_memory()->unmap();
-        const std::scoped_lock lock(result_mutex);
-        latest_sum = value;
-        latest_valid = true;
-    });
+    allocator->get_staging()->cmd_readback(
+        submission, static_cast<const BufferHandle&>(io[con_error]),
+        [this](const StagingMemoryManager::ReadbackHandle& readback) {
+            const float4 value = readback->as<float4>()[0];
+            const std::scoped_lock lock(result_mutex);
+            latest_sum = value;
+            latest_valid = true;
+        },
+        0, sizeof(float4));
 
     // 5. split view: input fills the output, reference overwrites the left half
     const ImageHandle reference_img = io[con_reference];
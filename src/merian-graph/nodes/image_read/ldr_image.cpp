@@ -52,7 +52,7 @@ LDRImageRead::process(const NodeIO& io, const NodeProcessInfo& info, Submission&
     SPDLOG_INFO("Loaded image from {} ({}x{}, {} channels)", filename.string(), width, height,
                 channels);
 
-    info.get_allocator()->get_staging()->cmd_to_device(submission.get_cmd(), io[con_out],
+    info.get_allocator()->get_staging()->cmd_to_device(submission, io[con_out],
                                                        image->get_data());
 
     if (!keep_on_host) {
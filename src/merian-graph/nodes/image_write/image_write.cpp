@@ -198,9 +198,6 @@ ImageWrite::process(const NodeIO& io, const NodeProcessInfo& info, Submission& s
         vk::ImageLayout::eUndefined,
     };
     const ImageHandle intermediate_image = allocator->create_image(intermediate_info);
-    const BufferHandle staging_buffer = allocator->create_buffer(
-        Image::format_size(format) * scaled.width * scaled.height,
-        vk::BufferUsageFlagBits::eTransferDst, MemoryMappingType::HOST_ACCESS_RANDOM);
 
     {
         MERIAN_PROFILE_SCOPE_GPU(info.get_profiler(), cmd, "blit to intermediate image");
@@ -215,37 +212,25 @@ ImageWrite::process(const NodeIO& io, const NodeProcessInfo& info, Submission& s
                                                  vk::AccessFlagBits::eTransferWrite,
                                                  vk::AccessFlagBits::eTransferRead));
     }
-    {
-        MERIAN_PROFILE_SCOPE_GPU(info.get_profiler(), cmd, "copy to buffer");
-        // zero row length / image height: rows are tightly packed, unlike a linear image which
-        // carries a driver-defined row pitch.
-        cmd->copy(intermediate_image, staging_buffer,
-                  vk::BufferImageCopy{0, 0, 0, first_layer(), {}, scaled});
-    }
-    cmd->barrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost,
-                 staging_buffer->buffer_barrier(vk::AccessFlagBits::eTransferWrite,
-                                                vk::AccessFlagBits::eHostRead));
 
     std::filesystem::create_directories(path.parent_path());
     const std::string tmp_filename =
         (path.parent_path() / (".interm_" + path.filename().string())).string();
 
-    std::function<void()> write_task = ([this, staging_buffer, path, tmp_filename, scaled]() {
+    const auto write_task = [this, path, tmp_filename,
+                             scaled](const StagingMemoryManager::ReadbackHandle& readback) {
         const int w = static_cast<int>(scaled.width);
         const int h = static_cast<int>(scaled.height);
 
         // the thread pool discards exceptions, report here or the capture fails silently
         try {
             if (format_is_float(this->format)) {
-                float* mem = staging_buffer->get_memory()->map_as<float>();
-                image_save_f32(tmp_filename, mem, w, h, 4);
+                image_save_f32(tmp_filename, readback->as<float>().data(), w, h, 4);
             } else {
-                uint8_t* mem = staging_buffer->get_memory()->map_as<uint8_t>();
-                image_save_u8(tmp_filename, mem, w, h, 4);
+                image_save_u8(tmp_filename, readback->as<uint8_t>().data(), w, h, 4);
             }
         } catch (const std::exception& e) {
             SPDLOG_ERROR("could not write {}: {}", path.string(), e.what());
-            staging_buffer->get_memory()->unmap();
             return;
         }
 
@@ -258,12 +243,14 @@ ImageWrite::process(const NodeIO& io, const NodeProcessInfo& info, Submission& s
         }
 
         SPDLOG_INFO("wrote image to {}", path.string());
+    };
 
-        staging_buffer->get_memory()->unmap();
-        return;
-    });
-
-    submission.sync_to_cpu(std::move(write_task));
+    {
+        MERIAN_PROFILE_SCOPE_GPU(info.get_profiler(), cmd, "copy to buffer");
+        // the readback is tightly packed, unlike a linear image which carries a driver-defined
+        // row pitch.
+        allocator->get_staging()->cmd_readback(submission, intermediate_image, write_task);
+    }
 
     NodeStatusFlags flags{};
     if (rebuild_after_capture)
@@ -79,6 +79,11 @@ MeanToBuffer::on_connected(const NodeIOLayout& io_layout,
     return {};
 }
 
+MeanToBuffer::QueueAffinity MeanToBuffer::get_queue_affinity() {
+    // compute only, results are usually consumed late (exposure, statistics)
+    return QueueAffinity::ASYNC_COMPUTE;
+}
+
 [[nodiscard]] MeanToBuffer::NodeStatusFlags
 MeanToBuffer::process(const NodeIO& io, const NodeProcessInfo& info, Submission& submission) {
     const CommandBufferHandle& cmd = submission.get_cmd();
@@ -75,6 +75,11 @@ MedianApproxNode::on_connected(const NodeIOLayout& io_layout,
     return {};
 }
 
+MedianApproxNode::QueueAffinity MedianApproxNode::get_queue_affinity() {
+    // compute only, results are usually consumed late (exposure, statistics)
+    return QueueAffinity::ASYNC_COMPUTE;
+}
+
 [[nodiscard]] MedianApproxNode::NodeStatusFlags
 MedianApproxNode::process(const NodeIO& io, const NodeProcessInfo& info, Submission& submission) {
     const CommandBufferHandle& cmd = submission.get_cmd();
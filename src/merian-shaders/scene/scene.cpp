@@ -17,9 +17,13 @@
 #include <spdlog/spdlog.h>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
+#include <cstddef>
 #include <fmt/format.h>
+#include <limits>
+#include <tuple>
 #include <unordered_map>
 
 namespace merian {
@@ -209,24 +213,11 @@ Scene::NodeID Scene::add_node(Node node) {
         scene_graph[node.parent]->children.push_back(id);
     }
 
+    transform_hierarchy.add(id, node.parent, node.local_transform);
     scene_graph[id] = std::move(node);
     return id;
 }
 
-void Scene::invalidate_node(Node& node) {
-    node.global_transform.reset();
-    node.global_inverse_transposed.reset();
-    node.transform_dirty = true;
-
-    for (const auto child_node_id : node.children) {
-        assert(node_ids.is_used(child_node_id));
-        assert(child_node_id < scene_graph.size());
-        assert(scene_graph[child_node_id]);
-
-        invalidate_node(*scene_graph[child_node_id]);
-    }
-}
-
 void Scene::update_node(NodeID node_id, const float4x4& local_transform) {
     assert(node_ids.is_used(node_id));
     assert(node_id < scene_graph.size());
@@ -238,7 +229,7 @@ void Scene::update_node(NodeID node_id, const float4x4& local_transform) {
     if (node.local_transform != local_transform) {
         node.local_transform = local_transform;
 
-        invalidate_node(node);
+        transform_hierarchy.set_local(node_id, local_transform);
 
         transforms_changed = true;
     }
@@ -326,6 +317,7 @@ void Scene::remove_node(const NodeID node_id) {
 
     needs_regroup = true;
 
+    transform_hierarchy.remove(node_id);
     scene_graph[node_id].reset();
     node_ids.release(node_id);
     scene_graph.resize(node_ids.size());
@@ -399,6 +391,27 @@ namespace {
 
 constexpr uint32_t TRANSFORM_LOCAL_SIZE_X = 256;
 
+// Copies of elements that are packed in the order of the sorted slots to their slots.
+// Consecutive slots share a copy.
+std::vector<vk::BufferCopy> slot_copy_runs(const std::vector<uint32_t>& slots,
+                                           const vk::DeviceSize element_size) {
+    std::vector<vk::BufferCopy> runs;
+    for (std::size_t i = 0; i < slots.size();) {
+        std::size_t j = i + 1;
+        while (j < slots.size() && slots[j] == slots[j - 1] + 1)
+            j++;
+        runs.push_back({i * element_size, slots[i] * element_size, (j - i) * element_size});
+        i = j;
+    }
+    return runs;
+}
+
+void set_instance_transform(vk::AccelerationStructureInstanceKHR& instance, const float4x4& t) {
+    for (int row = 0; row < 3; row++)
+        for (int col = 0; col < 4; col++)
+            instance.transform.matrix[row][col] = t[row][col];
+}
+
 } // namespace
 
 void Scene::ensure_transform_pipelines() {
@@ -520,6 +533,7 @@ void Scene::properties_node(Properties& props, const NodeID node_id) {
     }
     const Node& node = *scene_graph[node_id];
     props.output_text("{}", node);
+    props.output_text("global_transform:\n{}", get_global_transform(node_id));
 
     for (uint32_t i = 0; i < node.children.size(); i++) {
         const NodeID child_id = node.children[i];
@@ -758,6 +772,17 @@ void Scene::properties_settings(Properties& props) {
         set_pretransform_animated(pretransform);
     }
     props.config_percent("BLAS Rebuild Fraction", blas_rebuild_fraction);
+    props.config_uint("BLAS Build Budget (kPrims)", blas_build_budget_kprims,
+                      "Thousands of primitives BLAS builds may process per frame. Further builds "
+                      "are deferred, their groups are missing from the TLAS until built. Deferred "
+                      "rebuilds of updatable BLASes are refit instead. 0 disables.");
+    props.config_bool("Refit TLAS", tlas_refit,
+                      "Update the TLAS in place if only transforms changed instead of rebuilding.");
+    props.config_uint("TLAS Rebuild Interval", tlas_rebuild_interval,
+                      "Rebuild the TLAS after this many refits. 0 never rebuilds.");
+    props.config_uint("Defrag Budget (MiB)", defrag_budget_mib,
+                      "Mesh data moved per frame to compact the shared vertex and index buffers "
+                      "when they are fragmented or mostly empty. 0 disables.");
 
     props.st_separate("Material System");
     float alpha_threshold = material_system->get_alpha_test_threshold();
@@ -919,7 +944,7 @@ void Scene::properties_statistics(Properties& props) {
     }
 
     props.output_text(
-        "nodes:       {}\n"
+        "nodes:       {} ({} levels)\n"
         "meshes:      {} (dynamic: {}, morphed: {}, animated: {}, var_topo: {})\n"
         "instances:   {} (animated: {})\n"
         "mesh groups: {}\n"
@@ -930,10 +955,11 @@ void Scene::properties_statistics(Properties& props) {
         "tlas:        {} instances\n"
         "flags:       needs_regroup={}, transforms_changed={}, pretransform_animated={}\n"
         "pending buffer releases: {}",
-        node_ids.count(), mesh_ids.count(), dynamic_meshes, morphed_meshes,
-        animated_instance_meshes, variable_topology_meshes, total_instances, animated_instances,
-        mesh_groups.size(), total_vertices, total_triangles, material_system->get_material_count(),
-        get_texture_manager()->get_texture_count(), tlas_instances.size(), needs_regroup,
+        node_ids.count(), transform_hierarchy.get_depth(), mesh_ids.count(), dynamic_meshes,
+        morphed_meshes, animated_instance_meshes, variable_topology_meshes, total_instances,
+        animated_instances, mesh_groups.size(), total_vertices, total_triangles,
+        material_system->get_material_count(), get_texture_manager()->get_texture_count(),
+        tlas_instances.size(), needs_regroup,
         transforms_changed, pretransform_animated, pending_buffer_releases.size());
 
     if (aabb.is_valid()) {
@@ -952,9 +978,12 @@ void Scene::properties_statistics(Properties& props) {
         "prev vertex xfm: {} jobs ({} vertices)\n"
         "xfm job buffers: {}\n"
         "blas:            {} ops (builds_static: {}, builds_dynamic: {}, updates: {})\n"
-        "tlas:            {} ({} instances)\n"
+        "blas builds:     {} primitives, {} deferred\n"
+        "blas compaction: {} ({} saved, {} total)\n"
+        "tlas:            {} ({} instances, {} uploaded)\n"
         "buffers:         allocated: {}, released: {}\n"
-        "gpu data:        geometry {}, transforms {}, tlas instances {}",
+        "defrag:          {} moved ({} regions)\n"
+        "gpu data:        geometry {}, transforms {} ({} instances), tlas instances {}",
         frame_stats.meshes_uploaded(), frame_stats.meshes_uploaded_device_local,
         frame_stats.meshes_uploaded_device_staged, frame_stats.meshes_uploaded_host_packed,
         frame_stats.meshes_uploaded_host_unpacked, format_size(frame_stats.upload_bytes),
@@ -964,14 +993,24 @@ void Scene::properties_statistics(Properties& props) {
         format_size(frame_stats.gpu_transform_buffer_bytes),
         frame_stats.blas_builds + frame_stats.blas_updates, frame_stats.blas_builds_static,
         frame_stats.blas_builds_dynamic, frame_stats.blas_updates,
-        frame_stats.tlas_rebuilt ? "rebuilt" : "unchanged", frame_stats.tlas_instance_count,
+        frame_stats.blas_build_primitives, frame_stats.blas_builds_deferred,
+        frame_stats.blas_compactions,
+        format_size(frame_stats.blas_compaction_saved_bytes),
+        format_size(blas_compaction_saved_bytes),
+        frame_stats.tlas_rebuilt ? "rebuilt"
+        : frame_stats.tlas_refit ? "refit"
+                                 : "unchanged",
+        frame_stats.tlas_instance_count, frame_stats.tlas_instances_uploaded,
         frame_stats.buffers_allocated, frame_stats.buffers_released,
+        format_size(frame_stats.defrag_bytes_moved), frame_stats.defrag_regions_moved,
         format_size(frame_stats.geometry_data_bytes), format_size(frame_stats.transform_data_bytes),
+        frame_stats.transforms_uploaded,
         format_size(frame_stats.tlas_instance_data_bytes));
 
     props.st_separate("Shared Buffers");
     const auto block_text = [&](const char* name, const VMAMemorySubAllocatorHandle& slot,
-                                const vk::DeviceSize capacity) {
+                                const vk::DeviceSize capacity,
+                                const VMAMemorySubAllocatorHandle& defrag_source) {
         if (!slot) {
             props.output_text("{:<14} <not allocated>", name);
             return;
@@ -991,10 +1030,17 @@ void Scene::properties_statistics(Properties& props) {
                           fmt_size(s.allocationSizeMin), fmt_size(s.allocationSizeMax),
                           s.unusedRangeCount, fmt_size(s.unusedRangeSizeMin),
                           fmt_size(s.unusedRangeSizeMax));
+        if (defrag_source) {
+            const VmaDetailedStatistics d = defrag_source->get_detailed_statistics();
+            props.output_text("{:<14} compacting, {} in {} regions left to move", "",
+                              format_size(d.statistics.allocationBytes),
+                              d.statistics.allocationCount);
+        }
     };
-    block_text("shared_vb", shared_vb_suballoc, shared_vb_capacity);
-    block_text("shared_prev_vb", shared_prev_vb_suballoc, shared_prev_vb_capacity);
-    block_text("shared_ib", shared_ib_suballoc, shared_ib_capacity);
+    block_text("shared_vb", shared_vb_suballoc, shared_vb_capacity, shared_vb_defrag_source);
+    block_text("shared_prev_vb", shared_prev_vb_suballoc, shared_prev_vb_capacity,
+               shared_prev_vb_defrag_source);
+    block_text("shared_ib", shared_ib_suballoc, shared_ib_capacity, shared_ib_defrag_source);
     props.output_text("{:<14} {} staged this frame",
                       "upload_staging:", format_size(frame_stats.upload_bytes));
 }
@@ -1114,7 +1160,8 @@ void Scene::compute_mesh_groups() {
         const bool blas_vertices_change =
             group.has_morphed_mesh || (group.has_animated_node && pretransform_animated);
         if (!blas_vertices_change) {
-            group.blas_build_flags = vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace;
+            group.blas_build_flags = vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace |
+                                     vk::BuildAccelerationStructureFlagBitsKHR::eAllowCompaction;
         } else if (!group.has_variable_topology_mesh) {
             group.blas_build_flags = vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace |
                                      vk::BuildAccelerationStructureFlagBitsKHR::eAllowUpdate;
@@ -1131,6 +1178,8 @@ void Scene::compute_mesh_groups() {
                 prev_group.blas_build_flags == group.blas_build_flags) {
                 group.blas = prev_group.blas;
                 group.cached_blas_size_info = prev_group.cached_blas_size_info;
+                group.blas_last_built_frame = prev_group.blas_last_built_frame;
+                group.blas_last_updated_frame = prev_group.blas_last_updated_frame;
             }
         }
     }
@@ -1143,13 +1192,22 @@ void Scene::compute_mesh_groups() {
 
 void Scene::upload_transforms(const CommandBufferHandle& cmd) {
     MERIAN_PROFILE_SCOPE_GPU(cmd, "Scene::upload_transforms");
-    instance_transforms.clear();
-    inverse_transposed_instance_transforms.clear();
-    prev_instance_transforms.clear();
-    prev_inverse_transposed_instance_transforms.clear();
+
+    // Instance slots only change with regrouping. Otherwise only the slots of moved nodes are
+    // rewritten, and in the following frame again to advance their prev transforms.
+    bool full_upload = needs_regroup || !instance_transforms_buffer;
+    if (full_upload) {
+        instance_transforms.clear();
+        inverse_transposed_instance_transforms.clear();
+        prev_instance_transforms.clear();
+        prev_inverse_transposed_instance_transforms.clear();
+        prev_transform_slot_dirty.clear();
+    }
+    std::vector<uint32_t> dirty_slots;
 
     const float4x4 identity_transform = identity();
 
+    uint32_t slot = 0;
     for (MeshGroupID group_id = 0; group_id < mesh_groups.size(); group_id++) {
         MeshGroup& group = mesh_groups[group_id];
         assert(!group.meshes.empty());
@@ -1157,29 +1215,33 @@ void Scene::upload_transforms(const CommandBufferHandle& cmd) {
         const bool pretransform = group.is_pretransformed(mesh_infos, pretransform_animated);
 
         for (const NodeID node_id : group.get_instances(mesh_infos)) {
-            Node& node = *scene_graph[node_id];
-            const float4x4& global_transform = get_global_transform(node);
-            const float4x4& global_inverse_transposed_transform =
-                get_global_inverse_transposed_transform(node);
-
-            if (pretransform) {
+            if (full_upload) {
                 instance_transforms.emplace_back(identity_transform);
                 inverse_transposed_instance_transforms.emplace_back(identity_transform);
                 prev_instance_transforms.emplace_back(identity_transform);
                 prev_inverse_transposed_instance_transforms.emplace_back(identity_transform);
-            } else {
-                instance_transforms.emplace_back(global_transform);
-                inverse_transposed_instance_transforms.emplace_back(
-                    global_inverse_transposed_transform);
-
-                prev_instance_transforms.emplace_back(
-                    node.prev_global_transform.value_or(global_transform));
-                prev_inverse_transposed_instance_transforms.emplace_back(
-                    node.prev_global_inverse_transposed.value_or(
-                        global_inverse_transposed_transform));
+                prev_transform_slot_dirty.push_back(false);
+            }
+
+            const bool dirty = !pretransform && transform_hierarchy.is_moved(node_id);
+            if (!pretransform && (full_upload || dirty || prev_transform_slot_dirty[slot])) {
+                instance_transforms[slot] = get_global_transform(node_id);
+                inverse_transposed_instance_transforms[slot] =
+                    get_global_inverse_transposed_transform(node_id);
+                prev_instance_transforms[slot] = get_prev_global_transform(node_id);
+                prev_inverse_transposed_instance_transforms[slot] =
+                    get_prev_global_inverse_transposed_transform(node_id);
+
+                if (!full_upload)
+                    dirty_slots.push_back(slot);
             }
+            if (dirty && as_supported)
+                tlas_moved_instances.push_back(slot);
+            prev_transform_slot_dirty[slot] = dirty;
+            slot++;
         }
     }
+    assert(slot == instance_transforms.size());
 
     const auto staging = allocator->get_staging();
     auto c = shader_object->get_cursor();
@@ -1189,6 +1251,7 @@ void Scene::upload_transforms(const CommandBufferHandle& cmd) {
 
         if (!instance_transforms_buffer ||
             instance_transforms_buffer->get_size() < transforms_size) {
+            full_upload = true;
 
             cmd->keep_until_pool_reset(instance_transforms_buffer);
             cmd->keep_until_pool_reset(inverse_transposed_instance_transforms_buffer);
@@ -1218,13 +1281,63 @@ void Scene::upload_transforms(const CommandBufferHandle& cmd) {
                 prev_inverse_transposed_instance_transforms_buffer;
         }
 
-        staging->cmd_to_device(cmd, instance_transforms_buffer, instance_transforms);
-        staging->cmd_to_device(cmd, inverse_transposed_instance_transforms_buffer,
-                               inverse_transposed_instance_transforms);
-        staging->cmd_to_device(cmd, prev_instance_transforms_buffer, prev_instance_transforms);
-        staging->cmd_to_device(cmd, prev_inverse_transposed_instance_transforms_buffer,
-                               prev_inverse_transposed_instance_transforms);
+        // Past half of the slots the scattered copies do not pay off.
+        if (full_upload || dirty_slots.size() * 2 > instance_transforms.size()) {
+            staging->cmd_to_device(cmd, instance_transforms_buffer, instance_transforms);
+            staging->cmd_to_device(cmd, inverse_transposed_instance_transforms_buffer,
+                                   inverse_transposed_instance_transforms);
+            staging->cmd_to_device(cmd, prev_instance_transforms_buffer, prev_instance_transforms);
+            staging->cmd_to_device(cmd, prev_inverse_transposed_instance_transforms_buffer,
+                                   prev_inverse_transposed_instance_transforms);
+            frame_stats.transforms_uploaded = static_cast<uint32_t>(instance_transforms.size());
+        } else if (!dirty_slots.empty()) {
+            upload_transform_slots(cmd, dirty_slots);
+            frame_stats.transforms_uploaded = static_cast<uint32_t>(dirty_slots.size());
+        }
+        frame_stats.transform_data_bytes =
+            vk::DeviceSize(frame_stats.transforms_uploaded) * sizeof(float4x4) * 4;
+    }
+}
+
+void Scene::upload_transform_slots(const CommandBufferHandle& cmd,
+                                   const std::vector<uint32_t>& slots) {
+    assert(std::ranges::is_sorted(slots));
+    const std::array<const std::vector<float4x4>*, 4> sources = {
+        &instance_transforms,
+        &inverse_transposed_instance_transforms,
+        &prev_instance_transforms,
+        &prev_inverse_transposed_instance_transforms,
+    };
+    const std::array<const BufferHandle*, 4> targets = {
+        &instance_transforms_buffer,
+        &inverse_transposed_instance_transforms_buffer,
+        &prev_instance_transforms_buffer,
+        &prev_inverse_transposed_instance_transforms_buffer,
+    };
+
+    // Packed like the slots, one section per transform kind.
+    const vk::DeviceSize section_size = slots.size() * sizeof(float4x4);
+    const std::vector<vk::BufferCopy> runs = slot_copy_runs(slots, sizeof(float4x4));
+
+    BufferHandle buffer;
+    vk::DeviceSize buffer_offset = 0;
+    const MemoryAllocationHandle memory = allocator->get_staging()->get_upload_staging_space(
+        section_size * sources.size(), buffer, buffer_offset);
+    cmd->keep_until_pool_reset(buffer);
+    float4x4* data = static_cast<float4x4*>(memory->map());
+
+    std::vector<vk::BufferCopy> copies(runs.size());
+    for (std::size_t k = 0; k < sources.size(); k++) {
+        for (const uint32_t slot : slots) {
+            *data++ = (*sources[k])[slot];
+        }
+        for (std::size_t r = 0; r < runs.size(); r++) {
+            copies[r] = runs[r];
+            copies[r].srcOffset += buffer_offset + k * section_size;
+        }
+        cmd->copy(buffer, *targets[k], copies);
     }
+    memory->unmap();
 }
 
 void Scene::upload_geometry_data(const CommandBufferHandle& cmd) {
@@ -1240,8 +1353,8 @@ void Scene::upload_geometry_data(const CommandBufferHandle& cmd) {
         const bool pretransform = group.is_pretransformed(mesh_infos, pretransform_animated);
 
         for (const NodeID node_id : group.get_instances(mesh_infos)) {
-            Node& node = *scene_graph[node_id];
-            const bool transform_is_identity = get_global_transform(node) == identity_transform;
+            const bool transform_is_identity =
+                get_global_transform(node_id) == identity_transform;
 
             for (const MeshID mesh_id : group.meshes) {
                 MeshInfo& info = mesh_infos[mesh_id];
@@ -1331,6 +1444,33 @@ constexpr vk::DeviceSize size_with_headroom(const vk::DeviceSize required) {
     return ((target + RESIZE_QUANTUM - 1) / RESIZE_QUANTUM) * RESIZE_QUANTUM;
 }
 
+// Batch one cmd->copy per distinct source buffer.
+using RegionCopies =
+    std::unordered_map<Buffer*, std::pair<BufferHandle, std::vector<vk::BufferCopy>>>;
+
+// Re-suballocates the region from dst and queues the copy of its data.
+void move_region(const ContextHandle& context,
+                 Scene::MeshBufferRegion& region,
+                 const VMAMemorySubAllocatorHandle& dst,
+                 RegionCopies& copies) {
+    const BufferHandle src = region.get_suballocator()->get_base_buffer();
+    const auto va = dst->allocate({region.size, region.alignment, ~0u});
+
+    auto& [buffer, regions] = copies[src.get()];
+    buffer = src;
+    regions.push_back({region.get_offset(), va.offset, region.size});
+    region.suballoc = std::make_shared<VMAMemorySubAllocation>(context, dst, va.allocation,
+                                                               va.offset, region.size);
+}
+
+void record_copies(const CommandBufferHandle& cmd,
+                   const RegionCopies& copies,
+                   const BufferHandle& dst) {
+    for (const auto& [_, entry] : copies) {
+        cmd->copy(entry.first, dst, entry.second);
+    }
+}
+
 } // namespace
 
 void Scene::reallocate_shared_buffer(const CommandBufferHandle& cmd,
@@ -1346,32 +1486,104 @@ void Scene::reallocate_shared_buffer(const CommandBufferHandle& cmd,
     const VMAMemorySubAllocatorHandle new_alloc = VMAMemorySubAllocator::create(new_buffer);
     frame_stats.buffers_allocated++;
 
-    const BufferHandle old_buffer = slot ? slot->get_base_buffer() : nullptr;
-    std::vector<vk::BufferCopy> regions;
-    regions.reserve(mesh_ids.count());
+    const bool initial = !slot;
+    // Regions might still live in a buffer that is being defragmented.
+    RegionCopies copies;
+    uint32_t region_count = 0;
 
     for (const MeshID id : mesh_ids) {
         MeshBufferRegion& region = mesh_infos[id].*region_field;
         if (!region)
             continue;
 
-        const vk::DeviceSize old_offset = region.get_offset();
-        const auto va = new_alloc->allocate({region.size, region.alignment, ~0u});
-        regions.push_back({old_offset, va.offset, region.size});
-        region.suballoc = std::make_shared<VMAMemorySubAllocation>(
-            context, new_alloc, va.allocation, va.offset, region.size);
+        move_region(context, region, new_alloc, copies);
+        region_count++;
     }
 
-    if (old_buffer && !regions.empty()) {
-        cmd->copy(old_buffer, new_buffer, regions);
-    }
+    record_copies(cmd, copies, new_buffer);
 
     slot = new_alloc;
     capacity_slot = new_capacity;
 
     SPDLOG_DEBUG("Scene::reallocate_shared_buffer '{}': {} -> {}, migrated {} regions{}",
-                 debug_name, format_size(old_capacity), format_size(new_capacity), regions.size(),
-                 old_buffer ? "" : " (initial)");
+                 debug_name, format_size(old_capacity), format_size(new_capacity), region_count,
+                 initial ? " (initial)" : "");
+}
+
+vk::DeviceSize Scene::defragment_shared_buffer(const CommandBufferHandle& cmd,
+                                               VMAMemorySubAllocatorHandle& slot,
+                                               vk::DeviceSize& capacity_slot,
+                                               VMAMemorySubAllocatorHandle& source_slot,
+                                               MeshBufferRegion MeshInfo::* region_field,
+                                               const vk::DeviceSize budget,
+                                               const vk::BufferUsageFlags usage,
+                                               const std::string& debug_name) {
+    if (!slot || budget == 0)
+        return 0;
+
+    if (!source_slot) {
+        // O(allocations), same order as the size prepass.
+        const VmaDetailedStatistics s = slot->get_detailed_statistics();
+        const vk::DeviceSize live = s.statistics.allocationBytes;
+        const vk::DeviceSize free = s.statistics.blockBytes - live;
+        const vk::DeviceSize target = size_with_headroom(live);
+
+        const bool shrink = capacity_slot >= 2 * target;
+        const bool fragmented = free >= capacity_slot / 4 && s.unusedRangeSizeMax < free / 4;
+        if (!shrink && !fragmented)
+            return 0;
+
+        const BufferHandle new_buffer = allocator->create_buffer(
+            vk::BufferCreateInfo{{}, target, usage}, MemoryMappingType::NONE, debug_name);
+        frame_stats.buffers_allocated++;
+
+        SPDLOG_DEBUG("Scene::defragment_shared_buffer '{}': {} -> {} ({} live, largest free "
+                     "range {})",
+                     debug_name, format_size(capacity_slot), format_size(target),
+                     format_size(live), format_size(s.unusedRangeSizeMax));
+
+        source_slot = slot;
+        slot = VMAMemorySubAllocator::create(new_buffer);
+        capacity_slot = target;
+    }
+
+    RegionCopies copies;
+    vk::DeviceSize moved = 0;
+    bool done = true;
+    for (const MeshID id : mesh_ids) {
+        MeshBufferRegion& region = mesh_infos[id].*region_field;
+        if (!region || region.get_suballocator() != source_slot)
+            continue;
+        if (moved > 0 && moved + region.size > budget) {
+            done = false;
+            break;
+        }
+
+        move_region(context, region, slot, copies);
+        moved += region.size;
+        frame_stats.defrag_regions_moved++;
+    }
+
+    if (!copies.empty()) {
+        // previous frames may still write the regions (uploads, vertex transforms)
+        cmd->barrier(vk::MemoryBarrier2{
+            vk::PipelineStageFlagBits2::eAllCommands,
+            vk::AccessFlagBits2::eMemoryWrite,
+            vk::PipelineStageFlagBits2::eTransfer,
+            vk::AccessFlagBits2::eTransferRead,
+        });
+        record_copies(cmd, copies, slot->get_base_buffer());
+    }
+    frame_stats.defrag_bytes_moved += moved;
+
+    if (done) {
+        // in-flight frames might still read from the old buffer
+        cmd->keep_until_pool_reset(source_slot->get_base_buffer());
+        source_slot.reset();
+        SPDLOG_DEBUG("Scene::defragment_shared_buffer '{}': done", debug_name);
+    }
+
+    return moved;
 }
 
 void Scene::upload_meshes(const CommandBufferHandle& cmd) {
@@ -1422,6 +1634,35 @@ void Scene::upload_meshes(const CommandBufferHandle& cmd) {
                                  SHARED_IB_USAGE, "Scene::shared_ib");
     }
 
+    // Moved regions get their new device addresses into GeometryData (upload_geometry_data) and
+    // into the BLAS geometry with their next build or update.
+    if (defrag_budget_mib > 0) {
+        MERIAN_PROFILE_SCOPE_GPU(cmd, "defragment");
+        vk::DeviceSize budget = vk::DeviceSize(defrag_budget_mib) * 1024 * 1024;
+        budget -= std::min(budget, defragment_shared_buffer(
+                                       cmd, shared_vb_suballoc, shared_vb_capacity,
+                                       shared_vb_defrag_source, &MeshInfo::vertex_buffer, budget,
+                                       SHARED_VB_USAGE, "Scene::shared_vb"));
+        budget -= std::min(budget, defragment_shared_buffer(
+                                       cmd, shared_prev_vb_suballoc, shared_prev_vb_capacity,
+                                       shared_prev_vb_defrag_source,
+                                       &MeshInfo::prev_vertex_buffer, budget, SHARED_VB_USAGE,
+                                       "Scene::shared_prev_vb"));
+        defragment_shared_buffer(cmd, shared_ib_suballoc, shared_ib_capacity,
+                                 shared_ib_defrag_source, &MeshInfo::index_buffer, budget,
+                                 SHARED_IB_USAGE, "Scene::shared_ib");
+
+        if (frame_stats.defrag_bytes_moved > 0) {
+            // the uploads and vertex transforms below might overwrite moved regions
+            cmd->barrier(vk::MemoryBarrier2{
+                vk::PipelineStageFlagBits2::eTransfer,
+                vk::AccessFlagBits2::eTransferWrite,
+                vk::PipelineStageFlagBits2::eAllCommands,
+                vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite,
+            });
+        }
+    }
+
     // No-op if region already matches; reused regions stay where they are.
     const auto ensure_region = [&](MeshBufferRegion& region,
                                    const VMAMemorySubAllocatorHandle& slot,
@@ -1443,19 +1684,59 @@ void Scene::upload_meshes(const CommandBufferHandle& cmd) {
         BufferHandle buffer;
         vk::DeviceSize buffer_offset;
     };
-    const auto stage = [&](const vk::DeviceSize size, const auto& fill) -> StagedRange {
-        BufferHandle buffer;
-        vk::DeviceSize buffer_offset = 0;
-        const MemoryAllocationHandle memory =
-            allocator->get_staging()->get_upload_staging_space(size, buffer, buffer_offset);
-        cmd->keep_until_pool_reset(buffer);
-        fill(memory->map());
-        memory->unmap();
-        return {buffer->get_device_address() + buffer_offset, buffer, buffer_offset};
+    // Stages at most half a staging block at once, so that large meshes are suballocated from
+    // the staging ring instead of individual buffers. Copies from data if set, else fill writes
+    // all size bytes (through a host copy if chunked). Calls emit(staged, offset, size) for every
+    // chunk, chunks consist of whole elements.
+    const vk::DeviceSize max_chunk_size = allocator->get_staging()->get_block_size() / 2;
+    std::vector<std::byte> chunk_source;
+    const auto stage = [&](const vk::DeviceSize size, const vk::DeviceSize element_size,
+                           const void* data, const auto& fill, const auto& emit) {
+        const vk::DeviceSize chunk_size =
+            std::max<vk::DeviceSize>(max_chunk_size / element_size, 1) * element_size;
+        if (size > chunk_size && data == nullptr) {
+            chunk_source.resize(size);
+            fill(chunk_source.data());
+            data = chunk_source.data();
+        }
+
+        for (vk::DeviceSize offset = 0; offset < size; offset += chunk_size) {
+            const vk::DeviceSize staged_size = std::min(chunk_size, size - offset);
+            BufferHandle buffer;
+            vk::DeviceSize buffer_offset = 0;
+            const MemoryAllocationHandle memory =
+                allocator->get_staging()->get_upload_staging_space(staged_size, buffer,
+                                                                   buffer_offset);
+            cmd->keep_until_pool_reset(buffer);
+            if (data != nullptr) {
+                std::memcpy(memory->map(), static_cast<const std::byte*>(data) + offset,
+                            staged_size);
+            } else {
+                fill(memory->map());
+            }
+            memory->unmap();
+            emit(StagedRange{buffer->get_device_address() + buffer_offset, buffer, buffer_offset},
+                 offset, staged_size);
+        }
     };
+    const auto no_fill = [](void* /*dst*/) {};
 
-    // Batch one cmd->copy per distinct source buffer.
-    std::unordered_map<Buffer*, std::pair<BufferHandle, std::vector<vk::BufferCopy>>> index_copies;
+    // Vertices to transform from src, more than one range per mesh if staged in chunks.
+    struct VertexRange {
+        vk::DeviceAddress src;
+        uint32_t first;
+        uint32_t count;
+    };
+    const auto emit_vertex_range = [](std::vector<VertexRange>& ranges,
+                                      const vk::DeviceSize stride) {
+        return [&ranges, stride](const StagedRange& staged, const vk::DeviceSize offset,
+                                 const vk::DeviceSize size) {
+            ranges.push_back({staged.addr, static_cast<uint32_t>(offset / stride),
+                              static_cast<uint32_t>(size / stride)});
+        };
+    };
+
+    RegionCopies index_copies;
 
     {
         MERIAN_PROFILE_SCOPE("fill_staging");
@@ -1476,7 +1757,7 @@ void Scene::upload_meshes(const CommandBufferHandle& cmd) {
                     mesh.vertices_dirty = true;
 
                 mesh.vertices_dirty |=
-                    check_node_transform && scene_graph[*info.instances.begin()]->transform_dirty;
+                    check_node_transform && transform_hierarchy.is_moved(*info.instances.begin());
                 if (!mesh.is_dirty())
                     continue;
 
@@ -1513,92 +1794,111 @@ void Scene::upload_meshes(const CommandBufferHandle& cmd) {
                 }
 
                 if (mesh.vertices_dirty) {
-                    vk::DeviceAddress vertex_src_addr = 0;
+                    std::vector<VertexRange> vertex_ranges;
                     std::visit(
                         [&](auto&& src) {
                             using T = std::decay_t<decltype(src)>;
                             if constexpr (std::is_same_v<T, Mesh::DeviceLocal>) {
                                 frame_stats.meshes_uploaded_device_local++;
-                                vertex_src_addr = src.data->get_device_address();
+                                vertex_ranges.push_back(
+                                    {src.data->get_device_address(), 0, vertex_count});
                             } else if constexpr (std::is_same_v<T, Mesh::DeviceStaged>) {
                                 frame_stats.meshes_uploaded_device_staged++;
-                                vertex_src_addr = src.data->get_device_address() + src.offset;
+                                vertex_ranges.push_back(
+                                    {src.data->get_device_address() + src.offset, 0,
+                                     vertex_count});
                             } else if constexpr (std::is_same_v<
                                                      T, Mesh::HostPacked<PackedVertexData>>) {
                                 frame_stats.meshes_uploaded_host_packed++;
-                                vertex_src_addr = stage(vb_size, [&](void* dst) {
-                                                      std::memcpy(dst, src.data, vb_size);
-                                                  }).addr;
+                                stage(vb_size, sizeof(PackedVertexData), src.data, no_fill,
+                                      emit_vertex_range(vertex_ranges, sizeof(PackedVertexData)));
                             } else {
                                 static_assert(std::is_same_v<T, Mesh::HostVertices>);
                                 frame_stats.meshes_uploaded_host_unpacked++;
-                                vertex_src_addr =
-                                    stage(vb_size, [&](void* dst) {
+                                stage(
+                                    vb_size, sizeof(PackedVertexData), nullptr,
+                                    [&](void* dst) {
                                         src->write(static_cast<PackedVertexData*>(dst));
-                                    }).addr;
+                                    },
+                                    emit_vertex_range(vertex_ranges, sizeof(PackedVertexData)));
                             }
                         },
                         mesh.get_vertices());
 
                     if (needs_prev && !pretransform_prev) {
-                        vk::DeviceAddress prev_src_addr = 0;
+                        std::vector<VertexRange> prev_ranges;
                         std::visit(
                             [&](auto&& src) {
                                 using T = std::decay_t<decltype(src)>;
                                 if constexpr (std::is_same_v<T, std::monostate>) {
                                     assert(false);
                                 } else if constexpr (std::is_same_v<T, Mesh::DeviceLocal>) {
-                                    prev_src_addr = src.data->get_device_address();
+                                    prev_ranges.push_back(
+                                        {src.data->get_device_address(), 0, vertex_count});
                                 } else if constexpr (std::is_same_v<T, Mesh::DeviceStaged>) {
-                                    prev_src_addr = src.data->get_device_address() + src.offset;
+                                    prev_ranges.push_back(
+                                        {src.data->get_device_address() + src.offset, 0,
+                                         vertex_count});
                                 } else if constexpr (std::is_same_v<T, Mesh::HostPacked<
                                                                            PackedPrevVertexData>>) {
-                                    prev_src_addr = stage(prev_vb_size, [&](void* dst) {
-                                                        std::memcpy(dst, src.data, prev_vb_size);
-                                                    }).addr;
+                                    stage(prev_vb_size, sizeof(PackedPrevVertexData), src.data,
+                                          no_fill,
+                                          emit_vertex_range(prev_ranges,
+                                                            sizeof(PackedPrevVertexData)));
                                 } else {
                                     static_assert(std::is_same_v<T, Mesh::HostPrevVertices>);
-                                    prev_src_addr =
-                                        stage(prev_vb_size, [&](void* dst) {
+                                    stage(
+                                        prev_vb_size, sizeof(PackedPrevVertexData), nullptr,
+                                        [&](void* dst) {
                                             src->write(static_cast<PackedPrevVertexData*>(dst));
-                                        }).addr;
+                                        },
+                                        emit_vertex_range(prev_ranges,
+                                                          sizeof(PackedPrevVertexData)));
                                 }
                             },
                             mesh.get_prev_vertices());
 
                         const float4x4 prev_M =
-                            pretransform_mesh
-                                ? scene_graph[node_id]->prev_global_transform.value_or(M)
-                                : float4x4(identity());
-                        prev_vertex_jobs.push_back(TransformPrevVertexJob{
-                            .src = prev_src_addr,
-                            .dst = info.prev_vertex_buffer.get_device_address(),
-                            .prev_transform = prev_M,
-                            .vertex_count = vertex_count,
-                            ._pad = {},
-                        });
-                        max_prev_vertex_count_in_jobs =
-                            std::max(max_prev_vertex_count_in_jobs, vertex_count);
+                            pretransform_mesh ? get_prev_global_transform(node_id)
+                                              : float4x4(identity());
+                        for (const VertexRange& range : prev_ranges) {
+                            prev_vertex_jobs.push_back(TransformPrevVertexJob{
+                                .src = range.src,
+                                .dst = info.prev_vertex_buffer.get_device_address() +
+                                       range.first * sizeof(PackedPrevVertexData),
+                                .prev_transform = prev_M,
+                                .vertex_count = range.count,
+                                ._pad = {},
+                            });
+                            max_prev_vertex_count_in_jobs =
+                                std::max(max_prev_vertex_count_in_jobs, range.count);
+                        }
                         frame_stats.gpu_prev_vertex_transforms++;
                         frame_stats.gpu_prev_vertex_transform_vertices += vertex_count;
                         frame_stats.upload_bytes += prev_vb_size;
                     }
 
                     const float4x4 prev_M =
-                        pretransform_prev ? scene_graph[node_id]->prev_global_transform.value_or(M)
+                        pretransform_prev ? get_prev_global_transform(node_id)
                                           : float4x4(identity());
-                    vertex_jobs.push_back(TransformVertexJob{
-                        .src = vertex_src_addr,
-                        .dst = info.vertex_buffer.get_device_address(),
-                        .prev_dst =
-                            pretransform_prev ? info.prev_vertex_buffer.get_device_address() : 0,
-                        .transform = pretransform_mesh ? M : float4x4(identity()),
-                        .inverse_transposed = pretransform_mesh ? M_it : float4x4(identity()),
-                        .prev_transform = prev_M,
-                        .vertex_count = vertex_count,
-                        ._pad = {},
-                    });
-                    max_vertex_count_in_jobs = std::max(max_vertex_count_in_jobs, vertex_count);
+                    for (const VertexRange& range : vertex_ranges) {
+                        vertex_jobs.push_back(TransformVertexJob{
+                            .src = range.src,
+                            .dst = info.vertex_buffer.get_device_address() +
+                                   range.first * sizeof(PackedVertexData),
+                            .prev_dst = pretransform_prev
+                                            ? info.prev_vertex_buffer.get_device_address() +
+                                                  range.first * sizeof(PackedPrevVertexData)
+                                            : 0,
+                            .transform = pretransform_mesh ? M : float4x4(identity()),
+                            .inverse_transposed =
+                                pretransform_mesh ? M_it : float4x4(identity()),
+                            .prev_transform = prev_M,
+                            .vertex_count = range.count,
+                            ._pad = {},
+                        });
+                        max_vertex_count_in_jobs = std::max(max_vertex_count_in_jobs, range.count);
+                    }
                     frame_stats.gpu_vertex_transforms++;
                     frame_stats.gpu_vertex_transform_vertices += vertex_count;
 
@@ -1609,6 +1909,15 @@ void Scene::upload_meshes(const CommandBufferHandle& cmd) {
                     ensure_region(info.index_buffer, shared_ib_suballoc, ib_size,
                                   size_for_index_type(mesh.index_type));
                     const vk::DeviceSize dst_offset = info.index_buffer.get_offset();
+                    // whole triangles per chunk
+                    const vk::DeviceSize index_size = 3 * size_for_index_type(mesh.index_type);
+                    const auto emit_indices = [&](const StagedRange& staged,
+                                                  const vk::DeviceSize offset,
+                                                  const vk::DeviceSize size) {
+                        auto& entry = index_copies[staged.buffer.get()];
+                        entry.first = staged.buffer;
+                        entry.second.push_back({staged.buffer_offset, dst_offset + offset, size});
+                    };
 
                     std::visit(
                         [&](auto&& src) {
@@ -1624,19 +1933,12 @@ void Scene::upload_meshes(const CommandBufferHandle& cmd) {
                                 entry.first = src.data;
                                 entry.second.push_back({src.offset, dst_offset, ib_size});
                             } else if constexpr (std::is_same_v<T, Mesh::HostPacked<void>>) {
-                                const auto staged = stage(ib_size, [&](void* dst) {
-                                    std::memcpy(dst, src.data, ib_size);
-                                });
-                                auto& entry = index_copies[staged.buffer.get()];
-                                entry.first = staged.buffer;
-                                entry.second.push_back({staged.buffer_offset, dst_offset, ib_size});
+                                stage(ib_size, index_size, src.data, no_fill, emit_indices);
                             } else {
                                 static_assert(std::is_same_v<T, Mesh::HostIndices>);
-                                const auto staged =
-                                    stage(ib_size, [&](void* dst) { src->write(dst); });
-                                auto& entry = index_copies[staged.buffer.get()];
-                                entry.first = staged.buffer;
-                                entry.second.push_back({staged.buffer_offset, dst_offset, ib_size});
+                                stage(
+                                    ib_size, index_size, nullptr,
+                                    [&](void* dst) { src->write(dst); }, emit_indices);
                             }
                         },
                         mesh.get_indices());
@@ -1669,13 +1971,108 @@ void Scene::upload_meshes(const CommandBufferHandle& cmd) {
     }
 }
 
+namespace {
+
+// Fixed cost of a BLAS build in primitives, keeps many tiny builds from filling a frame.
+constexpr uint64_t BLAS_BUILD_OVERHEAD_PRIMITIVES = 4096;
+
+} // namespace
+
+std::vector<Scene::BLASBuildMode> Scene::schedule_blas_builds() {
+    std::vector<BLASBuildMode> modes(mesh_groups.size(), BLASBuildMode::BUILD);
+
+    // Update-eligible groups (morphed, fixed topology, existing BLAS) are refit. The least
+    // recently built of them are rebuilt instead to restore the BVH quality.
+    std::vector<MeshGroupID> update_eligible;
+    for (MeshGroupID group_id = 0; group_id < mesh_groups.size(); group_id++) {
+        const MeshGroup& group = mesh_groups[group_id];
+        if (group.blas && group.blas_dirty &&
+            (group.blas_build_flags & vk::BuildAccelerationStructureFlagBitsKHR::eAllowUpdate)) {
+            update_eligible.push_back(group_id);
+            modes[group_id] = BLASBuildMode::UPDATE;
+        }
+    }
+    const uint32_t eligible_count = static_cast<uint32_t>(update_eligible.size());
+    const uint32_t rebuild_count =
+        static_cast<uint32_t>(std::ceil(eligible_count * blas_rebuild_fraction));
+    if (rebuild_count < eligible_count) {
+        std::sort(update_eligible.begin(), update_eligible.end(),
+                  [&](MeshGroupID a, MeshGroupID b) {
+                      return mesh_groups[a].blas_last_built_frame <
+                             mesh_groups[b].blas_last_built_frame;
+                  });
+    }
+    for (uint32_t i = 0; i < rebuild_count; i++) {
+        modes[update_eligible[i]] = BLASBuildMode::BUILD;
+    }
+
+    if (blas_build_budget_kprims == 0) {
+        return modes;
+    }
+
+    struct Candidate {
+        MeshGroupID group_id;
+        // 0: the group had a BLAS and is inactive in the TLAS until rebuilt, 1: new BLAS,
+        // 2: rebuild of an update-eligible group, which is refit if deferred
+        uint32_t priority;
+        float camera_distance;
+        uint64_t cost;
+    };
+    std::vector<Candidate> candidates;
+
+    const float3 camera_position = get_active_camera()->get_position();
+    for (MeshGroupID group_id = 0; group_id < mesh_groups.size(); group_id++) {
+        const MeshGroup& group = mesh_groups[group_id];
+        if ((group.blas && !group.blas_dirty) || modes[group_id] != BLASBuildMode::BUILD) {
+            // built or updated in place
+            continue;
+        }
+
+        uint64_t cost = BLAS_BUILD_OVERHEAD_PRIMITIVES;
+        for (const MeshID mesh_id : group.meshes) {
+            cost += mesh_infos[mesh_id].mesh->get_primitive_count();
+        }
+        // No bounds per mesh are available, the instance origins approximate the distance.
+        float camera_distance = std::numeric_limits<float>::max();
+        for (const NodeID node_id : group.get_instances(mesh_infos)) {
+            const float4x4& t = get_global_transform(node_id);
+            camera_distance = std::min(
+                camera_distance, length(float3(t[0][3], t[1][3], t[2][3]) - camera_position));
+        }
+        const bool can_update =
+            group.blas &&
+            (group.blas_build_flags & vk::BuildAccelerationStructureFlagBitsKHR::eAllowUpdate);
+        const uint32_t priority = can_update ? 2 : (group.blas ? 0 : 1);
+        candidates.push_back({group_id, priority, camera_distance, cost});
+    }
+
+    std::ranges::sort(candidates, [](const Candidate& a, const Candidate& b) {
+        return std::tie(a.priority, a.camera_distance) < std::tie(b.priority, b.camera_distance);
+    });
+
+    // The first candidate is always built to guarantee progress.
+    const uint64_t budget = uint64_t(blas_build_budget_kprims) * 1000;
+    uint64_t spent = 0;
+    for (const Candidate& candidate : candidates) {
+        if (spent > 0 && spent + candidate.cost > budget) {
+            modes[candidate.group_id] =
+                candidate.priority == 2 ? BLASBuildMode::UPDATE : BLASBuildMode::DEFER;
+        } else {
+            spent += candidate.cost;
+        }
+    }
+
+    return modes;
+}
+
 void Scene::build_blas(const CommandBufferHandle& cmd) {
     MERIAN_PROFILE_SCOPE_GPU(cmd, "Scene::build_blas");
 
     blas_geometries.assign(mesh_groups.size(), {});
+    const std::vector<BLASBuildMode> modes = schedule_blas_builds();
 
     bool did_build_static = false;
-    std::vector<MeshGroupID> update_eligible;
+    std::vector<AccelerationStructureHandle> compaction_candidates;
 
     for (MeshGroupID group_id = 0; group_id < mesh_groups.size(); group_id++) {
         MeshGroup& group = mesh_groups[group_id];
@@ -1683,6 +2080,10 @@ void Scene::build_blas(const CommandBufferHandle& cmd) {
             continue;
         }
         tlas_dirty = true;
+        if (modes[group_id] == BLASBuildMode::DEFER) {
+            frame_stats.blas_builds_deferred++;
+            continue;
+        }
 
         auto& blas_geometry = blas_geometries[group_id];
 
@@ -1714,12 +2115,18 @@ void Scene::build_blas(const CommandBufferHandle& cmd) {
             blas_geometry.ranges.push_back(range);
         }
 
-        const bool can_update =
-            group.blas &&
-            (group.blas_build_flags & vk::BuildAccelerationStructureFlagBitsKHR::eAllowUpdate);
+        if (!group.cached_blas_size_info) {
+            group.cached_blas_size_info = as_builder.get_size_info(
+                blas_geometry.geometries, blas_geometry.ranges, group.blas_build_flags);
+        }
+        const auto& size_info = *group.cached_blas_size_info;
 
-        if (can_update) {
-            update_eligible.push_back(group_id);
+        if (modes[group_id] == BLASBuildMode::UPDATE) {
+            as_builder.queue_update(blas_geometry.geometries, blas_geometry.ranges, group.blas,
+                                    size_info, group.blas_build_flags);
+            group.blas_dirty = false;
+            group.blas_last_updated_frame = current_frame;
+            frame_stats.blas_updates++;
             continue;
         }
 
@@ -1727,12 +2134,6 @@ void Scene::build_blas(const CommandBufferHandle& cmd) {
         if (static_geometry)
             did_build_static = true;
 
-        if (!group.cached_blas_size_info) {
-            group.cached_blas_size_info = as_builder.get_size_info(
-                blas_geometry.geometries, blas_geometry.ranges, group.blas_build_flags);
-        }
-        const auto& size_info = *group.cached_blas_size_info;
-
         if (!group.blas || group.blas->get_size() < size_info.accelerationStructureSize) {
             group.blas = allocator->create_acceleration_structure(
                 vk::AccelerationStructureTypeKHR::eBottomLevel, size_info,
@@ -1745,121 +2146,218 @@ void Scene::build_blas(const CommandBufferHandle& cmd) {
         group.blas_last_built_frame = current_frame;
         group.blas_last_updated_frame = current_frame;
         frame_stats.blas_builds++;
+        for (const auto& range : blas_geometry.ranges) {
+            frame_stats.blas_build_primitives += range.primitiveCount;
+        }
         if (static_geometry)
             frame_stats.blas_builds_static++;
         else
             frame_stats.blas_builds_dynamic++;
+        if (group.blas_build_flags & vk::BuildAccelerationStructureFlagBitsKHR::eAllowCompaction)
+            compaction_candidates.push_back(group.blas);
     }
 
-    // Partial rebuild for update-eligible groups (morphed, fixed topology, existing BLAS)
-    if (!update_eligible.empty()) {
-        const uint32_t eligible_count = static_cast<uint32_t>(update_eligible.size());
-        const uint32_t rebuild_count =
-            static_cast<uint32_t>(std::ceil(eligible_count * blas_rebuild_fraction));
+    as_builder.get_cmds_blas(cmd, as_scratch_buffer);
 
-        if (rebuild_count < eligible_count) {
-            std::sort(update_eligible.begin(), update_eligible.end(),
-                      [&](MeshGroupID a, MeshGroupID b) {
-                          return mesh_groups[a].blas_last_built_frame <
-                                 mesh_groups[b].blas_last_built_frame;
-                      });
+    // Query the compacted sizes of the static BLASes, the builds are synchronized by the barrier
+    // of get_cmds_blas. compact_blas() picks the results up in a later frame without waiting.
+    if (!compaction_candidates.empty()) {
+        PendingBLASCompaction& pending = pending_blas_compactions.emplace_back();
+        pending.query_pool =
+            QueryPool<vk::QueryType::eAccelerationStructureCompactedSizeKHR>::create(
+                context, static_cast<uint32_t>(compaction_candidates.size()));
+        cmd->reset(pending.query_pool);
+        cmd->write_acceleration_structures_properties(pending.query_pool, compaction_candidates);
+        for (const auto& blas : compaction_candidates) {
+            pending.blases.emplace_back(blas, current_frame);
         }
+    }
 
-        for (uint32_t i = 0; i < eligible_count; i++) {
-            const MeshGroupID group_id = update_eligible[i];
-            MeshGroup& group = mesh_groups[group_id];
-            auto& blas_geometry = blas_geometries[group_id];
+    if (did_build_static && as_scratch_buffer &&
+        as_scratch_buffer->get_size() > MIN_BUFFER_CAPACITY) {
+        as_scratch_buffer.reset();
+    }
+}
 
-            if (!group.cached_blas_size_info) {
-                group.cached_blas_size_info = as_builder.get_size_info(
-                    blas_geometry.geometries, blas_geometry.ranges, group.blas_build_flags);
-            }
-            const auto& size_info = *group.cached_blas_size_info;
+void Scene::compact_blas(const CommandBufferHandle& cmd) {
+    if (pending_blas_compactions.empty()) {
+        return;
+    }
+    MERIAN_PROFILE_SCOPE_GPU(cmd, "Scene::compact_blas");
 
-            if (i < rebuild_count) {
-                if (group.blas->get_size() < size_info.accelerationStructureSize) {
-                    group.blas = allocator->create_acceleration_structure(
-                        vk::AccelerationStructureTypeKHR::eBottomLevel, size_info,
-                        fmt::format("Scene::blas[{}]", group_id));
-                }
-                as_builder.queue_build(blas_geometry.geometries, blas_geometry.ranges, group.blas,
-                                       size_info, group.blas_build_flags);
-                group.blas_last_built_frame = current_frame;
-                frame_stats.blas_builds++;
-                frame_stats.blas_builds_dynamic++;
-            } else {
-                as_builder.queue_update(blas_geometry.geometries, blas_geometry.ranges, group.blas,
-                                        size_info, group.blas_build_flags);
-                frame_stats.blas_updates++;
-            }
-            group.blas_dirty = false;
-            group.blas_last_updated_frame = current_frame;
+    // BLAS -> group, the group ids change with every regroup.
+    std::unordered_map<const AccelerationStructure*, MeshGroupID> group_of;
+    for (MeshGroupID group_id = 0; group_id < mesh_groups.size(); group_id++) {
+        if (mesh_groups[group_id].blas) {
+            group_of.emplace(mesh_groups[group_id].blas.get(), group_id);
         }
     }
 
-    as_builder.get_cmds_blas(cmd, as_scratch_buffer);
+    bool did_compact = false;
+    for (auto it = pending_blas_compactions.begin(); it != pending_blas_compactions.end();) {
+        // Only the pending entry references the pool: the command pool was reset, the results
+        // are available.
+        if (it->query_pool.use_count() > 1) {
+            ++it;
+            continue;
+        }
 
-    if (did_build_static && as_scratch_buffer &&
-        as_scratch_buffer->get_size() > MIN_BUFFER_CAPACITY) {
-        as_scratch_buffer.reset();
+        const std::vector<vk::DeviceSize> compacted_sizes =
+            it->query_pool->get_query_pool_results<vk::DeviceSize>(vk::QueryResultFlagBits::e64);
+
+        for (uint32_t i = 0; i < it->blases.size(); i++) {
+            const AccelerationStructureHandle blas = it->blases[i].first.lock();
+            if (!blas) {
+                continue;
+            }
+            const auto group_it = group_of.find(blas.get());
+            if (group_it == group_of.end()) {
+                continue;
+            }
+            const MeshGroupID group_id = group_it->second;
+            MeshGroup& group = mesh_groups[group_id];
+            if (group.blas_last_built_frame != it->blases[i].second || group.blas_dirty ||
+                compacted_sizes[i] == 0 || compacted_sizes[i] >= blas->get_size()) {
+                // rebuilt or about to be rebuilt since the query, or nothing to gain
+                continue;
+            }
+
+            vk::AccelerationStructureBuildSizesInfoKHR size_info;
+            size_info.accelerationStructureSize = compacted_sizes[i];
+            AccelerationStructureHandle compacted = allocator->create_acceleration_structure(
+                vk::AccelerationStructureTypeKHR::eBottomLevel, size_info,
+                fmt::format("Scene::blas[{}] (compacted)", group_id));
+            cmd->copy_acceleration_structure(blas, compacted,
+                                             vk::CopyAccelerationStructureModeKHR::eCompact);
+
+            const vk::DeviceSize saved = blas->get_size() - compacted->get_size();
+            frame_stats.blas_compactions++;
+            frame_stats.blas_compaction_saved_bytes += saved;
+            blas_compaction_saved_bytes += saved;
+
+            group_of.erase(group_it);
+            pending_blas_releases.push_back(std::move(group.blas));
+            group.blas = std::move(compacted);
+            did_compact = true;
+        }
+
+        it = pending_blas_compactions.erase(it);
+    }
+
+    if (did_compact) {
+        // the TLAS references the BLAS by address
+        tlas_dirty = true;
+        cmd->barrier(vk::MemoryBarrier2{
+            vk::PipelineStageFlagBits2::eAccelerationStructureCopyKHR,
+            vk::AccessFlagBits2::eAccelerationStructureWriteKHR,
+            vk::PipelineStageFlagBits2::eAccelerationStructureBuildKHR |
+                vk::PipelineStageFlagBits2::eAllCommands,
+            vk::AccessFlagBits2::eAccelerationStructureReadKHR,
+        });
     }
 }
 
 void Scene::build_tlas(const CommandBufferHandle& cmd) {
     MERIAN_PROFILE_SCOPE_GPU(cmd, "Scene::build_tlas");
 
-    tlas_instances.clear();
-    // we set this such that GeometryData index is InstanceID + GeometryIndex.
-    uint32_t instance_id = 0;
+    // Instance slots only change with regrouping. Otherwise only the instances of moved nodes and
+    // of groups whose BLAS was reallocated are rewritten.
+    const bool regenerate = needs_regroup || tlas_group_first_instance.size() != mesh_groups.size();
+    std::vector<uint32_t> dirty_instances;
+    bool activation_changed = false;
 
-    for (uint32_t group_id = 0; group_id < mesh_groups.size(); group_id++) {
-        // iterate in the same way as upload_geometry_data_and_transforms!
+    if (regenerate) {
+        tlas_instances.clear();
+        tlas_instance_nodes.clear();
+        tlas_group_first_instance.clear();
+        tlas_group_blas_address.clear();
 
-        const auto& group = mesh_groups[group_id];
-        assert(group.blas);
+        // we set this such that GeometryData index is InstanceID + GeometryIndex.
+        uint32_t instance_id = 0;
 
-        for (NodeID node_id : group.get_instances(mesh_infos)) {
-            vk::AccelerationStructureInstanceKHR tlas_instance{};
+        for (uint32_t group_id = 0; group_id < mesh_groups.size(); group_id++) {
+            // iterate in the same way as upload_geometry_data_and_transforms!
 
-            tlas_instance.instanceCustomIndex = instance_id;
-            tlas_instance.mask = group.instance_mask;
-            tlas_instance.accelerationStructureReference =
-                group.blas->get_acceleration_structure_device_address();
+            const auto& group = mesh_groups[group_id];
 
-            if (group.is_pretransformed(mesh_infos, pretransform_animated)) {
-                // Use identity
-                tlas_instance.transform.matrix[0][0] = 1.f;
-                tlas_instance.transform.matrix[1][1] = 1.f;
-                tlas_instance.transform.matrix[2][2] = 1.f;
-            } else {
-                const auto& t = get_global_transform(node_id);
-                for (int row = 0; row < 3; row++)
-                    for (int col = 0; col < 4; col++)
-                        tlas_instance.transform.matrix[row][col] = t[row][col];
-            }
+            tlas_group_first_instance.push_back(static_cast<uint32_t>(tlas_instances.size()));
+            tlas_group_blas_address.push_back(group.get_tlas_blas_address());
+
+            const bool pretransform = group.is_pretransformed(mesh_infos, pretransform_animated);
+
+            for (NodeID node_id : group.get_instances(mesh_infos)) {
+                vk::AccelerationStructureInstanceKHR tlas_instance{};
+
+                tlas_instance.instanceCustomIndex = instance_id;
+                tlas_instance.mask = group.instance_mask;
+                tlas_instance.accelerationStructureReference = tlas_group_blas_address.back();
+
+                if (pretransform) {
+                    // Use identity
+                    tlas_instance.transform.matrix[0][0] = 1.f;
+                    tlas_instance.transform.matrix[1][1] = 1.f;
+                    tlas_instance.transform.matrix[2][2] = 1.f;
+                } else {
+                    set_instance_transform(tlas_instance, get_global_transform(node_id));
+                }
 
-            vk::GeometryInstanceFlagsKHR geometry_instance_flags{};
-            if (group.flags & MeshFlags::FlipFacing) {
-                geometry_instance_flags |= vk::GeometryInstanceFlagBitsKHR::eTriangleFlipFacing;
+                vk::GeometryInstanceFlagsKHR geometry_instance_flags{};
+                if (group.flags & MeshFlags::FlipFacing) {
+                    geometry_instance_flags |=
+                        vk::GeometryInstanceFlagBitsKHR::eTriangleFlipFacing;
+                }
+                if (group.flags & MeshFlags::TwoSided) {
+                    geometry_instance_flags |=
+                        vk::GeometryInstanceFlagBitsKHR::eTriangleFacingCullDisable;
+                }
+                if (group.all_opaque) {
+                    geometry_instance_flags |= vk::GeometryInstanceFlagBitsKHR::eForceOpaque;
+                }
+                tlas_instance.setFlags(geometry_instance_flags);
+
+                tlas_instances.emplace_back(tlas_instance);
+                tlas_instance_nodes.emplace_back(node_id);
+                instance_id += static_cast<uint32_t>(group.meshes.size());
             }
-            if (group.flags & MeshFlags::TwoSided) {
-                geometry_instance_flags |=
-                    vk::GeometryInstanceFlagBitsKHR::eTriangleFacingCullDisable;
+        }
+    } else {
+        // moved nodes of groups that are not pretransformed, see upload_transforms
+        for (const uint32_t slot : tlas_moved_instances) {
+            set_instance_transform(tlas_instances[slot],
+                                   get_global_transform(tlas_instance_nodes[slot]));
+        }
+        dirty_instances = std::move(tlas_moved_instances);
+
+        for (uint32_t group_id = 0; group_id < mesh_groups.size(); group_id++) {
+            const vk::DeviceAddress address = mesh_groups[group_id].get_tlas_blas_address();
+            if (address == tlas_group_blas_address[group_id]) {
+                continue;
             }
-            if (group.all_opaque) {
-                geometry_instance_flags |= vk::GeometryInstanceFlagBitsKHR::eForceOpaque;
+            // updates must keep the active / inactive state of the instances
+            activation_changed |= (address == 0) != (tlas_group_blas_address[group_id] == 0);
+            tlas_group_blas_address[group_id] = address;
+
+            const uint32_t end = group_id + 1 < mesh_groups.size()
+                                     ? tlas_group_first_instance[group_id + 1]
+                                     : static_cast<uint32_t>(tlas_instances.size());
+            for (uint32_t slot = tlas_group_first_instance[group_id]; slot < end; slot++) {
+                tlas_instances[slot].accelerationStructureReference = address;
+                dirty_instances.push_back(slot);
             }
-            tlas_instance.setFlags(geometry_instance_flags);
-
-            tlas_instances.emplace_back(tlas_instance);
-            instance_id += static_cast<uint32_t>(group.meshes.size());
         }
+
+        std::ranges::sort(dirty_instances);
+        const auto [first, last] = std::ranges::unique(dirty_instances);
+        dirty_instances.erase(first, last);
     }
+    tlas_moved_instances.clear();
 
     // empty buffers are not allowed, but we need a buffer to build an empty TLAS.
     const vk::DeviceSize tlas_instances_size = std::max((std::size_t)1, tlas_instances.size()) *
                                                sizeof(vk::AccelerationStructureInstanceKHR);
+    bool full_upload = regenerate;
     if (!tlas_instances_buffer || tlas_instances_buffer->get_size() < tlas_instances_size) {
+        full_upload = true;
         cmd->keep_until_pool_reset(std::move(tlas_instances_buffer));
         tlas_instances_buffer = allocator->create_buffer(
             tlas_instances_size,
@@ -1869,7 +2367,16 @@ void Scene::build_tlas(const CommandBufferHandle& cmd) {
             MemoryMappingType::NONE, "Scene::tlas_instances");
     }
 
-    allocator->get_staging()->cmd_to_device(cmd, tlas_instances_buffer, tlas_instances);
+    // Past half of the instances the scattered copies do not pay off.
+    if (full_upload || dirty_instances.size() * 2 > tlas_instances.size()) {
+        allocator->get_staging()->cmd_to_device(cmd, tlas_instances_buffer, tlas_instances);
+        frame_stats.tlas_instances_uploaded = static_cast<uint32_t>(tlas_instances.size());
+    } else if (!dirty_instances.empty()) {
+        upload_tlas_instances(cmd, dirty_instances);
+        frame_stats.tlas_instances_uploaded = static_cast<uint32_t>(dirty_instances.size());
+    }
+    frame_stats.tlas_instance_data_bytes = vk::DeviceSize(frame_stats.tlas_instances_uploaded) *
+                                           sizeof(vk::AccelerationStructureInstanceKHR);
 
     cmd->barrier(tlas_instances_buffer->buffer_barrier2(
         vk::PipelineStageFlagBits2::eTransfer,
@@ -1877,25 +2384,71 @@ void Scene::build_tlas(const CommandBufferHandle& cmd) {
         vk::AccessFlagBits2::eTransferWrite,
         vk::AccessFlagBits2::eAccelerationStructureReadKHR | vk::AccessFlagBits2::eShaderRead));
 
+    vk::BuildAccelerationStructureFlagsKHR build_flags =
+        vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace;
+    if (tlas_refit) {
+        build_flags |= vk::BuildAccelerationStructureFlagBitsKHR::eAllowUpdate;
+    }
+
     const auto size_info =
-        as_builder.get_size_info(tlas_instances.size(), tlas_instances_buffer,
-                                 vk::BuildAccelerationStructureFlagBitsKHR::ePreferFastTrace);
+        as_builder.get_size_info(tlas_instances.size(), tlas_instances_buffer, build_flags);
+    // An update needs the same instance count and flags as the last build.
+    bool refit = tlas_refit && !regenerate && !activation_changed && tlas &&
+                 tlas_build_flags == build_flags &&
+                 (tlas_rebuild_interval == 0 || tlas_refits_since_build < tlas_rebuild_interval);
     if (!tlas || tlas->get_size() < size_info.accelerationStructureSize) {
         // cannot reuse and needs to be allcated
         tlas = allocator->create_acceleration_structure(vk::AccelerationStructureTypeKHR::eTopLevel,
                                                         size_info);
         shader_object->get_cursor()["as"]["as"] = tlas;
+        refit = false;
     }
 
-    as_builder.queue_build(tlas_instances.size(), tlas_instances_buffer, tlas, size_info);
+    if (refit) {
+        as_builder.queue_update(tlas_instances.size(), tlas_instances_buffer, tlas, size_info,
+                                build_flags);
+        tlas_refits_since_build++;
+        frame_stats.tlas_refit = true;
+    } else {
+        as_builder.queue_build(tlas_instances.size(), tlas_instances_buffer, tlas, size_info,
+                               build_flags);
+        tlas_build_flags = build_flags;
+        tlas_refits_since_build = 0;
+        frame_stats.tlas_rebuilt = true;
+    }
+    frame_stats.tlas_instance_count = static_cast<uint32_t>(tlas_instances.size());
     as_builder.get_cmds_tlas(cmd, as_scratch_buffer);
 }
 
+void Scene::upload_tlas_instances(const CommandBufferHandle& cmd,
+                                  const std::vector<uint32_t>& slots) {
+    assert(std::ranges::is_sorted(slots));
+    std::vector<vk::BufferCopy> copies =
+        slot_copy_runs(slots, sizeof(vk::AccelerationStructureInstanceKHR));
+
+    BufferHandle buffer;
+    vk::DeviceSize buffer_offset = 0;
+    const MemoryAllocationHandle memory = allocator->get_staging()->get_upload_staging_space(
+        slots.size() * sizeof(vk::AccelerationStructureInstanceKHR), buffer, buffer_offset);
+    cmd->keep_until_pool_reset(buffer);
+    auto* data = static_cast<vk::AccelerationStructureInstanceKHR*>(memory->map());
+    for (const uint32_t slot : slots) {
+        *data++ = tlas_instances[slot];
+    }
+    memory->unmap();
+
+    for (vk::BufferCopy& copy : copies) {
+        copy.srcOffset += buffer_offset;
+    }
+    cmd->copy(buffer, tlas_instances_buffer, copies);
+}
+
 void Scene::update(const CommandBufferHandle& cmd,
                    const float time,
                    const float time_diff,
                    const uint32_t frame) {
     MERIAN_PROFILE_SCOPE_GPU(cmd, "Scene::update");
+    const MemoryOwnerScope memory_owner{"Scene"};
     current_frame = frame;
     frame_stats = {};
 
@@ -1913,6 +2466,11 @@ void Scene::update(const CommandBufferHandle& cmd,
     // rebuild once here so the per-frame uploads below write into the current object
     shader_object.get();
 
+    {
+        MERIAN_PROFILE_SCOPE("propagate_transforms");
+        transform_hierarchy.propagate();
+    }
+
     assert(!cameras.empty() &&
            "the scene implementation must ensure that there is at least one camera");
 
@@ -1959,20 +2517,15 @@ void Scene::update(const CommandBufferHandle& cmd,
         dispatch_batched_transforms(cmd);
     }
 
-    // Advance prev transforms after upload_meshes (prev-vertex jobs read them).
-    for (const NodeID& nid : node_ids) {
-        assert(scene_graph[nid]);
-        Node& n = *scene_graph[nid];
-        n.prev_global_transform = n.global_transform;
-        n.prev_global_inverse_transposed = n.global_inverse_transposed;
-    }
+    // Advance prev transforms after upload_meshes (prev-vertex jobs read them). Clears the moved
+    // flags.
+    transform_hierarchy.advance();
 
     // changes at regroup, or updated mesh (buffer address), or if material ids change -> run every
     // frame.
     upload_geometry_data(cmd);
 
     frame_stats.geometry_data_bytes = geometries.size() * sizeof(GeometryData);
-    frame_stats.transform_data_bytes = instance_transforms.size() * sizeof(float4x4) * 4;
 
     cmd->barrier(vk::MemoryBarrier2{
         vk::PipelineStageFlagBits2::eTransfer | vk::PipelineStageFlagBits2::eComputeShader,
@@ -1981,18 +2534,14 @@ void Scene::update(const CommandBufferHandle& cmd,
         vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eAccelerationStructureReadKHR,
     });
 
-    // TODO: compact static BLASes to reduce memory bandwidth.
     if (as_supported) {
+        compact_blas(cmd);
         build_blas(cmd);
 
         tlas_dirty |= needs_regroup || transforms_changed;
         if (tlas_dirty || !tlas) {
             build_tlas(cmd);
             tlas_dirty = false;
-            frame_stats.tlas_rebuilt = true;
-            frame_stats.tlas_instance_count = static_cast<uint32_t>(tlas_instances.size());
-            frame_stats.tlas_instance_data_bytes =
-                tlas_instances.size() * sizeof(vk::AccelerationStructureInstanceKHR);
         }
     }
 
@@ -2004,9 +2553,6 @@ void Scene::update(const CommandBufferHandle& cmd,
         vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eAccelerationStructureReadKHR,
     });
 
-    for (const NodeID& nid : node_ids) {
-        scene_graph[nid]->transform_dirty = false;
-    }
     last_update_changes.geometry_changed = needs_regroup;
     last_update_changes.transform_changed = transforms_changed;
     needs_regroup = false;
@@ -0,0 +1,243 @@
+#include "merian-shaders/scene/transform_hierarchy.hpp"
+
+#include "merian/utils/concurrent/utils.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace merian {
+
+namespace {
+
+template <typename T> void permute(std::vector<T>& values, const std::vector<uint32_t>& order) {
+    std::vector<T> sorted;
+    sorted.reserve(order.size());
+    for (const uint32_t old_slot : order) {
+        sorted.push_back(values[old_slot]);
+    }
+    values = std::move(sorted);
+}
+
+} // namespace
+
+void TransformHierarchy::add(const uint32_t id, const uint32_t parent, const float4x4& local) {
+    assert(!contains(id));
+    assert(parent == INVALID || contains(parent));
+
+    if (id >= slot_of.size()) {
+        slot_of.resize(id + 1, INVALID);
+    }
+    slot_of[id] = static_cast<uint32_t>(id_of.size());
+
+    id_of.push_back(id);
+    parent_id.push_back(parent);
+    parent_slot.push_back(INVALID);
+    depth.push_back(0);
+    propagated_in_pass.push_back(0);
+    flags.push_back(LOCAL_DIRTY | NEW);
+    this->local.push_back(local);
+    global.push_back(local);
+    global_inverse_transposed.emplace_back(identity());
+    prev_global.push_back(local);
+    prev_global_inverse_transposed.emplace_back(identity());
+
+    node_count++;
+    topology_dirty = true;
+}
+
+void TransformHierarchy::remove(const uint32_t id) {
+    const uint32_t s = slot(id);
+    flags[s] = REMOVED;
+    slot_of[id] = INVALID;
+
+    assert(node_count > 0);
+    node_count--;
+    topology_dirty = true;
+}
+
+void TransformHierarchy::set_local(const uint32_t id, const float4x4& local) {
+    const uint32_t s = slot(id);
+    this->local[s] = local;
+    flags[s] |= LOCAL_DIRTY;
+    // the depth is only known for sorted slots, sort() recomputes the level otherwise
+    if (!topology_dirty) {
+        first_dirty_level = std::min(first_dirty_level, depth[s]);
+    }
+}
+
+void TransformHierarchy::clear() {
+    *this = TransformHierarchy();
+}
+
+void TransformHierarchy::propagate() {
+    if (topology_dirty) {
+        sort();
+    }
+    if (first_dirty_level == INVALID) {
+        return;
+    }
+
+    pass++;
+    for (uint32_t level = first_dirty_level; level + 1 < level_offsets.size(); level++) {
+        const uint32_t begin = level_offsets[level];
+        const uint32_t count = level_offsets[level + 1] - begin;
+
+        if (count >= PARALLEL_LEVEL_SIZE) {
+            parallel_for(
+                count, [&](const uint32_t index) { propagate_slot(begin + index); },
+                get_default_thread_pool());
+        } else {
+            for (uint32_t s = begin; s < begin + count; s++) {
+                propagate_slot(s);
+            }
+        }
+    }
+
+    first_dirty_level = INVALID;
+}
+
+void TransformHierarchy::advance() {
+    propagate();
+
+    for (uint32_t s = 0; s < flags.size(); s++) {
+        if ((flags[s] & MOVED) != 0) {
+            prev_global[s] = global[s];
+            prev_global_inverse_transposed[s] = global_inverse_transposed[s];
+            flags[s] &= ~MOVED;
+        }
+    }
+}
+
+// -----------------------------------------------------------
+
+const float4x4& TransformHierarchy::get_local(const uint32_t id) const {
+    return local[slot(id)];
+}
+
+const float4x4& TransformHierarchy::get_global(const uint32_t id) {
+    propagate();
+    return global[slot(id)];
+}
+
+const float4x4& TransformHierarchy::get_global_inverse_transposed(const uint32_t id) {
+    propagate();
+    return global_inverse_transposed[slot(id)];
+}
+
+const float4x4& TransformHierarchy::get_prev_global(const uint32_t id) {
+    propagate();
+    return prev_global[slot(id)];
+}
+
+const float4x4& TransformHierarchy::get_prev_global_inverse_transposed(const uint32_t id) {
+    propagate();
+    return prev_global_inverse_transposed[slot(id)];
+}
+
+bool TransformHierarchy::is_moved(const uint32_t id) {
+    propagate();
+    return (flags[slot(id)] & MOVED) != 0;
+}
+
+// -----------------------------------------------------------
+
+uint32_t TransformHierarchy::slot(const uint32_t id) const {
+    assert(contains(id));
+    return slot_of[id];
+}
+
+void TransformHierarchy::sort() {
+    const uint32_t slot_count = static_cast<uint32_t>(id_of.size());
+
+    // Resolve depths by walking up to the first ancestor with known depth.
+    std::vector<uint32_t> slot_depth(slot_count, INVALID);
+    std::vector<uint32_t> path;
+    uint32_t max_depth = 0;
+    for (uint32_t s = 0; s < slot_count; s++) {
+        if ((flags[s] & REMOVED) != 0) {
+            continue;
+        }
+
+        uint32_t current = s;
+        while (slot_depth[current] == INVALID && parent_id[current] != INVALID) {
+            path.push_back(current);
+            current = slot_of[parent_id[current]];
+            assert(current != INVALID && "parents must be removed after their children");
+        }
+        if (slot_depth[current] == INVALID) {
+            slot_depth[current] = 0;
+        }
+        for (; !path.empty(); path.pop_back()) {
+            slot_depth[path.back()] = slot_depth[current] + 1;
+            current = path.back();
+        }
+        max_depth = std::max(max_depth, slot_depth[s]);
+    }
+
+    // Counting sort by depth, keeps the insertion order within a level.
+    level_offsets.assign(node_count > 0 ? max_depth + 2 : 0, 0);
+    for (uint32_t s = 0; s < slot_count; s++) {
+        if (slot_depth[s] != INVALID) {
+            level_offsets[slot_depth[s] + 1]++;
+        }
+    }
+    for (uint32_t level = 1; level < level_offsets.size(); level++) {
+        level_offsets[level] += level_offsets[level - 1];
+    }
+    std::vector<uint32_t> order(node_count);
+    std::vector<uint32_t> cursor(level_offsets);
+    for (uint32_t s = 0; s < slot_count; s++) {
+        if (slot_depth[s] != INVALID) {
+            order[cursor[slot_depth[s]]++] = s;
+        }
+    }
+
+    permute(id_of, order);
+    permute(parent_id, order);
+    permute(flags, order);
+    permute(local, order);
+    permute(global, order);
+    permute(global_inverse_transposed, order);
+    permute(prev_global, order);
+    permute(prev_global_inverse_transposed, order);
+    permute(propagated_in_pass, order);
+    permute(slot_depth, order);
+    depth = std::move(slot_depth);
+
+    first_dirty_level = INVALID;
+    parent_slot.resize(node_count);
+    for (uint32_t s = 0; s < node_count; s++) {
+        slot_of[id_of[s]] = s;
+    }
+    for (uint32_t s = 0; s < node_count; s++) {
+        parent_slot[s] = parent_id[s] == INVALID ? INVALID : slot_of[parent_id[s]];
+        if ((flags[s] & LOCAL_DIRTY) != 0) {
+            first_dirty_level = std::min(first_dirty_level, depth[s]);
+        }
+    }
+    while (!slot_of.empty() && slot_of.back() == INVALID) {
+        slot_of.pop_back();
+    }
+
+    topology_dirty = false;
+}
+
+void TransformHierarchy::propagate_slot(const uint32_t slot) {
+    uint8_t& slot_flags = flags[slot];
+    const uint32_t parent = parent_slot[slot];
+    if ((slot_flags & LOCAL_DIRTY) == 0 &&
+        (parent == INVALID || propagated_in_pass[parent] != pass)) {
+        return;
+    }
+
+    global[slot] = parent == INVALID ? local[slot] : mul(global[parent], local[slot]);
+    global_inverse_transposed[slot] = inverse(transpose(global[slot]));
+    if ((slot_flags & NEW) != 0) {
+        prev_global[slot] = global[slot];
+        prev_global_inverse_transposed[slot] = global_inverse_transposed[slot];
+    }
+    slot_flags = MOVED;
+    propagated_in_pass[slot] = pass;
+}
+
+} // namespace merian
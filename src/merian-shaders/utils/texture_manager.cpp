@@ -75,7 +75,7 @@ void TextureManager::update(const CommandBufferHandle& cmd) {
     std::vector<ImageHandle> mip_images;
     mip_images.reserve(pending_uploads.size());
     for (const auto& copy : pending_uploads) {
-        cmd->copy(copy.src, copy.dst, copy.region);
+        allocator->get_staging()->cmd_copy(cmd, copy);
         mip_images.emplace_back(copy.dst);
     }
     cmd_generate_mipmaps(cmd, mip_images);
@@ -151,6 +151,7 @@ void TextureManager::set_texture_from_rgba8(const TextureID id,
                                             const vk::Filter min_filter,
                                             const bool srgb,
                                             const bool generate_mipmaps) {
+    const MemoryOwnerScope memory_owner{"TextureManager"};
     auto texture = allocator->create_texture_from_rgba8(
         cmd, data, width, height, address_mode, mag_filter, min_filter, srgb, "", generate_mipmaps);
     cmd->barrier(texture->get_image()->barrier2(vk::ImageLayout::eShaderReadOnlyOptimal));
@@ -212,6 +213,7 @@ TextureHandle TextureManager::stage_rgba8(const uint32_t* data,
                                           const vk::Filter min_filter,
                                           const bool srgb,
                                           const bool generate_mipmaps) {
+    const MemoryOwnerScope memory_owner{"TextureManager"};
     const uint32_t mip_levels =
         generate_mipmaps ? static_cast<uint32_t>(std::floor(std::log2(std::max(width, height))) + 1)
                          : 1u;
@@ -18,6 +18,7 @@ FrameCachingShaderObjectAllocator::FrameCachingShaderObjectAllocator(
 
 ShaderObjectAllocation
 FrameCachingShaderObjectAllocator::allocate(const ShaderObjectHandle& object) {
+    const std::lock_guard lock(cache_mutex);
     auto it = cache.find(object.get());
 
     if (it != cache.end()) {
@@ -47,6 +48,7 @@ void FrameCachingShaderObjectAllocator::set_iteration(const uint32_t iteration)
 }
 
 void FrameCachingShaderObjectAllocator::reset() {
+    const std::lock_guard lock(cache_mutex);
     cache.clear();
 }
 
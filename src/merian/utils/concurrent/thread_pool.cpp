@@ -1,72 +1,249 @@
 #include "merian/utils/concurrent/thread_pool.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <spdlog/spdlog.h>
+#include <utility>
 
 namespace merian {
 
-ThreadPool::ThreadPool(const uint32_t concurrency)
-    : wait_idle_barrier((ptrdiff_t)concurrency + 1, []() noexcept {}) {
-    assert(concurrency);
+namespace {
+// The pool and deque index of the calling thread, if it is a worker.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local uint32_t current_worker = 0;
+} // namespace
 
-    for (uint32_t i = threads.size(); i < concurrency; i++) {
-        threads.emplace_back([&] {
-            while (true) {
-                const std::optional<std::function<void()>> task = tasks.pop();
-                if (task) {
-                    (*task)();
-                } else {
-                    return;
-                }
-            }
-        });
-    }
+ThreadPool::ThreadPool(const uint32_t concurrency) {
+    assert(concurrency);
+    start_workers(concurrency);
 }
 
-ThreadPool::ThreadPool(ThreadPool&& other) noexcept
-    : wait_idle_barrier((ptrdiff_t)other.threads.size() + 1, []() noexcept {}) {
-    tasks = std::move(other.tasks);
+ThreadPool::ThreadPool(ThreadPool&& other) noexcept {
+    start_workers(other.threads.size());
 
-    for (uint32_t i = threads.size(); i < other.threads.size(); i++) {
-        threads.emplace_back([&] {
-            while (true) {
-                const std::optional<std::function<void()>> task = tasks.pop();
-                if (task) {
-                    task.value()();
-                } else {
-                    return;
-                }
-            }
-        });
+    // take over the tasks that were not started yet, the workers of other then run out of work.
+    while (std::optional<Task> task = other.take_task(other.threads.size())) {
+        other.active.fetch_sub(1);
+        execute(std::move(*task));
     }
 }
 
 ThreadPool::~ThreadPool() {
-    for (uint32_t i = 0; i < threads.size(); i++) {
-        tasks.push(std::nullopt);
+    {
+        std::lock_guard lk(sleep_mutex);
+        stop = true;
     }
+    sleep_cv.notify_all();
     for (auto& t : threads) {
         t.join();
     }
 }
 
+void ThreadPool::start_workers(const uint32_t concurrency) {
+    for (uint32_t i = 0; i <= concurrency; i++) {
+        queues.emplace_back(std::make_unique<TaskQueue>());
+    }
+    for (uint32_t i = 0; i < concurrency; i++) {
+        threads.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+void ThreadPool::worker_loop(const uint32_t worker_index) {
+    current_pool = this;
+    current_worker = worker_index;
+
+    while (true) {
+        if (std::optional<Task> task = take_task(worker_index)) {
+            run_task(*task);
+            continue;
+        }
+
+        std::unique_lock lk(sleep_mutex);
+        // pairs with the check of sleeping in execute(), both are sequentially consistent.
+        sleeping.fetch_add(1);
+        sleep_cv.wait(lk, [&] { return stop || pending.load() > 0; });
+        sleeping.fetch_sub(1);
+        if (stop && pending.load() == 0) {
+            // all tasks that were submitted before destruction were run
+            return;
+        }
+    }
+}
+
+void ThreadPool::execute(Task&& task) {
+    // counted before it is visible, takers must never see it without
+    pending.fetch_add(1);
+    if (is_worker_thread() || !injection_queue.try_push(std::move(task))) {
+        const uint32_t queue_index = is_worker_thread() ? current_worker : threads.size();
+        TaskQueue& queue = *queues[queue_index];
+        std::lock_guard lk(queue.mutex);
+        queue.tasks.emplace_back(std::move(task));
+    }
+
+    if (sleeping.load() > 0) {
+        // the worker checks pending under this lock before it waits
+        { std::lock_guard lk(sleep_mutex); }
+        sleep_cv.notify_one();
+    }
+}
+
+std::optional<Task> ThreadPool::take_task(const uint32_t worker_index) {
+    const uint32_t queue_count = queues.size();
+    const uint32_t injection_index = queue_count - 1;
+
+    const auto claim = [&](std::optional<Task>&& task) -> std::optional<Task> {
+        // counted active before it stops being pending, wait_idle must not see both at 0.
+        active.fetch_add(1);
+        if (pending.fetch_sub(1) == 1) {
+            notify_waiters();
+        }
+        return std::move(task);
+    };
+
+    const auto take = [&](const uint32_t index, const bool back) -> std::optional<Task> {
+        std::optional<Task> task;
+        {
+            TaskQueue& queue = *queues[index];
+            std::lock_guard lk(queue.mutex);
+            if (queue.tasks.empty()) {
+                return std::nullopt;
+            }
+            if (back) {
+                task.emplace(std::move(queue.tasks.back()));
+                queue.tasks.pop_back();
+            } else {
+                task.emplace(std::move(queue.tasks.front()));
+                queue.tasks.pop_front();
+            }
+        }
+        return claim(std::move(task));
+    };
+
+    if (pending.load() == 0) {
+        return std::nullopt;
+    }
+
+    // newest own task first (cache warm), then the oldest ones of the others
+    if (worker_index != injection_index) {
+        if (std::optional<Task> task = take(worker_index, true)) {
+            return task;
+        }
+    }
+    if (std::optional<Task> task = injection_queue.try_pop()) {
+        return claim(std::move(task));
+    }
+    if (std::optional<Task> task = take(injection_index, false)) {
+        return task;
+    }
+    for (uint32_t i = 1; i < queue_count; i++) {
+        const uint32_t victim = (worker_index + i) % injection_index;
+        if (victim == worker_index) {
+            continue;
+        }
+        if (std::optional<Task> task = take(victim, false)) {
+            return task;
+        }
+    }
+
+    return std::nullopt;
+}
+
+void ThreadPool::run_task(Task& task) {
+    try {
+        task();
+    } catch (const std::exception& e) {
+        SPDLOG_ERROR("uncaught exception in thread pool task: {}", e.what());
+    }
+    task.reset();
+
+    if (active.fetch_sub(1) == 1 && pending.load() == 0) {
+        notify_waiters();
+    }
+}
+
+void ThreadPool::notify_waiters() {
+    // the waiters check their condition under this lock before they wait
+    { std::lock_guard lk(sleep_mutex); }
+    idle_cv.notify_all();
+}
+
+bool ThreadPool::run_pending_task() {
+    const uint32_t worker_index = is_worker_thread() ? current_worker : threads.size();
+    if (std::optional<Task> task = take_task(worker_index)) {
+        run_task(*task);
+        return true;
+    }
+    return false;
+}
+
+bool ThreadPool::is_worker_thread() const {
+    return current_pool == this;
+}
+
 uint32_t ThreadPool::size() {
     return threads.size();
 }
 
 std::size_t ThreadPool::queue_size() {
-    return tasks.size();
+    return pending.load();
 }
 
 void ThreadPool::wait_idle() {
-    for (uint32_t i = 0; i < threads.size(); i++) {
-        submit<void>([this]() { wait_idle_barrier.arrive_and_wait(); });
-    }
-    wait_idle_barrier.arrive_and_wait();
+    assert(!is_worker_thread() && "wait_idle from a task of the same pool never returns");
+    std::unique_lock lk(sleep_mutex);
+    idle_cv.wait(lk, [&] { return pending.load() == 0 && active.load() == 0; });
 }
 
 void ThreadPool::wait_empty() {
-    tasks.wait_empty();
+    std::unique_lock lk(sleep_mutex);
+    idle_cv.wait(lk, [&] { return pending.load() == 0; });
+}
+
+ThreadPool& get_default_thread_pool() {
+    static ThreadPool thread_pool(std::max(1u, std::thread::hardware_concurrency()));
+    return thread_pool;
+}
+
+// ---------------------------------------------------------------------------------------
+
+TaskGroup::TaskGroup(ThreadPool& thread_pool) : thread_pool(thread_pool) {}
+
+TaskGroup::~TaskGroup() {
+    try {
+        wait();
+    } catch (...) {
+        // already reported by whoever waited first, or dropped on purpose
+    }
+}
+
+void TaskGroup::wait() {
+    while (outstanding.load() > 0) {
+        if (!thread_pool.run_pending_task()) {
+            // nothing to help with, the remaining tasks run on other threads
+            std::unique_lock lk(mutex);
+            cv.wait(lk, [&] { return outstanding.load() == 0 || thread_pool.queue_size() > 0; });
+        }
+    }
+
+    // finish() may still hold the lock, the group must outlive it
+    std::lock_guard lk(mutex);
+    if (exception) {
+        std::exception_ptr e = std::exchange(exception, nullptr);
+        std::rethrow_exception(e);
+    }
+}
+
+void TaskGroup::set_exception(std::exception_ptr exception) {
+    std::lock_guard lk(mutex);
+    if (!this->exception) {
+        this->exception = std::move(exception);
+    }
+}
+
+void TaskGroup::finish() {
+    std::lock_guard lk(mutex);
+    outstanding.fetch_sub(1);
+    cv.notify_all();
 }
 
 } // namespace merian
@@ -0,0 +1,55 @@
+#include "merian/vk/extension/extension_calibrated_timestamps.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace merian {
+
+DeviceSupportInfo
+ExtensionCalibratedTimestamps::query_device_support(const DeviceSupportQueryInfo& query_info) {
+    return DeviceSupportInfo::check(query_info, {}, {}, {},
+                                    {VK_KHR_CALIBRATED_TIMESTAMPS_EXTENSION_NAME});
+}
+
+void ExtensionCalibratedTimestamps::on_device_created(
+    const DeviceHandle& device, const ExtensionContainer& /*extension_container*/) {
+    this->device = device;
+
+    if (!device->extension_enabled(VK_KHR_CALIBRATED_TIMESTAMPS_EXTENSION_NAME)) {
+        SPDLOG_DEBUG("{} not supported", VK_KHR_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+        return;
+    }
+    const std::vector<vk::TimeDomainKHR> domains =
+        device->get_physical_device()->get_physical_device().getCalibrateableTimeDomainsKHR();
+    available = std::ranges::find(domains, vk::TimeDomainKHR::eDevice) != domains.end();
+    if (!available) {
+        SPDLOG_DEBUG("device time domain cannot be calibrated");
+    }
+}
+
+bool ExtensionCalibratedTimestamps::is_available() const {
+    return available;
+}
+
+std::optional<TimestampCalibration> ExtensionCalibratedTimestamps::calibrate() const {
+    if (!available) {
+        return std::nullopt;
+    }
+
+    // Only the device domain is sampled and the host time is taken around the call, the host
+    // domains differ between platforms and steady_clock does not expose which one it uses.
+    const vk::CalibratedTimestampInfoKHR info{vk::TimeDomainKHR::eDevice};
+    const auto before = std::chrono::steady_clock::now();
+    const auto [timestamps, deviation] =
+        device->get_device().getCalibratedTimestampsKHR(info);
+    const auto after = std::chrono::steady_clock::now();
+
+    return TimestampCalibration{
+        timestamps[0],
+        before + (after - before) / 2,
+        (after - before) / 2 + std::chrono::nanoseconds(deviation),
+    };
+}
+
+} // namespace merian
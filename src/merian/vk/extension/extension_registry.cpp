@@ -4,6 +4,7 @@
 #include "merian/plugin/plugins.hpp"
 #include "merian/shader/glsl_compiler_provider.hpp"
 
+#include "merian/vk/extension/extension_calibrated_timestamps.hpp"
 #include "merian/vk/extension/extension_compatibility.hpp"
 #include "merian/vk/extension/extension_device_fault.hpp"
 #include "merian/vk/extension/extension_glslang_compiler.hpp"
@@ -66,6 +67,7 @@ ExtensionRegistry::ExtensionRegistry() {
     register_extension<ExtensionVkLayerSettings>(ExtensionVkLayerSettings::name, true);
     register_extension<ExtensionVkValidationLayers>(ExtensionVkValidationLayers::name, false);
     register_extension<ExtensionDeviceFault>(ExtensionDeviceFault::name, false);
+    register_extension<ExtensionCalibratedTimestamps>(ExtensionCalibratedTimestamps::name, false);
     register_extension<ExtensionImGui>(ExtensionImGui::name, true);
 }
 
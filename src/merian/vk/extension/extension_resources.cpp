@@ -45,12 +45,26 @@ SamplerPoolHandle ExtensionResources::sampler_pool() {
 StagingMemoryManagerHandle ExtensionResources::staging() {
     if (_staging.expired()) {
         assert(!weak_context.expired());
-        auto ptr = std::make_shared<StagingMemoryManager>(memory_allocator());
+        auto ptr = std::make_shared<StagingMemoryManager>(
+            memory_allocator(), staging_block_size, vk::BufferUsageFlagBits::eTransferSrc,
+            vk::BufferUsageFlagBits::eTransferDst, staging_max_size, staging_stream_budget);
         _staging = ptr;
         return ptr;
     }
     return _staging.lock();
 }
+void ExtensionResources::set_staging_limits(const vk::DeviceSize max_size,
+                                            const vk::DeviceSize stream_budget) {
+    staging_max_size = max_size;
+    staging_stream_budget = stream_budget;
+    if (const StagingMemoryManagerHandle staging = _staging.lock()) {
+        staging->set_max_size(max_size);
+        staging->set_stream_budget(stream_budget);
+    }
+}
+void ExtensionResources::set_staging_block_size(const vk::DeviceSize block_size) {
+    staging_block_size = block_size;
+}
 DescriptorSetAllocatorHandle ExtensionResources::descriptor_pool() {
     if (_descriptor_pool.expired()) {
         assert(!weak_context.expired());
@@ -23,6 +23,9 @@ DeviceSupportInfo ExtensionVMA::query_device_support(const DeviceSupportQueryInf
     if (physical_device->extension_supported(VK_AMD_DEVICE_COHERENT_MEMORY_EXTENSION_NAME)) {
         info.required_extensions.emplace_back(VK_AMD_DEVICE_COHERENT_MEMORY_EXTENSION_NAME);
     }
+    if (physical_device->extension_supported(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+        info.required_extensions.emplace_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
 
     // Add optional features if supported
     if (physical_device->get_supported_features()
@@ -50,6 +53,10 @@ void ExtensionVMA::on_physical_device_selected(
         flags |= VMA_ALLOCATOR_CREATE_AMD_DEVICE_COHERENT_MEMORY_BIT;
         SPDLOG_DEBUG("VMA extension: enable VMA_ALLOCATOR_CREATE_AMD_DEVICE_COHERENT_MEMORY_BIT");
     }
+    if (physical_device->extension_supported(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME)) {
+        flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+        SPDLOG_DEBUG("VMA extension: enable VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT");
+    }
     if (physical_device->get_supported_features()
             .get_buffer_device_address_features()
             .bufferDeviceAddress == VK_TRUE) {
@@ -0,0 +1,253 @@
+#include "merian/vk/memory/aliasing_memory_allocator.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace merian {
+
+AliasingMemoryAllocation::AliasingMemoryAllocation(const ContextHandle& context,
+                                                   const AliasingMemoryAllocatorHandle& allocator,
+                                                   const MemoryAllocationHandle& heap,
+                                                   const vk::DeviceSize offset,
+                                                   const vk::DeviceSize size)
+    : MemoryAllocation(context), allocator(allocator), heap(heap), offset(offset), size(size) {
+    SPDLOG_TRACE("create aliasing allocation ({})", fmt::ptr(this));
+}
+
+AliasingMemoryAllocation::~AliasingMemoryAllocation() {
+    SPDLOG_TRACE("free aliasing allocation ({})", fmt::ptr(this));
+}
+
+MemoryAllocationInfo AliasingMemoryAllocation::get_memory_info() const {
+    const MemoryAllocationInfo base = heap->get_memory_info();
+    return MemoryAllocationInfo{
+        base.memory,
+        base.offset + offset,
+        size,
+        base.memory_type_index,
+        name.empty() ? nullptr : name.c_str(),
+    };
+}
+
+void AliasingMemoryAllocation::bind_to_image(const ImageHandle& image,
+                                             const vk::DeviceSize allocation_offset) {
+    heap->bind_to_image(image, offset + allocation_offset);
+    image->_set_memory_allocation(shared_from_this());
+}
+
+void AliasingMemoryAllocation::bind_to_buffer(const BufferHandle& buffer,
+                                              const vk::DeviceSize allocation_offset) {
+    heap->bind_to_buffer(buffer, offset + allocation_offset);
+    buffer->_set_memory_allocation(shared_from_this());
+}
+
+MemoryAllocatorHandle AliasingMemoryAllocation::get_allocator() const {
+    return allocator;
+}
+
+const vk::DeviceSize& AliasingMemoryAllocation::get_size() const {
+    return size;
+}
+
+const vk::DeviceSize& AliasingMemoryAllocation::get_offset() const {
+    return offset;
+}
+
+void AliasingMemoryAllocation::properties(Properties& props) {
+    MemoryAllocation::properties(props);
+
+    if (props.st_begin_child("aliasing heap", "placed in aliasing heap")) {
+        heap->properties(props);
+        props.st_end_child();
+    }
+}
+
+// ------------------------------------------------------------------------------------
+
+AliasingMemoryAllocator::AliasingMemoryAllocator(const MemoryAllocatorHandle& backing_allocator,
+                                                 const vk::DeviceSize min_heap_size)
+    : MemoryAllocator(backing_allocator->get_context()), backing_allocator(backing_allocator),
+      min_heap_size(min_heap_size),
+      granularity(backing_allocator->get_context()
+                      ->get_physical_device()
+                      ->get_device_limits()
+                      .bufferImageGranularity) {}
+
+AliasingMemoryAllocator::~AliasingMemoryAllocator() {}
+
+std::optional<vk::DeviceSize> AliasingMemoryAllocator::find_gap(const Heap& heap,
+                                                                const vk::DeviceSize size,
+                                                                const vk::DeviceSize alignment,
+                                                                const Lifetime& lifetime) const {
+    // only placements that are alive at the same time are obstacles
+    std::vector<const Placement*> obstacles;
+    for (const Placement& placement : heap.placements) {
+        if (placement.lifetime.overlaps(lifetime)) {
+            obstacles.push_back(&placement);
+        }
+    }
+    std::sort(obstacles.begin(), obstacles.end(),
+              [](const Placement* a, const Placement* b) { return a->offset < b->offset; });
+
+    const auto align = [&](const vk::DeviceSize offset) {
+        return ((heap.memory_offset + offset + alignment - 1ul) & -alignment) -
+               heap.memory_offset;
+    };
+
+    vk::DeviceSize candidate = align(0);
+    for (const Placement* obstacle : obstacles) {
+        if (candidate + size <= obstacle->offset) {
+            return candidate;
+        }
+        candidate = std::max(candidate, align(obstacle->offset + obstacle->size));
+    }
+    if (candidate + size <= heap.size) {
+        return candidate;
+    }
+    return std::nullopt;
+}
+
+MemoryAllocationHandle
+AliasingMemoryAllocator::allocate_memory(const vk::MemoryPropertyFlags required_flags,
+                                         const vk::MemoryRequirements& requirements,
+                                         const std::string& debug_name,
+                                         const MemoryMappingType mapping_type,
+                                         const vk::MemoryPropertyFlags preferred_flags,
+                                         const bool dedicated,
+                                         const float dedicated_priority) {
+    if (!current_lifetime || mapping_type != MemoryMappingType::NONE || dedicated) {
+        return backing_allocator->allocate_memory(required_flags, requirements, debug_name,
+                                                  mapping_type, preferred_flags, dedicated,
+                                                  dedicated_priority);
+    }
+
+    assert(requirements.alignment == 0ul || std::popcount(requirements.alignment) == 1);
+    const vk::DeviceSize alignment =
+        std::max({requirements.alignment, granularity, vk::DeviceSize(1)});
+
+    Heap* target = nullptr;
+    vk::DeviceSize offset = 0;
+    for (Heap& heap : heaps) {
+        if ((requirements.memoryTypeBits & (1u << heap.memory_type_index)) == 0u ||
+            (heap.memory_flags & required_flags) != required_flags) {
+            continue;
+        }
+        const std::optional<vk::DeviceSize> gap =
+            find_gap(heap, requirements.size, alignment, *current_lifetime);
+        if (gap) {
+            target = &heap;
+            offset = *gap;
+            break;
+        }
+    }
+
+    if (target == nullptr) {
+        const vk::DeviceSize heap_size =
+            std::max(min_heap_size, (requirements.size + alignment - 1) & -alignment);
+        const vk::MemoryRequirements heap_requirements{heap_size, alignment,
+                                                       requirements.memoryTypeBits};
+        // heaps are shared by the resources of different owners
+        const MemoryOwnerScope memory_owner{"aliasing heaps"};
+        const MemoryAllocationHandle memory = backing_allocator->allocate_memory(
+            required_flags, heap_requirements, fmt::format("aliasing heap {}", heaps.size()),
+            MemoryMappingType::NONE, preferred_flags | vk::MemoryPropertyFlagBits::eDeviceLocal,
+            true);
+        const MemoryAllocationInfo info = memory->get_memory_info();
+        const vk::MemoryPropertyFlags memory_flags = get_context()
+                                                         ->get_physical_device()
+                                                         ->get_memory_properties()
+                                                         .memoryProperties
+                                                         .memoryTypes[info.memory_type_index]
+                                                         .propertyFlags;
+        SPDLOG_DEBUG("allocated aliasing heap {} with size {}", heaps.size(),
+                     format_size(heap_size));
+        target = &heaps.emplace_back(
+            Heap{memory, heap_size, info.offset, info.memory_type_index, memory_flags, {}});
+        offset = *find_gap(*target, requirements.size, alignment, *current_lifetime);
+    }
+
+    target->placements.push_back(
+        Placement{offset, requirements.size, *current_lifetime, current_owner});
+    requested_size += requirements.size;
+
+    const auto self = std::static_pointer_cast<AliasingMemoryAllocator>(shared_from_this());
+    const auto allocation = std::make_shared<AliasingMemoryAllocation>(
+        get_context(), self, target->memory, offset, requirements.size);
+
+#ifndef NDEBUG
+    allocation->name = debug_name;
+#endif
+
+    return allocation;
+}
+
+void AliasingMemoryAllocator::set_lifetime(const std::optional<Lifetime>& lifetime,
+                                           const uint32_t owner) {
+    assert(!lifetime || lifetime->first <= lifetime->last);
+    current_lifetime = lifetime;
+    current_owner = owner;
+}
+
+void AliasingMemoryAllocator::reset() {
+    current_lifetime.reset();
+    heaps.clear();
+    requested_size = 0;
+}
+
+vk::DeviceSize AliasingMemoryAllocator::get_requested_size() const {
+    return requested_size;
+}
+
+vk::DeviceSize AliasingMemoryAllocator::get_heap_size() const {
+    vk::DeviceSize size = 0;
+    for (const Heap& heap : heaps) {
+        size += heap.size;
+    }
+    return size;
+}
+
+uint32_t AliasingMemoryAllocator::get_heap_count() const {
+    return heaps.size();
+}
+
+uint32_t AliasingMemoryAllocator::get_placement_count() const {
+    uint32_t count = 0;
+    for (const Heap& heap : heaps) {
+        count += heap.placements.size();
+    }
+    return count;
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> AliasingMemoryAllocator::get_aliasing_owners() const {
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    for (const Heap& heap : heaps) {
+        for (std::size_t i = 0; i < heap.placements.size(); i++) {
+            for (std::size_t j = i + 1; j < heap.placements.size(); j++) {
+                const Placement& a = heap.placements[i];
+                const Placement& b = heap.placements[j];
+                if (a.owner == b.owner || a.offset >= b.offset + b.size ||
+                    b.offset >= a.offset + a.size) {
+                    continue;
+                }
+                assert(!a.lifetime.overlaps(b.lifetime));
+                if (a.lifetime.last < b.lifetime.first) {
+                    pairs.emplace_back(a.owner, b.owner);
+                } else {
+                    pairs.emplace_back(b.owner, a.owner);
+                }
+            }
+        }
+    }
+    std::sort(pairs.begin(), pairs.end());
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+    return pairs;
+}
+
+AliasingMemoryAllocatorHandle
+AliasingMemoryAllocator::create(const MemoryAllocatorHandle& backing_allocator,
+                                const vk::DeviceSize min_heap_size) {
+    return AliasingMemoryAllocatorHandle(
+        new AliasingMemoryAllocator(backing_allocator, min_heap_size));
+}
+
+} // namespace merian
@@ -131,18 +131,22 @@ BumpMemoryAllocator::~BumpMemoryAllocator() {
     }
 }
 
-vk::DeviceSize BumpMemoryAllocator::allocate(const vk::MemoryRequirements& requirements) {
+vk::DeviceSize BumpMemoryAllocator::align_offset(const vk::DeviceSize offset,
+                                                 const vk::MemoryRequirements& requirements) const {
     assert(requirements.alignment == 0ul || std::popcount(requirements.alignment) == 1);
 
+    // Align so the device address (buffer_info.offset + offset) satisfies `alignment`. When
+    // alignment <= buffer_alignment this is equivalent to buffer-relative alignment.
     const vk::DeviceSize alignment = std::max(requirements.alignment, vk::DeviceSize(1));
+    return ((buffer_info.offset + offset + alignment - 1ul) & -alignment) - buffer_info.offset;
+}
+
+vk::DeviceSize BumpMemoryAllocator::allocate(const vk::MemoryRequirements& requirements) {
     const vk::DeviceSize total = buffer_info.size;
 
     vk::DeviceSize cur = current_offset.load(std::memory_order_relaxed);
     while (true) {
-        // Align so the device address (buffer_info.offset + offset) satisfies `alignment`. When
-        // alignment <= buffer_alignment this is equivalent to buffer-relative alignment.
-        const vk::DeviceSize offset =
-            ((buffer_info.offset + cur + alignment - 1ul) & -alignment) - buffer_info.offset;
+        const vk::DeviceSize offset = align_offset(cur, requirements);
         const vk::DeviceSize end = offset + requirements.size;
         if (end > total) {
             throw AllocationFailed(vk::Result::eErrorOutOfDeviceMemory,
@@ -216,6 +220,11 @@ void* BumpMemoryAllocator::get_mapped_base() const {
     return mapped_base;
 }
 
+bool BumpMemoryAllocator::fits(const vk::MemoryRequirements& requirements) const {
+    const vk::DeviceSize cur = current_offset.load(std::memory_order_relaxed);
+    return align_offset(cur, requirements) + requirements.size <= buffer_info.size;
+}
+
 vk::DeviceSize BumpMemoryAllocator::get_free_size() const {
     const vk::DeviceSize cur = current_offset.load(std::memory_order_relaxed);
     return cur >= buffer_info.size ? 0ul : buffer_info.size - cur;
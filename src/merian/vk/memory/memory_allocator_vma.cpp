@@ -3,6 +3,8 @@
 #include "merian/vk/memory/resource_allocations.hpp"
 #include <spdlog/spdlog.h>
 
+#include <array>
+
 namespace {
 
 void log_allocation([[maybe_unused]] const VmaAllocationInfo& info,
@@ -68,6 +70,7 @@ VMAMemoryAllocation::~VMAMemoryAllocation() {
     // vmaFreeMemory unmaps any persistent mapping (whether set up via MAPPED_BIT or vmaMapMemory).
     vmaFreeMemory(allocator->vma_allocator, m_allocation);
     m_allocation = nullptr;
+    allocator->statistics.remove(statistics_allocation);
 };
 
 // ------------------------------------------------------------------------------------
@@ -161,7 +164,11 @@ void VMAMemoryAllocation::properties(Properties& props) {
 
 // ALLOCATOR
 
-VMAMemoryAllocator::VMAMemoryAllocator(const ContextHandle& context) : MemoryAllocator(context) {
+VMAMemoryAllocator::VMAMemoryAllocator(const ContextHandle& context)
+    : MemoryAllocator(context),
+      statistics(context->get_physical_device()
+                     ->get_memory_properties()
+                     .memoryProperties.memoryHeapCount) {
     const auto& vma_ext = context->get_context_extension<ExtensionVMA>();
 
     VmaVulkanFunctions vulkan_functions = {};
@@ -196,6 +203,48 @@ VMAMemoryAllocator::~VMAMemoryAllocator() {
 
 // ----------------------------------------------------------------------------------------------
 
+std::shared_ptr<VMAMemoryAllocation>
+VMAMemoryAllocator::make_allocation(const VmaAllocation allocation,
+                                    const VmaAllocationInfo& allocation_info,
+                                    const std::string& debug_name) {
+    const uint32_t heap_index = get_context()
+                                    ->get_physical_device()
+                                    ->get_memory_properties()
+                                    .memoryProperties.memoryTypes[allocation_info.memoryType]
+                                    .heapIndex;
+    const std::shared_ptr<VMAMemoryAllocator> allocator =
+        static_pointer_cast<VMAMemoryAllocator>(shared_from_this());
+    return std::make_shared<VMAMemoryAllocation>(
+        get_context(), allocator, allocation,
+        statistics.add(debug_name, allocation_info.size, heap_index),
+        allocation_info.pMappedData);
+}
+
+std::optional<MemoryStatistics::Report> VMAMemoryAllocator::get_memory_statistics() {
+    const vk::PhysicalDeviceMemoryProperties& properties =
+        get_context()->get_physical_device()->get_memory_properties().memoryProperties;
+
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> vma_budgets;
+    vmaGetHeapBudgets(vma_allocator, vma_budgets.data());
+
+    std::vector<MemoryStatistics::HeapBudget> budgets(properties.memoryHeapCount);
+    for (uint32_t i = 0; i < properties.memoryHeapCount; i++) {
+        budgets[i].size = properties.memoryHeaps[i].size;
+        budgets[i].device_local = static_cast<bool>(properties.memoryHeaps[i].flags &
+                                                    vk::MemoryHeapFlagBits::eDeviceLocal);
+        budgets[i].budget = vma_budgets[i].budget;
+        budgets[i].usage = vma_budgets[i].usage;
+    }
+
+    return statistics.get_report(budgets);
+}
+
+void VMAMemoryAllocator::reset_memory_statistics_peaks() {
+    statistics.reset_peaks();
+}
+
+// ----------------------------------------------------------------------------------------------
+
 MemoryAllocationHandle
 VMAMemoryAllocator::allocate_memory(const vk::MemoryPropertyFlags required_flags,
                                     const vk::MemoryRequirements& requirements,
@@ -217,10 +266,7 @@ VMAMemoryAllocator::allocate_memory(const vk::MemoryPropertyFlags required_flags
 
     if (!debug_name.empty())
         set_name(vma_allocator, allocation, debug_name);
-    const std::shared_ptr<VMAMemoryAllocator> allocator =
-        static_pointer_cast<VMAMemoryAllocator>(shared_from_this());
-    auto memory = std::make_shared<VMAMemoryAllocation>(get_context(), allocator, allocation,
-                                                        allocation_info.pMappedData);
+    auto memory = make_allocation(allocation, allocation_info, debug_name);
     log_allocation(allocation_info, memory, debug_name);
     return memory;
 }
@@ -252,10 +298,7 @@ BufferHandle VMAMemoryAllocator::create_buffer(const vk::BufferCreateInfo buffer
     if (!debug_name.empty())
         set_name(vma_allocator, allocation, debug_name);
 
-    const std::shared_ptr<VMAMemoryAllocator> allocator =
-        static_pointer_cast<VMAMemoryAllocator>(shared_from_this());
-    auto memory = std::make_shared<VMAMemoryAllocation>(get_context(), allocator, allocation,
-                                                        allocation_info.pMappedData);
+    auto memory = make_allocation(allocation, allocation_info, debug_name);
     auto buffer_handle = Buffer::create(buffer, memory, buffer_create_info);
     log_allocation(allocation_info, memory, debug_name);
 
@@ -278,10 +321,7 @@ ImageHandle VMAMemoryAllocator::create_image(const vk::ImageCreateInfo image_cre
                                           "could not allocate memory for image");
     if (!debug_name.empty())
         set_name(vma_allocator, allocation, debug_name);
-    const std::shared_ptr<VMAMemoryAllocator> allocator =
-        static_pointer_cast<VMAMemoryAllocator>(shared_from_this());
-    auto memory = std::make_shared<VMAMemoryAllocation>(get_context(), allocator, allocation,
-                                                        allocation_info.pMappedData);
+    auto memory = make_allocation(allocation, allocation_info, debug_name);
     auto image_handle = Image::create(image, memory, image_create_info);
     log_allocation(allocation_info, memory, debug_name);
 
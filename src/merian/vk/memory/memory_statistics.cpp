@@ -0,0 +1,145 @@
+#include "merian/vk/memory/memory_statistics.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+namespace merian {
+
+namespace {
+
+thread_local std::vector<std::string_view> owner_stack;
+
+void add_to(MemoryStatistics::Usage& usage, const uint64_t size) {
+    usage.bytes += size;
+    usage.allocations++;
+    usage.peak_bytes = std::max(usage.peak_bytes, usage.bytes);
+}
+
+void remove_from(MemoryStatistics::Usage& usage, const uint64_t size) {
+    assert(usage.bytes >= size && usage.allocations > 0);
+    usage.bytes -= size;
+    usage.allocations--;
+}
+
+template <typename Map> void reset_peaks_of(Map& map) {
+    std::erase_if(map, [](const auto& entry) { return entry.second.allocations == 0; });
+    for (auto& [key, usage] : map) {
+        usage.peak_bytes = usage.bytes;
+    }
+}
+
+nlohmann::json usage_to_json(const MemoryStatistics::Usage& usage) {
+    return {
+        {"bytes", usage.bytes},
+        {"allocations", usage.allocations},
+        {"peak_bytes", usage.peak_bytes},
+    };
+}
+
+} // namespace
+
+MemoryOwnerScope::MemoryOwnerScope(const std::string_view owner) {
+    owner_stack.emplace_back(owner);
+}
+
+MemoryOwnerScope::~MemoryOwnerScope() {
+    assert(!owner_stack.empty());
+    owner_stack.pop_back();
+}
+
+std::string_view MemoryOwnerScope::current() {
+    return owner_stack.empty() ? std::string_view() : owner_stack.back();
+}
+
+// ------------------------------------------------------------------------------------
+
+MemoryStatistics::MemoryStatistics(const uint32_t heap_count)
+    : heaps(heap_count), heap_peak_usage(heap_count) {}
+
+MemoryStatistics::Allocation
+MemoryStatistics::add(const std::string_view name, const uint64_t size, const uint32_t heap_index) {
+    assert(heap_index < heaps.size());
+
+    const std::string_view owner = MemoryOwnerScope::current();
+    Allocation allocation{
+        std::string(owner.empty() ? UNKNOWN_OWNER : owner),
+        std::string(name.empty() ? UNNAMED : name),
+        size,
+        heap_index,
+    };
+
+    const std::lock_guard lock{mutex};
+    add_to(by_owner[allocation.owner], size);
+    add_to(by_name[allocation.name], size);
+    add_to(heaps[heap_index], size);
+    add_to(total, size);
+
+    return allocation;
+}
+
+void MemoryStatistics::remove(const Allocation& allocation) {
+    const std::lock_guard lock{mutex};
+    remove_from(by_owner.at(allocation.owner), allocation.size);
+    remove_from(by_name.at(allocation.name), allocation.size);
+    remove_from(heaps[allocation.heap_index], allocation.size);
+    remove_from(total, allocation.size);
+}
+
+MemoryStatistics::Report MemoryStatistics::get_report(const std::vector<HeapBudget>& budgets) {
+    assert(budgets.size() == heaps.size());
+
+    const std::lock_guard lock{mutex};
+    Report report;
+    report.heaps.reserve(heaps.size());
+    for (uint32_t i = 0; i < heaps.size(); i++) {
+        heap_peak_usage[i] = std::max(heap_peak_usage[i], budgets[i].usage);
+        report.heaps.emplace_back(budgets[i], heap_peak_usage[i], heaps[i]);
+    }
+    report.by_owner.insert(by_owner.begin(), by_owner.end());
+    report.by_name.insert(by_name.begin(), by_name.end());
+    report.total = total;
+    return report;
+}
+
+void MemoryStatistics::reset_peaks() {
+    const std::lock_guard lock{mutex};
+    reset_peaks_of(by_owner);
+    reset_peaks_of(by_name);
+    for (Usage& heap : heaps) {
+        heap.peak_bytes = heap.bytes;
+    }
+    std::ranges::fill(heap_peak_usage, 0);
+    total.peak_bytes = total.bytes;
+}
+
+nlohmann::json MemoryStatistics::to_json(const Report& report) {
+    nlohmann::json heaps = nlohmann::json::array();
+    for (const Heap& heap : report.heaps) {
+        heaps.push_back({
+            {"size", heap.budget.size},
+            {"device_local", heap.budget.device_local},
+            {"budget", heap.budget.budget},
+            {"usage", heap.budget.usage},
+            {"peak_usage", heap.peak_usage},
+            {"tracked", usage_to_json(heap.tracked)},
+        });
+    }
+
+    nlohmann::json by_owner = nlohmann::json::object();
+    for (const auto& [owner, usage] : report.by_owner) {
+        by_owner[owner] = usage_to_json(usage);
+    }
+    nlohmann::json by_name = nlohmann::json::object();
+    for (const auto& [name, usage] : report.by_name) {
+        by_name[name] = usage_to_json(usage);
+    }
+
+    return {
+        {"heaps", heaps},
+        {"total", usage_to_json(report.total)},
+        {"by_owner", by_owner},
+        {"by_name", by_name},
+    };
+}
+
+} // namespace merian
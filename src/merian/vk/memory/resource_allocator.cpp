@@ -48,12 +48,48 @@ ResourceAllocator::ResourceAllocator(const ContextHandle& context,
     SPDLOG_DEBUG("Uploaded dummy texture and buffer");
 }
 
-BufferHandle ResourceAllocator::create_buffer(const vk::BufferCreateInfo& info,
+void ResourceAllocator::set_concurrent_sharing(const std::vector<uint32_t>& queue_family_indices) {
+    assert(queue_family_indices.empty() || queue_family_indices.size() >= 2);
+    concurrent_queue_families = queue_family_indices;
+}
+
+void ResourceAllocator::set_resource_pool(const ResourcePoolHandle& resource_pool) {
+    this->resource_pool = resource_pool;
+}
+
+const ResourcePoolHandle& ResourceAllocator::get_resource_pool() const {
+    return resource_pool;
+}
+
+BufferHandle ResourceAllocator::create_buffer(const vk::BufferCreateInfo& info_,
                                               const MemoryMappingType mapping_type,
                                               const std::string& debug_name,
                                               const std::optional<vk::DeviceSize> min_alignment) {
+    vk::BufferCreateInfo info = info_;
+    if (!concurrent_queue_families.empty() && info.sharingMode == vk::SharingMode::eExclusive) {
+        info.setSharingMode(vk::SharingMode::eConcurrent)
+            .setQueueFamilyIndices(concurrent_queue_families);
+    }
+
+    if (resource_pool) {
+        if (BufferHandle buffer = resource_pool->acquire(info, mapping_type, min_alignment)) {
+#ifndef NDEBUG
+            if (debug_utils) {
+                debug_utils->set_object_name(context->get_device()->get_device(), **buffer,
+                                             debug_name);
+            }
+            SPDLOG_TRACE("reused buffer {} ({})", fmt::ptr(static_cast<VkBuffer>(**buffer)),
+                         debug_name);
+#endif
+            return buffer;
+        }
+    }
+
     const BufferHandle buffer =
         m_memAlloc->create_buffer(info, mapping_type, debug_name, min_alignment);
+    if (resource_pool) {
+        resource_pool->track(buffer, info, mapping_type, min_alignment);
+    }
 
 #ifndef NDEBUG
     if (debug_utils) {
@@ -133,7 +169,30 @@ BufferHandle ResourceAllocator::create_instances_buffer(const uint32_t instance_
 ImageHandle ResourceAllocator::create_image(const vk::ImageCreateInfo& info_,
                                             const MemoryMappingType mapping_type,
                                             const std::string& debug_name) {
-    const ImageHandle image = m_memAlloc->create_image(info_, mapping_type, debug_name);
+    vk::ImageCreateInfo info = info_;
+    if (!concurrent_queue_families.empty() && info.sharingMode == vk::SharingMode::eExclusive) {
+        info.setSharingMode(vk::SharingMode::eConcurrent)
+            .setQueueFamilyIndices(concurrent_queue_families);
+    }
+
+    if (resource_pool) {
+        if (ImageHandle image = resource_pool->acquire(info, mapping_type)) {
+#ifndef NDEBUG
+            if (debug_utils) {
+                debug_utils->set_object_name(context->get_device()->get_device(), **image,
+                                             debug_name);
+            }
+            SPDLOG_TRACE("reused image {} ({})", fmt::ptr(static_cast<VkImage>(**image)),
+                         debug_name);
+#endif
+            return image;
+        }
+    }
+
+    const ImageHandle image = m_memAlloc->create_image(info, mapping_type, debug_name);
+    if (resource_pool) {
+        resource_pool->track(image, info, mapping_type);
+    }
 
 #ifndef NDEBUG
     if (debug_utils) {
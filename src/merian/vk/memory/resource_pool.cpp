@@ -0,0 +1,202 @@
+#include "merian/vk/memory/resource_pool.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace merian {
+
+namespace {
+
+template <class Key, class Handle, class Entry>
+Handle take(std::vector<Entry>& pooled, std::vector<Entry>& tracked, const Key& key) {
+    const auto it = std::ranges::find(pooled, key, &Entry::key);
+    if (it == pooled.end()) {
+        return nullptr;
+    }
+    Handle resource = it->resource;
+    tracked.emplace_back(std::move(*it));
+    pooled.erase(it);
+    return resource;
+}
+
+template <class Entry> void release(std::vector<Entry>& tracked, std::vector<Entry>& pooled) {
+    for (auto it = tracked.begin(); it != tracked.end();) {
+        if (it->resource.use_count() == 1) {
+            it->age = 0;
+            pooled.emplace_back(std::move(*it));
+            it = tracked.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+template <class Entry> vk::DeviceSize memory_size(const Entry& entry) {
+    const MemoryAllocationHandle& memory = entry.resource->get_memory();
+    return memory ? memory->get_memory_info().size : 0;
+}
+
+} // namespace
+
+ResourcePool::ResourcePool(const uint32_t max_age) : max_age(max_age) {}
+
+ResourcePool::BufferKey ResourcePool::make_key(const vk::BufferCreateInfo& create_info,
+                                               const MemoryMappingType mapping_type,
+                                               const std::optional<vk::DeviceSize> min_alignment) {
+    return {
+        static_cast<VkBufferCreateFlags>(create_info.flags),
+        create_info.size,
+        static_cast<VkBufferUsageFlags>(create_info.usage),
+        static_cast<VkSharingMode>(create_info.sharingMode),
+        std::vector<uint32_t>(create_info.pQueueFamilyIndices,
+                              create_info.pQueueFamilyIndices + create_info.queueFamilyIndexCount),
+        mapping_type,
+        min_alignment.value_or(0),
+    };
+}
+
+ResourcePool::ImageKey ResourcePool::make_key(const vk::ImageCreateInfo& create_info,
+                                              const MemoryMappingType mapping_type) {
+    return {
+        static_cast<VkImageCreateFlags>(create_info.flags),
+        static_cast<VkImageType>(create_info.imageType),
+        static_cast<VkFormat>(create_info.format),
+        std::make_tuple(create_info.extent.width, create_info.extent.height,
+                        create_info.extent.depth),
+        create_info.mipLevels,
+        create_info.arrayLayers,
+        static_cast<VkSampleCountFlagBits>(create_info.samples),
+        static_cast<VkImageTiling>(create_info.tiling),
+        static_cast<VkImageUsageFlags>(create_info.usage),
+        static_cast<VkSharingMode>(create_info.sharingMode),
+        std::vector<uint32_t>(create_info.pQueueFamilyIndices,
+                              create_info.pQueueFamilyIndices + create_info.queueFamilyIndexCount),
+        mapping_type,
+    };
+}
+
+BufferHandle ResourcePool::acquire(const vk::BufferCreateInfo& create_info,
+                                   const MemoryMappingType mapping_type,
+                                   const std::optional<vk::DeviceSize> min_alignment) {
+    if (create_info.pNext != nullptr) {
+        return nullptr;
+    }
+
+    const std::lock_guard lock{mutex};
+    BufferHandle buffer = take<BufferKey, BufferHandle>(
+        pooled_buffers, tracked_buffers, make_key(create_info, mapping_type, min_alignment));
+    (buffer ? hits : misses)++;
+    return buffer;
+}
+
+ImageHandle ResourcePool::acquire(const vk::ImageCreateInfo& create_info,
+                                  const MemoryMappingType mapping_type) {
+    if (create_info.pNext != nullptr) {
+        return nullptr;
+    }
+
+    const std::lock_guard lock{mutex};
+    ImageHandle image = take<ImageKey, ImageHandle>(pooled_images, tracked_images,
+                                                    make_key(create_info, mapping_type));
+    if (image) {
+        hits++;
+        // the contents are discarded with the next layout transition
+        image->_set_current_layout(vk::ImageLayout::eUndefined);
+    } else {
+        misses++;
+    }
+    return image;
+}
+
+void ResourcePool::track(const BufferHandle& buffer,
+                         const vk::BufferCreateInfo& create_info,
+                         const MemoryMappingType mapping_type,
+                         const std::optional<vk::DeviceSize> min_alignment) {
+    if (create_info.pNext != nullptr) {
+        return;
+    }
+
+    const std::lock_guard lock{mutex};
+    tracked_buffers.emplace_back(make_key(create_info, mapping_type, min_alignment), buffer);
+}
+
+void ResourcePool::track(const ImageHandle& image,
+                         const vk::ImageCreateInfo& create_info,
+                         const MemoryMappingType mapping_type) {
+    if (create_info.pNext != nullptr) {
+        return;
+    }
+
+    const std::lock_guard lock{mutex};
+    tracked_images.emplace_back(make_key(create_info, mapping_type), image);
+}
+
+void ResourcePool::release_unused() {
+    const std::lock_guard lock{mutex};
+    release(tracked_buffers, pooled_buffers);
+    release(tracked_images, pooled_images);
+}
+
+void ResourcePool::age() {
+    const std::lock_guard lock{mutex};
+    for (auto& entry : pooled_buffers) {
+        entry.age++;
+    }
+    for (auto& entry : pooled_images) {
+        entry.age++;
+    }
+    const auto too_old = [&](const auto& entry) { return entry.age >= max_age; };
+    const std::size_t evicted =
+        std::erase_if(pooled_buffers, too_old) + std::erase_if(pooled_images, too_old);
+
+    SPDLOG_DEBUG("resource pool: {} buffers and {} images pooled, {} evicted",
+                 pooled_buffers.size(), pooled_images.size(), evicted);
+}
+
+void ResourcePool::clear() {
+    const std::lock_guard lock{mutex};
+    pooled_buffers.clear();
+    pooled_images.clear();
+}
+
+// -----------------------------------------------------------
+
+uint32_t ResourcePool::get_max_age() const {
+    const std::lock_guard lock{mutex};
+    return max_age;
+}
+
+void ResourcePool::set_max_age(const uint32_t max_age) {
+    const std::lock_guard lock{mutex};
+    this->max_age = max_age;
+}
+
+std::size_t ResourcePool::get_pooled_count() const {
+    const std::lock_guard lock{mutex};
+    return pooled_buffers.size() + pooled_images.size();
+}
+
+vk::DeviceSize ResourcePool::get_pooled_size() const {
+    const std::lock_guard lock{mutex};
+    vk::DeviceSize size = 0;
+    for (const auto& entry : pooled_buffers) {
+        size += memory_size(entry);
+    }
+    for (const auto& entry : pooled_images) {
+        size += memory_size(entry);
+    }
+    return size;
+}
+
+uint64_t ResourcePool::get_hits() const {
+    const std::lock_guard lock{mutex};
+    return hits;
+}
+
+uint64_t ResourcePool::get_misses() const {
+    const std::lock_guard lock{mutex};
+    return misses;
+}
+
+} // namespace merian
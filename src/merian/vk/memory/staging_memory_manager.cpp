@@ -1,14 +1,22 @@
 #include "merian/vk/memory/staging_memory_manager.hpp"
+#include "merian/vk/command/submission.hpp"
+
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+
 namespace merian {
 
 StagingMemoryManager::StagingMemoryManager(const MemoryAllocatorHandle& memory_allocator,
                                            const vk::DeviceSize block_size,
                                            const vk::BufferUsageFlags upload_usage,
-                                           const vk::BufferUsageFlags download_usage)
+                                           const vk::BufferUsageFlags download_usage,
+                                           const vk::DeviceSize max_size,
+                                           const vk::DeviceSize stream_budget)
     : context(memory_allocator->get_context()), allocator(memory_allocator), block_size(block_size),
-      upload_usage(upload_usage), download_usage(download_usage) {
+      max_size(max_size), stream_budget(stream_budget), upload_usage(upload_usage),
+      download_usage(download_usage),
+      timeline(TimelineSemaphore::create(context)) {
     if (context->get_device()
             ->get_enabled_features()
             .get_buffer_device_address_features()
@@ -17,55 +25,339 @@ StagingMemoryManager::StagingMemoryManager(const MemoryAllocatorHandle& memory_a
         this->download_usage |= vk::BufferUsageFlagBits::eShaderDeviceAddress;
     }
 
-    create_upload_block();
+    set_max_size(max_size);
+
+    const MemoryOwnerScope memory_owner{MEMORY_OWNER};
+    const std::lock_guard lock{mutex};
+    next_block(upload_ring, true);
 }
 
 StagingMemoryManager::~StagingMemoryManager() = default;
 
-// -------------------------------------------------------------------------
+StagingMemoryManager::Readback::Readback(const MemoryAllocationHandle& memory,
+                                         const vk::DeviceSize size)
+    : memory(memory), size(size) {
+    memory->invalidate();
+    data = memory->map();
+}
 
-void StagingMemoryManager::create_upload_block() {
-    SPDLOG_DEBUG("creating new upload staging block ({})", format_size(block_size));
-    const BufferHandle buffer = allocator->create_buffer(
-        vk::BufferCreateInfo{{}, block_size, upload_usage},
-        MemoryMappingType::HOST_ACCESS_SEQUENTIAL_WRITE, "staging upload block");
-    upload_block = BumpMemoryAllocator::create(buffer);
+StagingMemoryManager::Readback::~Readback() {
+    memory->unmap();
 }
 
-void StagingMemoryManager::create_download_block() {
+// -------------------------------------------------------------------------
+
+BufferHandle StagingMemoryManager::create_block_buffer(const bool upload) {
+    if (upload) {
+        SPDLOG_DEBUG("creating new upload staging block ({})", format_size(block_size));
+        return allocator->create_buffer(vk::BufferCreateInfo{{}, block_size, upload_usage},
+                                        MemoryMappingType::HOST_ACCESS_SEQUENTIAL_WRITE,
+                                        "staging upload block");
+    }
     SPDLOG_DEBUG("creating new download staging block ({})", format_size(block_size));
-    const BufferHandle buffer =
-        allocator->create_buffer(vk::BufferCreateInfo{{}, block_size, download_usage},
-                                 MemoryMappingType::HOST_ACCESS_RANDOM, "staging download block");
-    download_block = BumpMemoryAllocator::create(buffer);
+    return allocator->create_buffer(vk::BufferCreateInfo{{}, block_size, download_usage},
+                                    MemoryMappingType::HOST_ACCESS_RANDOM,
+                                    "staging download block");
+}
+
+BumpMemoryAllocatorHandle StagingMemoryManager::take_released(Ring& ring, const bool wait) {
+    const uint64_t submitted = submitted_epoch.load(std::memory_order_acquire);
+    const uint64_t reached = timeline->get_counter_value();
+
+    for (auto it = ring.retired.begin(); it != ring.retired.end(); ++it) {
+        // still referenced by allocations (e.g. a download that was not read yet), or the
+        // signal was not submitted yet and waiting could deadlock.
+        if (it->allocator.use_count() > 1 || it->last_use > submitted) {
+            continue;
+        }
+        if (reached < it->last_use) {
+            if (!wait) {
+                continue;
+            }
+            SPDLOG_DEBUG("staging memory exhausted, waiting for the GPU to release a block");
+            stall_count.fetch_add(1, std::memory_order_relaxed);
+            timeline->wait(it->last_use);
+        }
+
+        BumpMemoryAllocatorHandle block = std::move(it->allocator);
+        ring.retired.erase(it);
+        return block;
+    }
+
+    return nullptr;
+}
+
+void StagingMemoryManager::trim_idle(Ring& ring) {
+    const uint64_t submitted = submitted_epoch.load(std::memory_order_acquire);
+    const uint64_t reached = timeline->get_counter_value();
+    const auto is_idle = [&](const Block& block) {
+        return block.allocator.use_count() == 1 && block.last_use <= submitted &&
+               block.last_use <= reached;
+    };
+
+    const std::size_t idle = std::ranges::count_if(ring.retired, is_idle);
+    const uint32_t keep = keep_idle_blocks.load(std::memory_order_relaxed);
+    if (idle <= keep) {
+        return;
+    }
+
+    // the oldest idle blocks come first
+    std::size_t drop = idle - keep;
+    for (auto it = ring.retired.begin(); it != ring.retired.end() && drop > 0;) {
+        if (is_idle(*it)) {
+            it = ring.retired.erase(it);
+            allocated_size -= block_size;
+            --drop;
+        } else {
+            ++it;
+        }
+    }
+    SPDLOG_DEBUG("freed {} idle staging blocks", idle - keep);
 }
 
-MemoryAllocationHandle StagingMemoryManager::suballocate(BumpMemoryAllocatorHandle& block,
+void StagingMemoryManager::next_block(Ring& ring, const bool upload) {
+    if (ring.current.allocator) {
+        if (epoch > 1) {
+            ring.retired.push_back(std::move(ring.current));
+        } else {
+            // retire_on() was never called, the block is released with its last allocation.
+            allocated_size -= block_size;
+        }
+        ring.current = {};
+    }
+
+    const vk::DeviceSize limit = this->max_size.load(std::memory_order_relaxed);
+    BumpMemoryAllocatorHandle block = take_released(ring, false);
+    if (!block && limit != 0 && allocated_size + block_size > limit) {
+        // make room by dropping released blocks of the other direction first
+        Ring& other = upload ? download_ring : upload_ring;
+        while (allocated_size + block_size > limit && take_released(other, false)) {
+            allocated_size -= block_size;
+        }
+        if (allocated_size + block_size > limit) {
+            block = take_released(ring, true);
+            if (!block) {
+                SPDLOG_WARN("exceeding the max staging size of {}: all blocks are in use or their "
+                            "release was not submitted (missing retire_on()?)",
+                            format_size(limit));
+            }
+        }
+    }
+
+    if (block) {
+        SPDLOG_TRACE("reusing {} staging block", upload ? "upload" : "download");
+        block->reset();
+    } else {
+        block = BumpMemoryAllocator::create(create_block_buffer(upload));
+        allocated_size += block_size;
+    }
+    ring.current = {block, epoch};
+    trim_idle(ring);
+}
+
+void StagingMemoryManager::pin(const MemoryAllocationHandle& memory) {
+    const auto* allocation = dynamic_cast<const BumpMemoryAllocation*>(memory.get());
+    if (allocation == nullptr) {
+        // individual buffer, kept alive by the command buffer.
+        return;
+    }
+
+    const std::lock_guard lock{mutex};
+    for (Ring* ring : {&upload_ring, &download_ring}) {
+        if (ring->current.allocator == allocation->get_bump_allocator()) {
+            ring->current.last_use = epoch;
+            return;
+        }
+        for (Block& block : ring->retired) {
+            if (block.allocator == allocation->get_bump_allocator()) {
+                block.last_use = epoch;
+                return;
+            }
+        }
+    }
+}
+
+MemoryAllocationHandle StagingMemoryManager::suballocate(Block& block,
                                                          const vk::DeviceSize size,
                                                          BufferHandle& buffer,
                                                          vk::DeviceSize& buffer_offset) {
     const vk::MemoryRequirements reqs{size, STAGING_ALIGNMENT, ~0u};
-    const vk::DeviceSize offset = block->allocate(reqs);
-    buffer = block->get_base_buffer();
+    const vk::DeviceSize offset = block.allocator->allocate(reqs);
+    block.last_use = epoch;
+    buffer = block.allocator->get_base_buffer();
     buffer_offset = offset;
-    return std::make_shared<BumpMemoryAllocation>(context, block, offset, size);
+    return std::make_shared<BumpMemoryAllocation>(context, block.allocator, offset, size);
+}
+
+// -------------------------------------------------------------------------
+
+void StagingMemoryManager::retire_on(Submission& submission) {
+    signal_epoch(submission);
+}
+
+uint64_t StagingMemoryManager::signal_epoch(Submission& submission) {
+    const std::lock_guard lock{mutex};
+    const uint64_t value = epoch++;
+    trim_idle(upload_ring);
+    trim_idle(download_ring);
+    submission.add_signal_semaphore(timeline, value);
+    submission.add_submit_callback(
+        [self = shared_from_this(), value](const QueueHandle& /*queue*/, Submission& /*s*/) {
+            uint64_t submitted = self->submitted_epoch.load(std::memory_order_relaxed);
+            while (submitted < value &&
+                   !self->submitted_epoch.compare_exchange_weak(submitted, value)) {
+            }
+        });
+    return value;
+}
+
+// -------------------------------------------------------------------------
+
+void StagingMemoryManager::stream_chunk(
+    const CommandBufferHandle& cmd,
+    Submission* submission,
+    Stream& stream,
+    const void* data,
+    const vk::DeviceSize size,
+    const std::function<void(const CommandBufferHandle& cmd,
+                             const BufferHandle& staging_buffer,
+                             const vk::DeviceSize staging_offset)>& record) {
+    if (submission != nullptr) {
+        const vk::DeviceSize budget = stream_budget.load(std::memory_order_relaxed);
+        while (!stream.in_flight.empty() && stream.in_flight_bytes + size > budget) {
+            const auto [value, bytes] = stream.in_flight.front();
+            if (!timeline->wait(value, 0)) {
+                stall_count.fetch_add(1, std::memory_order_relaxed);
+                timeline->wait(value);
+            }
+            stream.in_flight_bytes -= bytes;
+            stream.in_flight.pop_front();
+        }
+    }
+
+    BufferHandle staging_buffer;
+    vk::DeviceSize staging_offset;
+    const MemoryAllocationHandle memory =
+        get_upload_staging_space(size, staging_buffer, staging_offset);
+    memcpy(memory->map(), data, size);
+    memory->unmap();
+
+    if (submission == nullptr) {
+        record(cmd, staging_buffer, staging_offset);
+        return;
+    }
+
+    record(submission->get_cmd(), staging_buffer, staging_offset);
+    const uint64_t value = signal_epoch(*submission);
+    submission->submit();
+    stream.in_flight.emplace_back(value, size);
+    stream.in_flight_bytes += size;
+}
+
+void StagingMemoryManager::stream_to_device(const CommandBufferHandle& cmd,
+                                            Submission* submission,
+                                            const BufferHandle& buffer,
+                                            const void* data,
+                                            const vk::DeviceSize offset,
+                                            const vk::DeviceSize size) {
+    SPDLOG_DEBUG("streaming {} to buffer in chunks of {}", format_size(size),
+                 format_size(block_size));
+
+    Stream stream;
+    for (vk::DeviceSize chunk_offset = 0; chunk_offset < size; chunk_offset += block_size) {
+        const vk::DeviceSize chunk_size = std::min(block_size, size - chunk_offset);
+        stream_chunk(cmd, submission, stream, static_cast<const char*>(data) + chunk_offset,
+                     chunk_size,
+                     [&](const CommandBufferHandle& chunk_cmd, const BufferHandle& staging_buffer,
+                         const vk::DeviceSize staging_offset) {
+                         chunk_cmd->copy(staging_buffer, buffer,
+                                         vk::BufferCopy{staging_offset, offset + chunk_offset,
+                                                        chunk_size});
+                     });
+    }
+}
+
+void StagingMemoryManager::stream_to_device(const CommandBufferHandle& cmd,
+                                            Submission* submission,
+                                            const ImageHandle& image,
+                                            const void* data,
+                                            const vk::ImageSubresourceLayers& subresource,
+                                            const vk::Offset3D offset,
+                                            const vk::Extent3D extent) {
+    const vk::DeviceSize row_size =
+        static_cast<vk::DeviceSize>(extent.width) * Image::format_size(image->get_format());
+    const vk::DeviceSize slice_size = row_size * extent.height;
+
+    if (row_size > block_size) {
+        SPDLOG_WARN("image row of {} exceeds the staging block size, uploading at once",
+                    format_size(row_size));
+        const DeviceImageCopy copy = to_device(image, data, subresource, offset, extent);
+        (submission != nullptr ? submission->get_cmd() : cmd)
+            ->copy(copy.src, copy.dst, copy.region);
+        return;
+    }
+
+    SPDLOG_DEBUG("streaming {} to image in chunks of {}", format_size(slice_size * extent.depth),
+                 format_size(block_size));
+
+    // whole slices if a slice fits into a block, else rows of a slice
+    const bool whole_slices = slice_size <= block_size;
+    const uint32_t slices_per_chunk =
+        whole_slices ? static_cast<uint32_t>(std::min<vk::DeviceSize>(block_size / slice_size,
+                                                                      extent.depth))
+                     : 1;
+    const uint32_t rows_per_chunk =
+        whole_slices ? extent.height
+                     : static_cast<uint32_t>(std::min<vk::DeviceSize>(block_size / row_size,
+                                                                      extent.height));
+
+    Stream stream;
+    uint32_t slices = 0;
+    for (uint32_t z = 0; z < extent.depth; z += slices) {
+        slices = std::min(slices_per_chunk, extent.depth - z);
+        uint32_t rows = 0;
+        for (uint32_t y = 0; y < extent.height; y += rows) {
+            rows = std::min(rows_per_chunk, extent.height - y);
+
+            vk::BufferImageCopy region;
+            region.imageSubresource = subresource;
+            region.imageOffset = vk::Offset3D{offset.x, offset.y + static_cast<int32_t>(y),
+                                              offset.z + static_cast<int32_t>(z)};
+            region.imageExtent = vk::Extent3D{extent.width, rows, slices};
+
+            const vk::DeviceSize data_offset = z * slice_size + y * row_size;
+            stream_chunk(cmd, submission, stream, static_cast<const char*>(data) + data_offset,
+                         row_size * rows * slices,
+                         [&](const CommandBufferHandle& chunk_cmd,
+                             const BufferHandle& staging_buffer,
+                             const vk::DeviceSize staging_offset) {
+                             region.bufferOffset = staging_offset;
+                             chunk_cmd->copy(staging_buffer, image, region);
+                         });
+        }
+    }
 }
 
 // -------------------------------------------------------------------------
 
 MemoryAllocationHandle StagingMemoryManager::get_upload_staging_space(
     const vk::DeviceSize size, BufferHandle& upload_buffer, vk::DeviceSize& upload_buffer_offset) {
+    uploaded_bytes.fetch_add(size, std::memory_order_relaxed);
+    const MemoryOwnerScope memory_owner{MEMORY_OWNER};
 
     if (size <= block_size) {
-        if (upload_block->get_free_size() < size + STAGING_ALIGNMENT) {
-            create_upload_block();
+        const std::lock_guard lock{mutex};
+        if (!upload_ring.current.allocator ||
+            !upload_ring.current.allocator->fits({size, STAGING_ALIGNMENT, ~0u})) {
+            next_block(upload_ring, true);
         }
         try {
-            return suballocate(upload_block, size, upload_buffer, upload_buffer_offset);
+            return suballocate(upload_ring.current, size, upload_buffer, upload_buffer_offset);
         } catch (const AllocationFailed&) {
         }
     }
 
+    individual_count.fetch_add(1, std::memory_order_relaxed);
     upload_buffer = allocator->create_buffer(vk::BufferCreateInfo{{}, size, upload_usage},
                                              MemoryMappingType::HOST_ACCESS_SEQUENTIAL_WRITE,
                                              "staging upload (individual)");
@@ -77,17 +369,23 @@ MemoryAllocationHandle
 StagingMemoryManager::get_download_staging_space(const vk::DeviceSize size,
                                                  BufferHandle& download_buffer,
                                                  vk::DeviceSize& download_buffer_offset) {
+    downloaded_bytes.fetch_add(size, std::memory_order_relaxed);
+    const MemoryOwnerScope memory_owner{MEMORY_OWNER};
 
     if (size <= block_size) {
-        if (!download_block || download_block->get_free_size() < size + STAGING_ALIGNMENT) {
-            create_download_block();
+        const std::lock_guard lock{mutex};
+        if (!download_ring.current.allocator ||
+            !download_ring.current.allocator->fits({size, STAGING_ALIGNMENT, ~0u})) {
+            next_block(download_ring, false);
         }
         try {
-            return suballocate(download_block, size, download_buffer, download_buffer_offset);
+            return suballocate(download_ring.current, size, download_buffer,
+                               download_buffer_offset);
         } catch (const AllocationFailed&) {
         }
     }
 
+    individual_count.fetch_add(1, std::memory_order_relaxed);
     download_buffer = allocator->create_buffer(vk::BufferCreateInfo{{}, size, download_usage},
                                                MemoryMappingType::HOST_ACCESS_RANDOM,
                                                "staging download (individual)");
@@ -117,12 +415,11 @@ StagingMemoryManager::to_device(const ImageHandle& image,
     copy.region.imageSubresource = subresource;
     copy.region.imageOffset = offset;
     copy.region.imageExtent = extent;
-    const MemoryAllocationHandle memory =
-        get_upload_staging_space(size, copy.src, copy.region.bufferOffset);
+    copy.memory = get_upload_staging_space(size, copy.src, copy.region.bufferOffset);
 
     SPDLOG_TRACE("uploading {} of data to staging buffer", format_size(size));
-    memcpy(memory->map(), data, size);
-    memory->unmap();
+    memcpy(copy.memory->map(), data, size);
+    copy.memory->unmap();
 
     return copy;
 }
@@ -133,10 +430,35 @@ void StagingMemoryManager::cmd_to_device(const CommandBufferHandle& cmd,
                                          const vk::ImageSubresourceLayers& subresource,
                                          const vk::Offset3D offset,
                                          const std::optional<vk::Extent3D> optional_extent) {
-    const DeviceImageCopy copy = to_device(image, data, subresource, offset, optional_extent);
+    const vk::Extent3D extent = optional_extent.value_or(to_extent(image->get_extent() - offset));
+    const vk::DeviceSize size = static_cast<vk::DeviceSize>(extent.width) * extent.height *
+                                extent.depth * Image::format_size(image->get_format());
+    if (size > block_size) {
+        stream_to_device(cmd, nullptr, image, data, subresource, offset, extent);
+        return;
+    }
+
+    const DeviceImageCopy copy = to_device(image, data, subresource, offset, extent);
     cmd->copy(copy.src, copy.dst, copy.region);
 }
 
+void StagingMemoryManager::cmd_to_device(Submission& submission,
+                                         const ImageHandle& image,
+                                         const void* data,
+                                         const vk::ImageSubresourceLayers& subresource,
+                                         const vk::Offset3D offset,
+                                         const std::optional<vk::Extent3D> optional_extent) {
+    const vk::Extent3D extent = optional_extent.value_or(to_extent(image->get_extent() - offset));
+    const vk::DeviceSize size = static_cast<vk::DeviceSize>(extent.width) * extent.height *
+                                extent.depth * Image::format_size(image->get_format());
+    if (size <= block_size || submission.is_secondary()) {
+        cmd_to_device(submission.get_cmd(), image, data, subresource, offset, extent);
+        return;
+    }
+
+    stream_to_device(nullptr, &submission, image, data, subresource, offset, extent);
+}
+
 StagingMemoryManager::DeviceImageDownload
 StagingMemoryManager::from_device(const ImageHandle& image,
                                   const vk::ImageSubresourceLayers& subresource,
@@ -157,6 +479,7 @@ StagingMemoryManager::from_device(const ImageHandle& image,
     download.copy.region.imageExtent = extent;
     download.memory =
         get_download_staging_space(size, download.copy.src, download.copy.region.bufferOffset);
+    download.copy.memory = download.memory;
 
     return download;
 }
@@ -190,12 +513,11 @@ StagingMemoryManager::to_device(const BufferHandle& buffer,
     copy.dst = buffer;
     copy.region.dstOffset = offset;
     copy.region.size = size;
-    const MemoryAllocationHandle memory =
-        get_upload_staging_space(size, copy.src, copy.region.srcOffset);
+    copy.memory = get_upload_staging_space(size, copy.src, copy.region.srcOffset);
 
     SPDLOG_TRACE("uploading {} of data to staging buffer", format_size(size));
-    memcpy(memory->map(), data, size);
-    memory->unmap();
+    memcpy(copy.memory->map(), data, size);
+    copy.memory->unmap();
 
     return copy;
 }
@@ -220,13 +542,34 @@ void StagingMemoryManager::cmd_to_device(const CommandBufferHandle& cmd,
 
     if (size <= CMD_UPDATE_BUFFER_THRESHOLD && size % 4 == 0 && offset % 4 == 0) {
         cmd->update(buffer, offset, size, data);
+        uploaded_bytes.fetch_add(size, std::memory_order_relaxed);
         SPDLOG_TRACE("uploading {} of data to buffer using vkCmdUpdateBuffer", format_size(size));
+    } else if (size > block_size) {
+        stream_to_device(cmd, nullptr, buffer, data, offset, size);
     } else {
         const DeviceBufferCopy copy = to_device(buffer, data, offset, size);
         cmd->copy(copy.src, copy.dst, copy.region);
     }
 }
 
+void StagingMemoryManager::cmd_to_device(Submission& submission,
+                                         const BufferHandle& buffer,
+                                         const void* data,
+                                         const vk::DeviceSize offset,
+                                         const std::optional<vk::DeviceSize> optional_size) {
+    assert(offset < buffer->get_size());
+    assert(!optional_size || *optional_size + offset <= buffer->get_size());
+
+    const vk::DeviceSize size = optional_size.value_or(buffer->get_size() - offset);
+    if (size <= block_size || submission.is_secondary()) {
+        cmd_to_device(submission.get_cmd(), buffer, data, offset, size);
+        return;
+    }
+
+    assert(data);
+    stream_to_device(nullptr, &submission, buffer, data, offset, size);
+}
+
 MemoryAllocationHandle
 StagingMemoryManager::cmd_to_device(const CommandBufferHandle& cmd,
                                     const BufferHandle& buffer,
@@ -265,6 +608,7 @@ StagingMemoryManager::from_device(const BufferHandle& buffer,
     download.copy.region.size = size;
     download.memory =
         get_download_staging_space(size, download.copy.dst, download.copy.region.dstOffset);
+    download.copy.memory = download.memory;
 
     return download;
 }
@@ -279,4 +623,145 @@ StagingMemoryManager::cmd_from_device(const CommandBufferHandle& cmd,
     return download.memory;
 }
 
+// -------------------------------------------------------------------------
+
+void StagingMemoryManager::cmd_copy(const CommandBufferHandle& cmd, const DeviceImageCopy& copy) {
+    pin(copy.memory);
+    cmd->copy(copy.src, copy.dst, copy.region);
+}
+
+void StagingMemoryManager::cmd_copy(const CommandBufferHandle& cmd, const DeviceBufferCopy& copy) {
+    pin(copy.memory);
+    cmd->copy(copy.src, copy.dst, copy.region);
+}
+
+// -------------------------------------------------------------------------
+
+void StagingMemoryManager::sync_readback(Submission& submission,
+                                         const BufferHandle& staging_buffer,
+                                         const MemoryAllocationHandle& memory,
+                                         const vk::DeviceSize size,
+                                         const ReadbackCallback& callback) {
+    submission.get_cmd()->barrier(vk::PipelineStageFlagBits::eTransfer,
+                                  vk::PipelineStageFlagBits::eHost,
+                                  staging_buffer->buffer_barrier(vk::AccessFlagBits::eTransferWrite,
+                                                                 vk::AccessFlagBits::eHostRead));
+    submission.sync_to_cpu([memory, size, callback]() {
+        // the CPUQueue discards exceptions
+        try {
+            callback(std::make_shared<Readback>(memory, size));
+        } catch (const std::exception& e) {
+            SPDLOG_ERROR("readback callback failed: {}", e.what());
+        }
+    });
+}
+
+void StagingMemoryManager::cmd_readback(Submission& submission,
+                                        const BufferHandle& buffer,
+                                        const ReadbackCallback& callback,
+                                        const vk::DeviceSize offset,
+                                        const std::optional<vk::DeviceSize> optional_size) {
+    const DeviceBufferDownload download = from_device(buffer, offset, optional_size);
+    submission.get_cmd()->copy(download.copy.src, download.copy.dst, download.copy.region);
+    sync_readback(submission, download.copy.dst, download.memory, download.copy.region.size,
+                  callback);
+}
+
+void StagingMemoryManager::cmd_readback(Submission& submission,
+                                        const ImageHandle& image,
+                                        const ReadbackCallback& callback,
+                                        const vk::ImageSubresourceLayers& subresource,
+                                        const vk::Offset3D offset,
+                                        const std::optional<vk::Extent3D> optional_extent) {
+    const DeviceImageDownload download = from_device(image, subresource, offset, optional_extent);
+    submission.get_cmd()->copy(download.copy.dst, download.copy.src, download.copy.region);
+
+    const vk::Extent3D& extent = download.copy.region.imageExtent;
+    const vk::DeviceSize size = static_cast<vk::DeviceSize>(extent.width) * extent.height *
+                                extent.depth * Image::format_size(image->get_format());
+    sync_readback(submission, download.copy.src, download.memory, size, callback);
+}
+
+std::future<StagingMemoryManager::ReadbackHandle>
+StagingMemoryManager::cmd_readback(Submission& submission,
+                                   const BufferHandle& buffer,
+                                   const vk::DeviceSize offset,
+                                   const std::optional<vk::DeviceSize> optional_size) {
+    const auto promise = std::make_shared<std::promise<ReadbackHandle>>();
+    cmd_readback(
+        submission, buffer,
+        [promise](const ReadbackHandle& readback) { promise->set_value(readback); }, offset,
+        optional_size);
+    return promise->get_future();
+}
+
+std::future<StagingMemoryManager::ReadbackHandle>
+StagingMemoryManager::cmd_readback(Submission& submission,
+                                   const ImageHandle& image,
+                                   const vk::ImageSubresourceLayers& subresource,
+                                   const vk::Offset3D offset,
+                                   const std::optional<vk::Extent3D> optional_extent) {
+    const auto promise = std::make_shared<std::promise<ReadbackHandle>>();
+    cmd_readback(
+        submission, image,
+        [promise](const ReadbackHandle& readback) { promise->set_value(readback); }, subresource,
+        offset, optional_extent);
+    return promise->get_future();
+}
+
+// -------------------------------------------------------------------------
+
+uint64_t StagingMemoryManager::get_uploaded_bytes() const {
+    return uploaded_bytes.load(std::memory_order_relaxed);
+}
+
+uint64_t StagingMemoryManager::get_downloaded_bytes() const {
+    return downloaded_bytes.load(std::memory_order_relaxed);
+}
+
+vk::DeviceSize StagingMemoryManager::get_block_size() const {
+    return block_size;
+}
+
+vk::DeviceSize StagingMemoryManager::get_allocated_size() const {
+    const std::lock_guard lock{mutex};
+    return allocated_size;
+}
+
+vk::DeviceSize StagingMemoryManager::get_max_size() const {
+    return max_size.load(std::memory_order_relaxed);
+}
+
+void StagingMemoryManager::set_max_size(const vk::DeviceSize max_size) {
+    if (max_size != 0 && max_size < 2 * block_size) {
+        SPDLOG_WARN("max staging size {} is smaller than one upload and one download block ({})",
+                    format_size(max_size), format_size(2 * block_size));
+    }
+    this->max_size.store(max_size, std::memory_order_relaxed);
+}
+
+vk::DeviceSize StagingMemoryManager::get_stream_budget() const {
+    return stream_budget.load(std::memory_order_relaxed);
+}
+
+void StagingMemoryManager::set_stream_budget(const vk::DeviceSize stream_budget) {
+    this->stream_budget.store(stream_budget, std::memory_order_relaxed);
+}
+
+uint32_t StagingMemoryManager::get_keep_idle_blocks() const {
+    return keep_idle_blocks.load(std::memory_order_relaxed);
+}
+
+void StagingMemoryManager::set_keep_idle_blocks(const uint32_t keep_idle_blocks) {
+    this->keep_idle_blocks.store(keep_idle_blocks, std::memory_order_relaxed);
+}
+
+uint64_t StagingMemoryManager::get_stall_count() const {
+    return stall_count.load(std::memory_order_relaxed);
+}
+
+uint64_t StagingMemoryManager::get_individual_count() const {
+    return individual_count.load(std::memory_order_relaxed);
+}
+
 } // namespace merian
@@ -24,23 +24,36 @@ CPUQueue::CPUQueue(const ContextHandle& context, const ThreadPoolHandle& thread_
         vk::SemaphoreWaitInfoKHR wait_info_any{vk::SemaphoreWaitFlagBits::eAny, {}, {}, {}};
         vk::SemaphoreWaitInfoKHR wait_info_all{{}, {}, {}, {}};
 
+        const auto collect = [&](PendingItem& item) {
+            waiting_vk_semaphores.emplace_back(*item.semaphore);
+            waiting_semaphores.emplace_back(std::move(item.semaphore));
+            waiting_values.emplace_back(item.value);
+            waiting_callbacks.emplace_back(std::move(item.callback));
+        };
+
         while (true) {
             mtx.lock();
-            while (!pending.empty()) {
-                auto& front = pending.front();
-                waiting_vk_semaphores.emplace_back(*front.semaphore);
-                waiting_semaphores.emplace_back(std::move(front.semaphore));
-                waiting_values.emplace_back(front.value);
-                waiting_callbacks.emplace_back(std::move(front.callback));
-
-                pending.pop();
+            // read before arming: every interrupt after arming signals at least this value
+            waiting_values[0] = interrupt_value;
+            mtx.unlock();
+
+            interrupt_armed.store(true);
+            // pairs with the fence in enqueue(): either we collect the item or it interrupts us
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            while (std::optional<PendingItem> item = pending.try_pop()) {
+                collect(*item);
+            }
+
+            mtx.lock();
+            while (!pending_overflow.empty()) {
+                collect(pending_overflow.front());
+                pending_overflow.pop();
             }
 
             assert(waiting_semaphores[0] == nullptr);
             assert(waiting_vk_semaphores[0] == **interrupt_semaphore);
 
-            waiting_values[0] = interrupt_value;
-
             if (stop && waiting_semaphores.size() == 1) {
                 // only the interrupt semaphore is left
                 SPDLOG_DEBUG("dispatcher thread quitting");
@@ -53,7 +66,7 @@ CPUQueue::CPUQueue(const ContextHandle& context, const ThreadPoolHandle& thread_
                 this->thread_pool->wait_idle();
                 mtx.lock();
 
-                if (pending.empty()) {
+                if (pending.empty() && pending_overflow.empty()) {
                     // check again since tasks of the thread pool can submit new tasks.
                     signal_wait_idle = false;
                     wait_idle_barrier.arrive_and_wait();
@@ -82,7 +95,7 @@ CPUQueue::CPUQueue(const ContextHandle& context, const ThreadPoolHandle& thread_
                     std::swap(waiting_callbacks[i], waiting_callbacks.back());
 
                     SPDLOG_TRACE("dispatcher thread submitting to thread pool");
-                    this->thread_pool->submit(std::move(waiting_callbacks.back()));
+                    this->thread_pool->execute(std::move(waiting_callbacks.back()));
 
                     waiting_vk_semaphores.pop_back();
                     waiting_semaphores.pop_back();
@@ -101,7 +114,7 @@ CPUQueue::~CPUQueue() {
 
     mtx.lock();
     stop = true;
-    interrupt_semaphore->signal(interrupt_value++);
+    interrupt();
     mtx.unlock();
 
     dispatcher_thread.join();
@@ -109,22 +122,33 @@ CPUQueue::~CPUQueue() {
     assert(waiting_vk_semaphores.size() == 1);
 }
 
+void CPUQueue::enqueue(PendingItem&& item) {
+    if (!pending.try_push(std::move(item))) {
+        std::lock_guard lk(mtx);
+        pending_overflow.emplace(std::move(item));
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (interrupt_armed.exchange(false)) {
+        std::lock_guard lk(mtx);
+        interrupt();
+    }
+}
+
+void CPUQueue::interrupt() {
+    interrupt_semaphore->signal(interrupt_value++);
+}
+
 void CPUQueue::submit(const TimelineSemaphoreHandle& semaphore,
                       const uint64_t value,
                       const std::function<void()>& callback) {
-    mtx.lock();
-    pending.emplace(semaphore, value, callback);
-    interrupt_semaphore->signal(interrupt_value++);
-    mtx.unlock();
+    enqueue(PendingItem{semaphore, value, callback});
 }
 
 void CPUQueue::submit(const TimelineSemaphoreHandle& semaphore,
                       const uint64_t value,
                       const std::function<void()>&& callback) {
-    mtx.lock();
-    pending.emplace(semaphore, value, callback);
-    interrupt_semaphore->signal(interrupt_value++);
-    mtx.unlock();
+    enqueue(PendingItem{semaphore, value, callback});
 }
 
 void CPUQueue::submit(const TimelineSemaphoreHandle& wait_semaphore,
@@ -154,7 +178,7 @@ void CPUQueue::wait_idle() {
 
     mtx.lock();
     signal_wait_idle = true;
-    interrupt_semaphore->signal(interrupt_value++);
+    interrupt();
     mtx.unlock();
 
     wait_idle_barrier.arrive_and_wait();
@@ -1,18 +1,61 @@
 #include "merian/vk/utils/profiler.hpp"
 #include "merian/utils/string.hpp"
 #include "merian/vk/command/command_buffer.hpp"
+#include "merian/vk/extension/extension_calibrated_timestamps.hpp"
 
 #include "spdlog/spdlog.h"
 
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
 #include <mutex>
+#include <set>
+#include <unordered_set>
 #include <vector>
 
 #define SW_QUERY_COUNT 2
 
 namespace merian {
 
+namespace {
+
+struct StringHash {
+    using is_transparent = void;
+
+    std::size_t operator()(const std::string_view s) const noexcept {
+        return std::hash<std::string_view>{}(s);
+    }
+};
+
+std::atomic_uint64_t next_profiler_id{0};
+
+} // namespace
+
+Profiler::SectionName Profiler::intern(const std::string_view name) {
+    // The global table is only locked the first time a thread sees a name. The keys view the
+    // interned strings, which are never released.
+    thread_local std::unordered_map<std::string_view, SectionName> cache;
+    if (const auto it = cache.find(name); it != cache.end()) {
+        return it->second;
+    }
+
+    static std::mutex mutex;
+    static std::unordered_set<std::string, StringHash, std::equal_to<>> names;
+
+    const std::lock_guard lock{mutex};
+    auto it = names.find(name);
+    if (it == names.end()) {
+        it = names.emplace(name).first;
+    }
+    const SectionName interned{&*it};
+    cache.emplace(*it, interned);
+    return interned;
+}
+
 Profiler::Profiler(const ContextHandle& context)
-    : timestamp_period(context->get_physical_device()->get_device_limits().timestampPeriod),
+    : context(context),
+      timestamp_period(context->get_physical_device()->get_device_limits().timestampPeriod),
+      owner_thread(std::this_thread::get_id()), id(next_profiler_id++),
       last_clear_time(chrono_clock::now()) {
     cpu_sections.assign(1, {});
     gpu_sections.assign(1, {});
@@ -31,10 +74,16 @@ void Profiler::set_query_pool(const QueryPoolHandle<vk::QueryType::eTimestamp>&
     this->query_pool = query_pool;
 }
 
+void Profiler::set_statistics_query_pool(
+    const QueryPoolHandle<vk::QueryType::ePipelineStatistics>& statistics_query_pool) {
+    assert(!statistics_active && "cmd_end_statistics missing?");
+    this->statistics_query_pool = statistics_query_pool;
+}
+
 template <typename SectionType>
 void Profiler::enter_child(std::vector<SectionType>& sections,
                            const std::size_t parent_idx,
-                           const std::string& name,
+                           const SectionName name,
                            uint32_t& current_idx) {
     // Recover from post-eviction stranded cursor. Cursor == size is the natural state after
     // the last child fires in this invocation; it's not a wrap signal.
@@ -53,6 +102,7 @@ void Profiler::enter_child(std::vector<SectionType>& sections,
         const uint32_t insert_pos = sections[parent_idx].child_cursor;
         sections.emplace_back();
         const auto child_idx = static_cast<uint32_t>(sections.size() - 1);
+        sections[child_idx].name = name;
         sections[child_idx].parent_index = parent_idx;
         sections[parent_idx].children.insert(sections[parent_idx].children.begin() + insert_pos,
                                              {name, child_idx});
@@ -85,10 +135,17 @@ void Profiler::clear(const uint32_t evict_after_ms) {
 }
 
 void Profiler::cmd_start(const CommandBufferHandle& cmd,
-                         const std::string& name,
+                         const std::string_view name,
+                         const vk::PipelineStageFlagBits pipeline_stage) {
+    cmd_start(cmd, intern(name), pipeline_stage);
+}
+
+void Profiler::cmd_start(const CommandBufferHandle& cmd,
+                         const SectionName name,
                          const vk::PipelineStageFlagBits pipeline_stage) {
     assert(query_pool && "num_gpu_timers is 0?");
-    std::vector<uint32_t>& pending = pending_gpu_sections[query_pool];
+    assert(on_owner_thread() && "GPU sections are only supported on the owning thread");
+    std::vector<PendingGPUSection>& pending = pending_gpu_sections[query_pool];
 
     const std::size_t parent_idx = current_gpu_section;
     enter_child(gpu_sections, parent_idx, name, current_gpu_section);
@@ -100,7 +157,7 @@ void Profiler::cmd_start(const CommandBufferHandle& cmd,
     // Bail before mutating section state so a failed capture keeps the prior period's stats.
     if ((pending.size() * SW_QUERY_COUNT) + SW_QUERY_COUNT >= query_pool->get_query_count()) {
         SPDLOG_WARN("profiler query pool exhausted ({} queries); skipping section '{}'",
-                    query_pool->get_query_count(), name);
+                    query_pool->get_query_count(), name.str());
         return;
     }
 
@@ -109,12 +166,14 @@ void Profiler::cmd_start(const CommandBufferHandle& cmd,
         sec.sum_duration_ns = 0;
         sec.sq_sum_duration_ns = 0;
         sec.num_captures = 0;
+        sec.duration_histogram_ns.clear();
+        sec.counters.clear();
     }
     sec.last_seen = now;
 
     sec.timestamp_idx = pending.size() * SW_QUERY_COUNT;
     cmd->write_timestamp(query_pool, sec.timestamp_idx, pipeline_stage);
-    pending.emplace_back(current_gpu_section);
+    pending.emplace_back(current_gpu_section, now);
 }
 
 void Profiler::cmd_end(const CommandBufferHandle& cmd,
@@ -131,12 +190,105 @@ void Profiler::cmd_end(const CommandBufferHandle& cmd,
     current_gpu_section = section.parent_index;
 }
 
+void Profiler::cmd_begin_statistics(const CommandBufferHandle& cmd) {
+    if (!statistics_query_pool) {
+        return;
+    }
+    assert(on_owner_thread() && "GPU sections are only supported on the owning thread");
+    assert(current_gpu_section != 0 && "missing cmd_start?");
+    assert(!statistics_active && "statistics queries cannot be nested");
+
+    std::vector<uint32_t>& pending = pending_statistics[statistics_query_pool];
+    if (pending.size() >= statistics_query_pool->get_query_count()) {
+        SPDLOG_WARN("profiler statistics query pool exhausted ({} queries); skipping statistics "
+                    "of section '{}'",
+                    statistics_query_pool->get_query_count(),
+                    gpu_sections[current_gpu_section].name.str());
+        return;
+    }
+
+    cmd->begin_query(statistics_query_pool, pending.size());
+    pending.emplace_back(current_gpu_section);
+    statistics_active = true;
+}
+
+void Profiler::cmd_end_statistics(const CommandBufferHandle& cmd) {
+    if (!statistics_active) {
+        return;
+    }
+
+    cmd->end_query(statistics_query_pool, pending_statistics[statistics_query_pool].size() - 1);
+    statistics_active = false;
+}
+
 void Profiler::collect(const bool wait, const bool keep_query_pool) {
+    merge_thread_buffers();
+
+    if (statistics_query_pool) {
+        collect_statistics(wait, keep_query_pool);
+    }
+
     if (!query_pool) {
         return;
     }
 
-    std::vector<uint32_t>& pending = pending_gpu_sections[query_pool];
+    collect(query_pool, wait, keep_query_pool);
+}
+
+void Profiler::collect_statistics(const bool wait, const bool keep_query_pool) {
+    std::vector<uint32_t>& pending = pending_statistics[statistics_query_pool];
+
+    if (pending.empty())
+        return;
+
+    assert(!statistics_active && "cmd_end_statistics missing?");
+
+    // one value per enabled statistic, in the order of the flag bits
+    std::vector<SectionName> names;
+    const auto flags =
+        (VkQueryPipelineStatisticFlags)statistics_query_pool->get_pipeline_statistics();
+    for (uint32_t bit = 0; bit < 32; bit++) {
+        if ((flags & (1u << bit)) != 0u) {
+            names.emplace_back(
+                intern(vk::to_string(vk::QueryPipelineStatisticFlagBits(1u << bit))));
+        }
+    }
+    assert(names.size() == statistics_query_pool->get_values_per_query());
+
+    const QueryPoolHandle<vk::QueryType::ePipelineStatistics>& pool = statistics_query_pool;
+    const auto results = wait ? pool->wait_get_query_pool_results_64(0, pending.size())
+                              : pool->get_query_pool_results_64(0, pending.size());
+
+    for (uint32_t i = 0; i < pending.size(); i++) {
+        GPUSection& section = gpu_sections[pending[i]];
+        for (uint32_t j = 0; j < names.size(); j++) {
+            add_counter(section.counters, names[j], results[i * names.size() + j]);
+        }
+    }
+
+    statistics_query_pool->reset(0, pending.size());
+
+    if (keep_query_pool) {
+        pending.clear();
+    } else {
+        pending_statistics.erase(statistics_query_pool);
+    }
+}
+
+void Profiler::add_counter(std::vector<SectionCounter>& counters,
+                           const SectionName name,
+                           const uint64_t value) {
+    // few counters per section, a linear search is faster than a map
+    const auto it = std::ranges::find(counters, name, &SectionCounter::name);
+    SectionCounter& counter = it != counters.end() ? *it : counters.emplace_back(name);
+    counter.sum += value;
+    counter.samples++;
+}
+
+void Profiler::collect(const QueryPoolHandle<vk::QueryType::eTimestamp>& query_pool,
+                       const bool wait,
+                       const bool keep_query_pool) {
+    std::vector<PendingGPUSection>& pending = pending_gpu_sections[query_pool];
 
     if (pending.empty())
         return;
@@ -148,12 +300,27 @@ void Profiler::collect(const bool wait, const bool keep_query_pool) {
              : query_pool->get_query_pool_results_64(0, pending.size() * SW_QUERY_COUNT);
 
     for (uint32_t i = 0; i < pending.size(); i++) {
-        GPUSection& section = gpu_sections[pending[i]];
-        const uint64_t duration_ns =
-            (results[SW_QUERY_COUNT * i + 1] - results[SW_QUERY_COUNT * i]) * timestamp_period;
+        GPUSection& section = gpu_sections[pending[i].section_index];
+        const uint64_t start = results[SW_QUERY_COUNT * i];
+        const uint64_t end = results[SW_QUERY_COUNT * i + 1];
+        const uint64_t duration_ns = (end - start) * timestamp_period;
         section.sum_duration_ns += duration_ns;
         section.sq_sum_duration_ns += (duration_ns * duration_ns);
         section.num_captures++;
+        section.duration_histogram_ns.record(duration_ns);
+
+        if (!trace_start || pending[i].recorded < *trace_start) {
+            continue;
+        }
+        if (!trace_gpu_reference) {
+            // Without calibration the best guess is that the GPU started the section when it was
+            // recorded. This shifts the whole GPU timeline but keeps it consistent in itself.
+            SPDLOG_WARN("GPU timestamps are not calibrated, the GPU timeline in the trace is only "
+                        "aligned approximately. Load {} for accurate results.",
+                        ExtensionCalibratedTimestamps::name);
+            trace_gpu_reference.emplace(start, pending[i].recorded - *trace_start);
+        }
+        trace_events.emplace_back(section.name, trace_time(start), trace_time(end), 0, true);
     }
 
     query_pool->reset(0, pending.size() * SW_QUERY_COUNT);
@@ -165,7 +332,16 @@ void Profiler::collect(const bool wait, const bool keep_query_pool) {
     }
 }
 
-void Profiler::start(const std::string& name) {
+void Profiler::start(const std::string_view name, const uint32_t parent) {
+    start(intern(name), parent);
+}
+
+void Profiler::start(const SectionName name, const uint32_t parent) {
+    if (!on_owner_thread()) {
+        start_buffered(name, parent);
+        return;
+    }
+
     const std::size_t parent_idx = current_cpu_section;
     enter_child(cpu_sections, parent_idx, name, current_cpu_section);
 
@@ -175,6 +351,8 @@ void Profiler::start(const std::string& name) {
         sec.sum_duration_ns = 0;
         sec.sq_sum_duration_ns = 0;
         sec.num_captures = 0;
+        sec.duration_histogram_ns.clear();
+        sec.counters.clear();
     }
     sec.last_seen = now;
     sec.start = now;
@@ -182,22 +360,237 @@ void Profiler::start(const std::string& name) {
 }
 
 void Profiler::end() {
-    assert(current_cpu_section != 0 && "missing start?");
     std::atomic_signal_fence(std::memory_order_seq_cst);
+    if (!on_owner_thread()) {
+        end_buffered();
+        return;
+    }
+    assert(current_cpu_section != 0 && "missing start?");
 
     CPUSection& section = cpu_sections[current_cpu_section];
     section.end = chrono_clock::now();
-    uint64_t duration_ns =
-        std::chrono::duration_cast<std::chrono::nanoseconds>(section.end - section.start).count();
+    add_cpu_capture(current_cpu_section, section.start, section.end, 0);
+
+    current_cpu_section = section.parent_index;
+}
+
+uint32_t Profiler::get_current_section() const {
+    assert(on_owner_thread());
+    return current_cpu_section;
+}
+
+void Profiler::add_cpu_capture(const uint32_t section_index,
+                               const chrono_clock::time_point start,
+                               const chrono_clock::time_point end,
+                               const uint32_t thread_index) {
+    CPUSection& section = cpu_sections[section_index];
+    const uint64_t duration_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
     section.sum_duration_ns += duration_ns;
     section.sq_sum_duration_ns += (duration_ns * duration_ns);
     section.num_captures++;
+    section.duration_histogram_ns.record(duration_ns);
 
-    current_cpu_section = section.parent_index;
+    if (trace_start && start >= *trace_start) {
+        trace_events.emplace_back(section.name, start - *trace_start, end - *trace_start,
+                                  thread_index, false);
+    }
+}
+
+Profiler::ThreadBuffer& Profiler::get_thread_buffer() {
+    // (profiler id, buffer) for each profiler this thread recorded into
+    thread_local std::vector<std::pair<uint64_t, std::shared_ptr<ThreadBuffer>>> buffers;
+    for (const auto& [profiler_id, buffer] : buffers) {
+        if (profiler_id == id) {
+            return *buffer;
+        }
+    }
+    // the profiler holds a reference as long as it is alive
+    std::erase_if(buffers, [](const auto& entry) { return entry.second.use_count() == 1; });
+
+    const std::lock_guard lock{thread_buffers_mutex};
+    const std::shared_ptr<ThreadBuffer>& buffer = thread_buffers.emplace_back(
+        std::make_shared<ThreadBuffer>((uint32_t)thread_buffers.size() + 1));
+    buffers.emplace_back(id, buffer);
+    return *buffer;
+}
+
+void Profiler::start_buffered(const SectionName name, const uint32_t parent) {
+    ThreadBuffer& buffer = get_thread_buffer();
+    // Keep room for the end of this and every open section, so that ends are never dropped.
+    // size() can only overestimate here, the owning thread only removes events.
+    const bool buffered =
+        buffer.events.size() + buffer.owed_ends + 2 <= buffer.events.capacity() &&
+        buffer.events.try_push(ThreadEvent{name, parent, chrono_clock::now()});
+    if (buffered) {
+        buffer.owed_ends++;
+    } else {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    buffer.open.push_back(buffered);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+void Profiler::end_buffered() {
+    const auto now = chrono_clock::now();
+    ThreadBuffer& buffer = get_thread_buffer();
+    assert(!buffer.open.empty() && "missing start?");
+
+    if (buffer.open.back()) {
+        [[maybe_unused]] const bool pushed = buffer.events.try_push(ThreadEvent{{}, 0, now});
+        assert(pushed);
+        buffer.owed_ends--;
+    }
+    buffer.open.pop_back();
+}
+
+void Profiler::merge_thread_buffers() {
+    assert(on_owner_thread());
+
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        const std::lock_guard lock{thread_buffers_mutex};
+        buffers = thread_buffers;
+    }
+
+    for (const auto& buffer : buffers) {
+        while (const std::optional<ThreadEvent> event = buffer->events.try_pop()) {
+            if (!event->name) {
+                assert(!buffer->merge_stack.empty());
+                const auto [section_index, start] = buffer->merge_stack.back();
+                buffer->merge_stack.pop_back();
+                add_cpu_capture(section_index, start, event->time, buffer->thread_index);
+                continue;
+            }
+
+            uint32_t parent = event->parent < cpu_sections.size() ? event->parent : 0;
+            if (!buffer->merge_stack.empty()) {
+                parent = buffer->merge_stack.back().first;
+            }
+            uint32_t section_index;
+            enter_child(cpu_sections, parent, event->name, section_index);
+
+            CPUSection& sec = cpu_sections[section_index];
+            if (sec.last_seen < last_clear_time) {
+                sec.sum_duration_ns = 0;
+                sec.sq_sum_duration_ns = 0;
+                sec.num_captures = 0;
+                sec.duration_histogram_ns.clear();
+                sec.counters.clear();
+            }
+            sec.last_seen = std::max(sec.last_seen, event->time);
+            buffer->merge_stack.emplace_back(section_index, event->time);
+        }
+
+        if (const uint64_t dropped = buffer->dropped.exchange(0, std::memory_order_relaxed);
+            dropped > 0) {
+            SPDLOG_WARN("profiler buffer of thread {} full, dropped {} sections",
+                        buffer->thread_index, dropped);
+        }
+    }
+}
+
+uint32_t Profiler::get_scope_token() {
+    if (on_owner_thread()) {
+        return current_cpu_section;
+    }
+    return get_thread_buffer().open.size();
+}
+
+void Profiler::start_trace() {
+    trace_events.clear();
+    trace_gpu_reference.reset();
+    trace_start = chrono_clock::now();
+
+    const auto calibrated_timestamps =
+        context->get_context_extension<ExtensionCalibratedTimestamps>(true);
+    if (calibrated_timestamps) {
+        const std::optional<TimestampCalibration> calibration = calibrated_timestamps->calibrate();
+        if (calibration) {
+            trace_gpu_reference.emplace(calibration->device_ticks,
+                                        calibration->host_time - *trace_start);
+        }
+    }
+}
+
+std::vector<Profiler::TraceEvent> Profiler::stop_trace() {
+    if (!trace_start) {
+        return {};
+    }
+
+    merge_thread_buffers();
+    std::vector<QueryPoolHandle<vk::QueryType::eTimestamp>> pools;
+    for (const auto& [pool, pending] : pending_gpu_sections) {
+        pools.emplace_back(pool);
+    }
+    for (const auto& pool : pools) {
+        collect(pool, true, true);
+    }
+
+    trace_start.reset();
+    std::ranges::sort(trace_events, {}, &TraceEvent::start);
+    return std::move(trace_events);
+}
+
+bool Profiler::is_tracing() const {
+    return trace_start.has_value();
+}
+
+std::chrono::nanoseconds Profiler::trace_time(const uint64_t timestamp) const {
+    assert(trace_gpu_reference);
+    const auto& [reference_timestamp, reference_time] = *trace_gpu_reference;
+    // signed, the section may have started before the reference
+    const double delta_ns =
+        (double)(int64_t)(timestamp - reference_timestamp) * (double)timestamp_period;
+    return reference_time + std::chrono::nanoseconds((int64_t)delta_ns);
+}
+
+std::string Profiler::get_chrome_trace(const std::vector<TraceEvent>& events) {
+    static constexpr uint32_t CPU_PID = 1;
+    static constexpr uint32_t GPU_PID = 2;
+
+    nlohmann::json trace_events = nlohmann::json::array();
+    trace_events.push_back(
+        {{"name", "process_name"}, {"ph", "M"}, {"pid", CPU_PID}, {"args", {{"name", "CPU"}}}});
+    trace_events.push_back(
+        {{"name", "process_name"}, {"ph", "M"}, {"pid", GPU_PID}, {"args", {{"name", "GPU"}}}});
+
+    std::set<std::pair<uint32_t, uint32_t>> threads;
+    for (const TraceEvent& event : events) {
+        const uint32_t pid = event.gpu ? GPU_PID : CPU_PID;
+        threads.emplace(pid, event.thread);
+        // complete events, times in µs
+        trace_events.push_back({
+            {"name", event.name.str()},
+            {"ph", "X"},
+            {"pid", pid},
+            {"tid", event.thread},
+            {"ts", std::chrono::duration<double, std::micro>(event.start).count()},
+            {"dur", std::chrono::duration<double, std::micro>(event.end - event.start).count()},
+        });
+    }
+    for (const auto& [pid, tid] : threads) {
+        trace_events.push_back({{"name", "thread_name"},
+                                {"ph", "M"},
+                                {"pid", pid},
+                                {"tid", tid},
+                                {"args",
+                                 {{"name", pid == GPU_PID ? std::string("Queue")
+                                                          : fmt::format("Thread {}", tid)}}}});
+    }
+
+    return nlohmann::json{{"traceEvents", trace_events}, {"displayTimeUnit", "ms"}}.dump();
 }
 
 std::string format_entry_value(const Profiler::ReportEntry& entry) {
     std::string s = fmt::format("{:.04f} (± {:.04f}) ms", entry.duration, entry.std_deviation);
+    if (entry.captures > 0) {
+        s += fmt::format(", p50 {:.04f} p95 {:.04f} p99 {:.04f} max {:.04f} ms", entry.p50,
+                         entry.p95, entry.p99, entry.max);
+    }
+    for (const auto& [name, value] : entry.counters) {
+        s += fmt::format(", {} {:.1f}", name, value);
+    }
     if (entry.last_seen_ms_ago) {
         s += fmt::format(" (stale, last {} ago)",
                          format_duration(uint64_t(*entry.last_seen_ms_ago * 1e6)));
@@ -220,8 +613,8 @@ template <typename SectionType>
 std::vector<Profiler::ReportEntry>
 make_report(const SectionType& section,
             const std::vector<SectionType>& sections,
-            const std::chrono::high_resolution_clock::time_point now,
-            const std::chrono::high_resolution_clock::time_point last_clear_time) {
+            const std::chrono::steady_clock::time_point now,
+            const std::chrono::steady_clock::time_point last_clear_time) {
     std::vector<Profiler::ReportEntry> report;
     report.reserve(section.children.size());
     for (const auto& [name, idx] : section.children) {
@@ -243,8 +636,14 @@ make_report(const SectionType& section,
                 std::chrono::duration<double, std::milli>(now - sub.last_seen).count();
         }
 
-        report.emplace_back(name, avg_ms, std_ms, last_seen_ms_ago,
-                            make_report(sub, sections, now, last_clear_time));
+        const LogHistogram& histogram = sub.duration_histogram_ns;
+        report.emplace_back(name.str(), avg_ms, std_ms, sub.num_captures,
+                            histogram.percentile(50) / 1e6, histogram.percentile(95) / 1e6,
+                            histogram.percentile(99) / 1e6, histogram.max() / 1e6,
+                            last_seen_ms_ago, make_report(sub, sections, now, last_clear_time));
+        for (const auto& counter : sub.counters) {
+            report.back().counters[counter.name.str()] = (double)counter.sum / counter.samples;
+        }
     }
     return report;
 }
@@ -252,8 +651,11 @@ make_report(const SectionType& section,
 std::optional<Profiler::Report>
 Profiler::set_collect_get_every(const QueryPoolHandle<vk::QueryType::eTimestamp>& query_pool,
                                 const uint32_t report_intervall_millis,
-                                const uint32_t evict_after_ms) {
+                                const uint32_t evict_after_ms,
+                                const QueryPoolHandle<vk::QueryType::ePipelineStatistics>&
+                                    statistics_query_pool) {
     set_query_pool(query_pool);
+    set_statistics_query_pool(statistics_query_pool);
 
     collect(false, true);
 
@@ -273,7 +675,7 @@ Profiler::set_collect_get_every(const QueryPoolHandle<vk::QueryType::eTimestamp>
 }
 
 std::string Profiler::get_report_str(const Profiler::Report& report) {
-    if (report.cpu_report.empty() && report.gpu_report.empty()) {
+    if (!report) {
         return "no timestamps captured";
     }
 
@@ -282,6 +684,12 @@ std::string Profiler::get_report_str(const Profiler::Report& report) {
     result += to_string(report.cpu_report, 1);
     result += "GPU:\n";
     result += to_string(report.gpu_report, 1);
+    if (!report.counters.empty()) {
+        result += "Counters:\n";
+        for (const auto& [name, value] : report.counters) {
+            result += fmt::format("  {}: {}\n", name, value);
+        }
+    }
     return result;
 }
 
@@ -318,15 +726,35 @@ void Profiler::get_report_as_config(Properties& config, const Profiler::Report&
         config.st_separate("GPU");
         get_gpu_report_as_config(config, report);
     }
+
+    if (!report.counters.empty()) {
+        config.st_separate("Counters");
+        for (const auto& [name, value] : report.counters) {
+            config.output_text(fmt::format("   {}: {}", name, value));
+        }
+    }
+}
+
+void Profiler::set_counter(const std::string& name, const int64_t value) {
+    counters[name] = value;
+}
+
+void Profiler::add_section_counter(const SectionName name, const uint64_t value) {
+    assert(on_owner_thread() && "section counters are only supported on the owning thread");
+    assert(current_cpu_section != 0 && "missing start?");
+    add_counter(cpu_sections[current_cpu_section].counters, name, value);
 }
 
 Profiler::Report Profiler::get_report() {
+    merge_thread_buffers();
+
     Profiler::Report report;
     const auto now = chrono_clock::now();
     report.cpu_report =
         make_report(cpu_sections[current_cpu_section], cpu_sections, now, last_clear_time);
     report.gpu_report =
         make_report(gpu_sections[current_gpu_section], gpu_sections, now, last_clear_time);
+    report.counters = counters;
     return report;
 }
 
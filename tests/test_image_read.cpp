@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include "merian-graph/graph/graph.hpp"
+#include "merian-graph/merian_graph_extension.hpp"
+#include "merian/io/image_io.hpp"
+#include "merian/vk/context.hpp"
+#include "merian/vk/extension/extension_resources.hpp"
+#include "merian/vk/extension/extension_vk_validation_layers.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <filesystem>
+#include <vector>
+
+using namespace merian;
+using json = nlohmann::json;
+
+namespace {
+
+constexpr vk::DeviceSize BLOCK_SIZE = vk::DeviceSize(1) << 20;
+
+} // namespace
+
+// An image larger than a staging block is streamed with submits inside the node's process(), the
+// profiler's statistics query of the node must not span these submits (validation layers).
+TEST(ImageRead, StreamsImageLargerThanBlockWithProfiler) {
+    ContextCreateInfo info{
+        .context_extensions = {ExtensionVkValidationLayers::name, MerianGraphExtension::name},
+        .configure_extensions_callback =
+            [](ExtensionContainer& extensions) {
+                extensions.get_context_extension<ExtensionResources>()->set_staging_block_size(
+                    BLOCK_SIZE);
+            },
+        .application_name = "test-image-read",
+    };
+    info.features.set_feature("pipelineStatisticsQuery", true);
+    const ContextHandle context = Context::create(info);
+    const auto resources = context->get_context_extension<ExtensionResources>();
+    const auto alloc = resources->resource_allocator();
+    ASSERT_EQ(alloc->get_staging()->get_block_size(), BLOCK_SIZE);
+
+    // 4 blocks of RGBA8
+    const int width = 1024;
+    const int height = 1024;
+    std::vector<uint8_t> pixels(std::size_t(width) * height * 4);
+    for (std::size_t i = 0; i < pixels.size(); i++) {
+        pixels[i] = static_cast<uint8_t>(i * 7);
+    }
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() / "merian-test-image-read.png";
+    image_save_u8(path, pixels.data(), width, height, 4);
+
+    {
+        const GraphHandle graph = context->get_context_extension<MerianGraphExtension>()->create(
+            {.context = context, .resource_allocator = alloc});
+        graph->load_from_json(json{
+            {"version", 4},
+            {"nodes",
+             {{"image", {{"type", "LDR Image"}, {"properties", {{"path", path.string()}}}}}}},
+        });
+
+        const uint64_t uploaded_bytes = alloc->get_staging()->get_uploaded_bytes();
+        for (int i = 0; i < 3; i++) {
+            graph->run();
+        }
+        graph->wait();
+
+        EXPECT_GE(alloc->get_staging()->get_uploaded_bytes() - uploaded_bytes, pixels.size());
+    }
+
+    std::filesystem::remove(path);
+    context->get_device()->get_device().waitIdle();
+}
@@ -0,0 +1,76 @@
+#include "merian/vk/memory/memory_statistics.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace merian;
+
+TEST(MemoryStatistics, GroupsByOwnerAndName) {
+    MemoryStatistics statistics(2);
+
+    MemoryStatistics::Allocation unowned = statistics.add("", 16, 1);
+    MemoryStatistics::Allocation a;
+    MemoryStatistics::Allocation b;
+    {
+        const MemoryOwnerScope scene{"Scene"};
+        a = statistics.add("vertices", 100, 0);
+        {
+            const MemoryOwnerScope staging{"staging"};
+            b = statistics.add("vertices", 50, 0);
+        }
+        EXPECT_EQ(MemoryOwnerScope::current(), "Scene");
+    }
+    EXPECT_TRUE(MemoryOwnerScope::current().empty());
+
+    const std::vector<MemoryStatistics::HeapBudget> budgets(2);
+    MemoryStatistics::Report report = statistics.get_report(budgets);
+    EXPECT_EQ(report.by_owner.at("Scene").bytes, 100u);
+    EXPECT_EQ(report.by_owner.at("staging").bytes, 50u);
+    EXPECT_EQ(report.by_owner.at(std::string(MemoryStatistics::UNKNOWN_OWNER)).bytes, 16u);
+    EXPECT_EQ(report.by_name.at("vertices").bytes, 150u);
+    EXPECT_EQ(report.by_name.at("vertices").allocations, 2u);
+    EXPECT_EQ(report.by_name.at(std::string(MemoryStatistics::UNNAMED)).bytes, 16u);
+    EXPECT_EQ(report.heaps[0].tracked.bytes, 150u);
+    EXPECT_EQ(report.heaps[1].tracked.bytes, 16u);
+    EXPECT_EQ(report.total.bytes, 166u);
+
+    statistics.remove(a);
+    statistics.remove(b);
+    statistics.remove(unowned);
+    report = statistics.get_report(budgets);
+    EXPECT_EQ(report.total.bytes, 0u);
+    EXPECT_EQ(report.by_name.at("vertices").bytes, 0u);
+    EXPECT_EQ(report.by_name.at("vertices").peak_bytes, 150u);
+}
+
+TEST(MemoryStatistics, HighWaterMarks) {
+    MemoryStatistics statistics(1);
+    MemoryStatistics::HeapBudget budget{1000, true, 800, 300};
+
+    const MemoryStatistics::Allocation a = statistics.add("a", 200, 0);
+    statistics.remove(a);
+    const MemoryStatistics::Allocation b = statistics.add("b", 50, 0);
+
+    MemoryStatistics::Report report = statistics.get_report({budget});
+    EXPECT_EQ(report.total.bytes, 50u);
+    EXPECT_EQ(report.total.peak_bytes, 200u);
+    EXPECT_EQ(report.heaps[0].tracked.peak_bytes, 200u);
+    EXPECT_EQ(report.heaps[0].peak_usage, 300u);
+
+    budget.usage = 100;
+    report = statistics.get_report({budget});
+    EXPECT_EQ(report.heaps[0].peak_usage, 300u);
+
+    statistics.reset_peaks();
+    report = statistics.get_report({budget});
+    EXPECT_EQ(report.total.peak_bytes, 50u);
+    EXPECT_EQ(report.heaps[0].peak_usage, 100u);
+    // owners and names without live allocations are dropped
+    EXPECT_FALSE(report.by_name.contains("a"));
+    EXPECT_TRUE(report.by_name.contains("b"));
+
+    const nlohmann::json json = MemoryStatistics::to_json(report);
+    EXPECT_EQ(json["by_name"]["b"]["bytes"], 50u);
+    EXPECT_EQ(json["heaps"][0]["budget"], 800u);
+
+    statistics.remove(b);
+}
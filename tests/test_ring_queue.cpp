@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include "merian/utils/concurrent/ring_queue.hpp"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace merian;
+
+TEST(MPMCRingQueue, FifoAndBounded) {
+    MPMCRingQueue<int> queue(3);
+    EXPECT_EQ(queue.capacity(), 4u);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(queue.try_push(i));
+    }
+    EXPECT_FALSE(queue.try_push(4));
+    EXPECT_EQ(queue.size(), 4u);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(queue.try_pop(), i);
+    }
+    EXPECT_FALSE(queue.try_pop());
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(MPMCRingQueue, FailedPushDoesNotMove) {
+    MPMCRingQueue<std::unique_ptr<int>> queue(2);
+    EXPECT_TRUE(queue.try_push(std::make_unique<int>(0)));
+    EXPECT_TRUE(queue.try_push(std::make_unique<int>(1)));
+    auto value = std::make_unique<int>(2);
+    EXPECT_FALSE(queue.try_push(std::move(value)));
+    ASSERT_TRUE(value);
+    EXPECT_EQ(*value, 2);
+}
+
+TEST(MPMCRingQueue, DestroysRemainingValues) {
+    const auto counter = std::make_shared<int>(0);
+    {
+        MPMCRingQueue<std::shared_ptr<int>> queue(8);
+        queue.push(counter);
+        queue.push(counter);
+        EXPECT_EQ(counter.use_count(), 3);
+    }
+    EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(MPMCRingQueue, ConcurrentProducersAndConsumers) {
+    constexpr uint32_t producers = 4;
+    constexpr uint32_t consumers = 4;
+    constexpr uint64_t per_producer = 20000;
+
+    // small capacity so that both blocking sides are exercised
+    MPMCRingQueue<uint64_t> queue(16);
+    std::atomic_uint64_t sum{0};
+    std::atomic_uint64_t popped{0};
+
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            for (uint64_t i = 0; i < per_producer; i++) {
+                queue.push(p * per_producer + i + 1);
+            }
+        });
+    }
+    for (uint32_t c = 0; c < consumers; c++) {
+        threads.emplace_back([&]() {
+            for (uint64_t i = 0; i < producers * per_producer / consumers; i++) {
+                sum += queue.pop();
+                popped++;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    const uint64_t n = producers * per_producer;
+    EXPECT_EQ(popped.load(), n);
+    EXPECT_EQ(sum.load(), n * (n + 1) / 2);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(SPSCRingQueue, FifoAcrossThreads) {
+    constexpr uint64_t count = 100000;
+    SPSCRingQueue<uint64_t> queue(8);
+
+    std::thread producer([&]() {
+        for (uint64_t i = 0; i < count; i++) {
+            queue.push(i);
+        }
+    });
+    bool in_order = true;
+    for (uint64_t i = 0; i < count; i++) {
+        in_order &= queue.pop() == i;
+    }
+    producer.join();
+
+    EXPECT_TRUE(in_order);
+    EXPECT_FALSE(queue.try_pop());
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include "merian/utils/concurrent/thread_pool.hpp"
+#include "merian/vk/command/submission.hpp"
+#include "merian/vk/context.hpp"
+#include "merian/vk/extension/extension_resources.hpp"
+#include "merian/vk/extension/extension_vk_validation_layers.hpp"
+#include "merian/vk/memory/staging_memory_manager.hpp"
+#include "merian/vk/utils/cpu_queue.hpp"
+
+#include <cstring>
+#include <vector>
+
+using namespace merian;
+
+namespace {
+
+constexpr vk::DeviceSize BLOCK_SIZE = vk::DeviceSize(1) << 20;
+constexpr vk::DeviceSize BLOCK_COUNT = 8;
+
+} // namespace
+
+// Streamed chunks are exactly block sized and must be suballocated from the blocks (not from
+// individual buffers), the stream budget bounds the number of blocks.
+TEST(StagingMemoryManager, StreamsFullBlocks) {
+    const ContextHandle context = Context::create(ContextCreateInfo{
+        .context_extensions = {ExtensionVkValidationLayers::name, ExtensionResources::name},
+        .application_name = "test-staging-memory-manager",
+    });
+    const auto resources = context->get_context_extension<ExtensionResources>();
+    const ResourceAllocatorHandle alloc = resources->resource_allocator();
+    const QueueHandle queue = context->get_queue_GCT();
+
+    const StagingMemoryManagerHandle staging = std::make_shared<StagingMemoryManager>(
+        resources->memory_allocator(), BLOCK_SIZE, vk::BufferUsageFlagBits::eTransferSrc,
+        vk::BufferUsageFlagBits::eTransferDst, 0, 2 * BLOCK_SIZE);
+
+    const vk::DeviceSize size = BLOCK_COUNT * BLOCK_SIZE;
+    std::vector<uint32_t> data(size / sizeof(uint32_t));
+    for (std::size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<uint32_t>(i * 2654435761u);
+    }
+    const BufferHandle buffer = alloc->create_buffer(size, vk::BufferUsageFlagBits::eTransferDst,
+                                                     MemoryMappingType::HOST_ACCESS_RANDOM,
+                                                     "test staging destination");
+
+    {
+        Submission submission(context, queue,
+                              std::make_shared<CPUQueue>(context, std::make_shared<ThreadPool>()));
+        staging->cmd_to_device(submission, buffer, data.data());
+        staging->retire_on(submission);
+        submission.finish();
+        queue->wait_idle();
+    }
+
+    EXPECT_EQ(staging->get_uploaded_bytes(), size);
+    EXPECT_EQ(staging->get_individual_count(), 0u);
+    // the two chunks of the stream budget and the current block at most
+    EXPECT_LE(staging->get_allocated_size(), 3 * BLOCK_SIZE);
+
+    const uint32_t* result = buffer->get_memory()->map_as<uint32_t>();
+    EXPECT_EQ(std::memcmp(result, data.data(), size), 0);
+    buffer->get_memory()->unmap();
+}
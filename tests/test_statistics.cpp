@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include "merian/utils/statistics.hpp"
+
+#include <vector>
+
+using namespace merian;
+
+TEST(Statistics, PercentileInterpolatesBetweenRanks) {
+    const std::vector<double> sorted = {1, 2, 3, 4};
+    EXPECT_DOUBLE_EQ(percentile_of_sorted(sorted, 0), 1);
+    EXPECT_DOUBLE_EQ(percentile_of_sorted(sorted, 50), 2.5);
+    EXPECT_DOUBLE_EQ(percentile_of_sorted(sorted, 100), 4);
+    EXPECT_DOUBLE_EQ(percentile_of_sorted({7}, 95), 7);
+    EXPECT_DOUBLE_EQ(percentile_of_sorted({}, 50), 0);
+}
+
+TEST(Statistics, ComputeSortsSamples) {
+    std::vector<double> samples;
+    for (int i = 100; i >= 1; i--) {
+        samples.push_back(i);
+    }
+    const SampleStatistics stats = SampleStatistics::compute(samples);
+    EXPECT_EQ(stats.count, 100u);
+    EXPECT_DOUBLE_EQ(stats.min, 1);
+    EXPECT_DOUBLE_EQ(stats.max, 100);
+    EXPECT_DOUBLE_EQ(stats.mean, 50.5);
+    EXPECT_DOUBLE_EQ(stats.median, 50.5);
+    EXPECT_DOUBLE_EQ(stats.p95, 95.05);
+    EXPECT_DOUBLE_EQ(stats.p99, 99.01);
+
+    EXPECT_EQ(SampleStatistics::compute({}).count, 0u);
+}
+
+TEST(Statistics, LogHistogramBucketsCoverAllValues) {
+    // every bucket starts where the previous one ends
+    uint64_t next = 0;
+    for (uint32_t i = 0; i < LogHistogram::BUCKET_COUNT; i++) {
+        const auto [lower, width] = LogHistogram::bucket_range(i);
+        EXPECT_EQ(lower, next);
+        EXPECT_EQ(LogHistogram::bucket_index(lower), i);
+        EXPECT_EQ(LogHistogram::bucket_index(lower + width - 1), i);
+        next = lower + width;
+    }
+    EXPECT_EQ(next, uint64_t(1) << LogHistogram::MAX_BITS);
+    EXPECT_EQ(LogHistogram::bucket_index(~uint64_t(0)), LogHistogram::BUCKET_COUNT - 1);
+}
+
+TEST(Statistics, LogHistogramPercentilesWithinRelativeError) {
+    LogHistogram histogram;
+    EXPECT_EQ(histogram.percentile(50), 0u);
+
+    // 1 ms .. 100 ms in ns, and one outlier
+    for (uint64_t i = 1; i <= 100; i++) {
+        histogram.record(i * 1'000'000);
+    }
+    histogram.record(5'000'000'000);
+
+    EXPECT_EQ(histogram.count(), 101u);
+    EXPECT_EQ(histogram.min(), 1'000'000u);
+    EXPECT_EQ(histogram.max(), 5'000'000'000u);
+    EXPECT_EQ(histogram.percentile(100), 5'000'000'000u);
+    EXPECT_EQ(histogram.percentile(0), 1'000'000u);
+    const double tolerance = 1. / LogHistogram::SUB_BUCKETS;
+    EXPECT_NEAR((double)histogram.percentile(50), 51e6, 51e6 * tolerance);
+    EXPECT_NEAR((double)histogram.percentile(95), 96e6, 96e6 * tolerance);
+    EXPECT_NEAR((double)histogram.percentile(99), 100e6, 100e6 * tolerance);
+
+    histogram.clear();
+    EXPECT_EQ(histogram.count(), 0u);
+    EXPECT_EQ(histogram.max(), 0u);
+    histogram.record(7);
+    EXPECT_EQ(histogram.percentile(99), 7u);
+}
@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+
+#include "merian/utils/concurrent/thread_pool.hpp"
+#include "merian/utils/concurrent/utils.hpp"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+using namespace merian;
+
+TEST(Task, SmallCallableIsInline) {
+    int* p = nullptr;
+    const auto small = [p]() { (void)p; };
+    EXPECT_TRUE(Task::fits_inline<decltype(small)>());
+
+    std::array<char, 2 * Task::INLINE_SIZE> big{};
+    const auto large = [big]() { (void)big; };
+    EXPECT_FALSE(Task::fits_inline<decltype(large)>());
+}
+
+TEST(Task, InvokesAndMoves) {
+    int calls = 0;
+    std::array<char, 2 * Task::INLINE_SIZE> big{};
+    Task inline_task([&calls]() { calls++; });
+    Task heap_task([&calls, big]() { calls += 1 + big[0]; });
+
+    Task moved_inline = std::move(inline_task);
+    Task moved_heap;
+    moved_heap = std::move(heap_task);
+    EXPECT_FALSE(inline_task);
+    EXPECT_FALSE(heap_task);
+
+    moved_inline();
+    moved_heap();
+    EXPECT_EQ(calls, 2);
+}
+
+TEST(Task, DestroysCapturedState) {
+    const auto counter = std::make_shared<int>(0);
+    {
+        Task task([counter]() { (*counter)++; });
+        EXPECT_EQ(counter.use_count(), 2);
+        task();
+    }
+    EXPECT_EQ(counter.use_count(), 1);
+    EXPECT_EQ(*counter, 1);
+}
+
+TEST(ThreadPool, SubmitReturnsResults) {
+    ThreadPool pool(4);
+    std::vector<std::future<int>> futures;
+    for (int i = 0; i < 100; i++) {
+        futures.emplace_back(pool.submit<int>([i]() { return i * i; }));
+    }
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(futures[i].get(), i * i);
+    }
+}
+
+TEST(ThreadPool, SubmitPropagatesExceptions) {
+    ThreadPool pool(2);
+    std::future<void> future =
+        pool.submit<void>([]() { throw std::runtime_error("task failed"); });
+    EXPECT_THROW(future.get(), std::runtime_error);
+}
+
+TEST(ThreadPool, WaitIdleRunsNestedTasks) {
+    ThreadPool pool(4);
+    std::atomic_int count{0};
+    for (int i = 0; i < 64; i++) {
+        pool.execute([&pool, &count]() {
+            for (int j = 0; j < 16; j++) {
+                pool.execute([&count]() { count++; });
+            }
+        });
+    }
+    pool.wait_idle();
+    EXPECT_EQ(count.load(), 64 * 16);
+    EXPECT_EQ(pool.queue_size(), 0u);
+}
+
+TEST(ThreadPool, DestructorRunsQueuedTasks) {
+    std::atomic_int count{0};
+    {
+        ThreadPool pool(1);
+        for (int i = 0; i < 100; i++) {
+            pool.execute([&count]() { count++; });
+        }
+    }
+    EXPECT_EQ(count.load(), 100);
+}
+
+TEST(TaskGroup, WaitsForAllTasks) {
+    ThreadPool pool(4);
+    std::atomic_int count{0};
+    TaskGroup group(pool);
+    for (int i = 0; i < 1000; i++) {
+        group.run([&count]() { count++; });
+    }
+    group.wait();
+    EXPECT_EQ(count.load(), 1000);
+}
+
+TEST(TaskGroup, NestedWaitOnSingleWorkerDoesNotDeadlock) {
+    ThreadPool pool(1);
+    std::atomic_int count{0};
+    TaskGroup outer(pool);
+    for (int i = 0; i < 8; i++) {
+        outer.run([&pool, &count]() {
+            // the only worker waits here and must run the inner tasks itself
+            TaskGroup inner(pool);
+            for (int j = 0; j < 8; j++) {
+                inner.run([&count]() { count++; });
+            }
+            inner.wait();
+        });
+    }
+    outer.wait();
+    EXPECT_EQ(count.load(), 64);
+}
+
+TEST(TaskGroup, WaitRethrowsFirstException) {
+    ThreadPool pool(2);
+    TaskGroup group(pool);
+    group.run([]() { throw std::runtime_error("task failed"); });
+    group.run([]() {});
+    EXPECT_THROW(group.wait(), std::runtime_error);
+    // reported once
+    EXPECT_NO_THROW(group.wait());
+}
+
+TEST(ParallelFor, VisitsEveryIndexOnce) {
+    ThreadPool pool(4);
+    std::vector<std::atomic_uint32_t> visits(10007);
+    std::array<std::atomic_uint32_t, 4> per_task{};
+    parallel_for(
+        visits.size(),
+        [&](const uint32_t index, const uint32_t task_index) {
+            visits[index]++;
+            per_task.at(task_index)++;
+        },
+        pool, 4, 13);
+    for (const auto& v : visits) {
+        EXPECT_EQ(v.load(), 1u);
+    }
+    uint32_t total = 0;
+    for (const auto& t : per_task) {
+        total += t.load();
+    }
+    EXPECT_EQ(total, visits.size());
+}
+
+TEST(ParallelFor, NestedInPoolTasks) {
+    ThreadPool pool(2);
+    std::atomic_uint32_t count{0};
+    // every worker blocks in an outer iteration, the inner loops must still make progress
+    parallel_for(
+        8, [&](const uint32_t) { parallel_for(100, [&](const uint32_t) { count++; }, pool, 4, 1); },
+        pool, 4, 1);
+    EXPECT_EQ(count.load(), 800u);
+}
+
+TEST(ParallelFor, RethrowsExceptions) {
+    EXPECT_THROW(parallel_for(1000,
+                              [](const uint32_t index) {
+                                  if (index == 500)
+                                      throw std::runtime_error("fail");
+                              }),
+                 std::runtime_error);
+}
+
+TEST(ParallelReduce, MatchesSequential) {
+    ThreadPool pool(4);
+    std::vector<double> values(100000);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> dist(0, 1);
+    for (double& v : values) {
+        v = dist(rng);
+    }
+
+    const auto sum = [&]() {
+        return parallel_reduce(
+            values.size(), 0.0, [&](const uint32_t i) { return values[i]; }, std::plus<>(), pool,
+            1000);
+    };
+    const double first = sum();
+    EXPECT_NEAR(first, std::accumulate(values.begin(), values.end(), 0.0), 1e-6);
+    // chunk results are combined in order, independent of scheduling
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(sum(), first);
+    }
+
+    EXPECT_EQ(parallel_reduce(0, 7, [](const uint32_t) { return 1; }, std::plus<>()), 7);
+}
+
+TEST(ParallelSort, SortsLikeStdSort) {
+    ThreadPool pool(3);
+    std::mt19937 rng(1);
+    for (const std::size_t size : {0ul, 1ul, 100ul, 12345ul, 100000ul}) {
+        std::vector<uint32_t> values(size);
+        for (uint32_t& v : values) {
+            v = rng();
+        }
+        std::vector<uint32_t> expected = values;
+        std::sort(expected.begin(), expected.end(), std::greater<>());
+
+        parallel_sort(values.begin(), values.end(), std::greater<>(), pool, 1000);
+        EXPECT_EQ(values, expected);
+    }
+}
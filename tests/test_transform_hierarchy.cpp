@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include "merian-shaders/scene/transform_hierarchy.hpp"
+
+using namespace merian;
+
+namespace {
+
+float x_of(const float4x4& m) {
+    return m[0][3];
+}
+
+} // namespace
+
+TEST(TransformHierarchy, PropagatesAddedNodesInAnyOrder) {
+    TransformHierarchy hierarchy;
+    hierarchy.add(0, TransformHierarchy::INVALID, translation(float3(1, 0, 0)));
+    hierarchy.add(1, 0, translation(float3(2, 0, 0)));
+    hierarchy.add(2, 1, translation(float3(4, 0, 0)));
+    // sibling of 1 added after its nephew
+    hierarchy.add(3, 0, translation(float3(8, 0, 0)));
+
+    EXPECT_FLOAT_EQ(x_of(hierarchy.get_global(2)), 7.0f);
+    EXPECT_FLOAT_EQ(x_of(hierarchy.get_global(3)), 9.0f);
+    EXPECT_EQ(hierarchy.get_depth(), 3u);
+    EXPECT_EQ(hierarchy.size(), 4u);
+
+    // new nodes do not move
+    EXPECT_TRUE(hierarchy.is_moved(2));
+    EXPECT_FLOAT_EQ(x_of(hierarchy.get_prev_global(2)), 7.0f);
+}
+
+TEST(TransformHierarchy, OnlyMovedSubtreesChange) {
+    TransformHierarchy hierarchy;
+    hierarchy.add(0, TransformHierarchy::INVALID, identity());
+    hierarchy.add(1, 0, translation(float3(1, 0, 0)));
+    hierarchy.add(2, 1, translation(float3(1, 0, 0)));
+    hierarchy.add(3, 0, translation(float3(5, 0, 0)));
+    hierarchy.advance();
+    EXPECT_FALSE(hierarchy.is_moved(2));
+
+    hierarchy.set_local(1, translation(float3(3, 0, 0)));
+    EXPECT_FLOAT_EQ(x_of(hierarchy.get_global(2)), 4.0f);
+    EXPECT_TRUE(hierarchy.is_moved(1));
+    EXPECT_TRUE(hierarchy.is_moved(2));
+    EXPECT_FALSE(hierarchy.is_moved(0));
+    EXPECT_FALSE(hierarchy.is_moved(3));
+    EXPECT_FLOAT_EQ(x_of(hierarchy.get_prev_global(2)), 2.0f);
+
+    hierarchy.advance();
+    EXPECT_FALSE(hierarchy.is_moved(2));
+    EXPECT_FLOAT_EQ(x_of(hierarchy.get_prev_global(2)), 4.0f);
+}
+
+TEST(TransformHierarchy, RemoveAndReuseIds) {
+    TransformHierarchy hierarchy;
+    hierarchy.add(0, TransformHierarchy::INVALID, translation(float3(1, 0, 0)));
+    hierarchy.add(1, 0, translation(float3(1, 0, 0)));
+    hierarchy.add(2, 1, translation(float3(1, 0, 0)));
+    EXPECT_FLOAT_EQ(x_of(hierarchy.get_global(2)), 3.0f);
+
+    hierarchy.remove(2);
+    hierarchy.remove(1);
+    EXPECT_FALSE(hierarchy.contains(1));
+    EXPECT_EQ(hierarchy.size(), 1u);
+
+    hierarchy.add(1, 0, translation(float3(10, 0, 0)));
+    EXPECT_FLOAT_EQ(x_of(hierarchy.get_global(1)), 11.0f);
+    EXPECT_EQ(hierarchy.get_depth(), 2u);
+}
+
+TEST(TransformHierarchy, WideLevelsMatchSerialResult) {
+    constexpr uint32_t count = TransformHierarchy::PARALLEL_LEVEL_SIZE * 2;
+
+    TransformHierarchy hierarchy;
+    hierarchy.add(0, TransformHierarchy::INVALID, translation(float3(1, 0, 0)));
+    for (uint32_t i = 1; i <= count; i++) {
+        hierarchy.add(i, 0, translation(float3(static_cast<float>(i), 0, 0)));
+        hierarchy.add(count + i, i, translation(float3(1, 0, 0)));
+    }
+    hierarchy.advance();
+
+    hierarchy.set_local(0, translation(float3(2, 0, 0)));
+    for (uint32_t i = 1; i <= count; i++) {
+        ASSERT_FLOAT_EQ(x_of(hierarchy.get_global(count + i)), static_cast<float>(i + 3));
+        ASSERT_TRUE(hierarchy.is_moved(count + i));
+    }
+}